@@ -41,6 +41,12 @@ using std::string;
 using std::list;
 using std::ostringstream;
 using std::endl;
+using cssmatch::I18nKeyword;
+
+// Translation keywords
+static const I18nKeyword PLAYER_NO_SWAP_IN_MATCH("player_no_swap_in_match");
+static const I18nKeyword PLAYER_YOU_NOT_ADMIN("player_you_not_admin");
+static const I18nKeyword UPDATE_AVAILABLE("update_available");
 
 PLUGIN_RESULT cssmatch::clientcmd_jointeam(ClanMember * user, const CCommand & args)
 {
@@ -82,7 +88,7 @@ PLUGIN_RESULT cssmatch::clientcmd_jointeam(ClanMember * user, const CCommand & a
                     RecipientFilter recipients;
                     recipients.addRecipient(user);
 
-                    i18n->i18nChatSay(recipients, "player_no_swap_in_match");
+                    i18n->i18nChatSay(recipients, PLAYER_NO_SWAP_IN_MATCH);
                     result = PLUGIN_STOP;
                 }
             }
@@ -141,7 +147,7 @@ PLUGIN_RESULT cssmatch::clientcmd_cssmatch(ClanMember * user, const CCommand & a
                         RecipientFilter recipients;
                         recipients.addRecipient(user);
 
-                        i18n->i18nChatSay(recipients, "update_available");
+                        i18n->i18nChatSay(recipients, UPDATE_AVAILABLE);
                     }
                 }
                 catch (const UpdateNotifierException & e)
@@ -160,7 +166,7 @@ PLUGIN_RESULT cssmatch::clientcmd_cssmatch(ClanMember * user, const CCommand & a
         RecipientFilter recipients;
         recipients.addRecipient(user);
 
-        i18n->i18nChatSay(recipients, "player_you_not_admin");
+        i18n->i18nChatSay(recipients, PLAYER_YOU_NOT_ADMIN);
         plugin->log(playerid->steamid + " is not admin");
 
         plugin->queueCommand("cssm_adminlist\n");
@@ -177,8 +183,8 @@ PLUGIN_RESULT cssmatch::clientcmd_rates(ClanMember * user, const CCommand & args
     RecipientFilter recipients;
     recipients.addRecipient(user);
 
-    list<ClanMember *> * playerlist = plugin->getPlayerlist();
-    list<ClanMember *>::const_iterator currentPlayer;
+    const PlayerList * playerlist = plugin->getPlayerlist();
+    PlayerList::const_iterator currentPlayer;
     for(currentPlayer = playerlist->begin(); currentPlayer != playerlist->end(); currentPlayer++)
     {
         int playerIndex = (*currentPlayer)->getIdentity()->index;
@@ -34,6 +34,8 @@
 #include "../match/HalfMatchState.h"
 #include "../messages/I18nManager.h"
 #include "../plugin/ServerPlugin.h"
+#include "../plugin/Profiler.h"
+#include "../report/BaseReport.h" // REPORTS_PATH
 #include "../configuration/RunnableConfigurationFile.h"
 #include "../messages/Countdown.h"
 
@@ -55,6 +57,34 @@ using std::transform;
 using std::string;
 using std::map;
 
+// Translation keywords
+static const I18nKeyword ADMIN_ALL_TEAMS_SAY_READY("admin_all_teams_say_ready");
+static const I18nKeyword ADMIN_IS_ALREADY_ADMIN("admin_is_already_admin");
+static const I18nKeyword ADMIN_IS_NOT_ADMIN("admin_is_not_admin");
+static const I18nKeyword ADMIN_MANCHE_RESTARTED("admin_manche_restarted");
+static const I18nKeyword ADMIN_NEW_ADMIN("admin_new_admin");
+static const I18nKeyword ADMIN_NEW_CT_TEAM_NAME("admin_new_ct_team_name");
+static const I18nKeyword ADMIN_NEW_T_TEAM_NAME("admin_new_t_team_name");
+static const I18nKeyword ADMIN_OLD_ADMIN("admin_old_admin");
+static const I18nKeyword ADMIN_PLEASE_SPECIFY_PASSWORD("admin_please_specify_password");
+static const I18nKeyword ADMIN_PLEASE_SPECIFY_TAG("admin_please_specify_tag");
+static const I18nKeyword ADMIN_ROUND_RESTARTED("admin_round_restarted");
+static const I18nKeyword ADMIN_SPECTATOR_PLAYER("admin_spectator_player");
+static const I18nKeyword ADMIN_TRANSLATIONS_NOT_RELOADED("admin_translations_not_reloaded");
+static const I18nKeyword ADMIN_TRANSLATIONS_RELOADED("admin_translations_reloaded");
+static const I18nKeyword ERROR_COMMAND_NOT_FOUND("error_command_not_found");
+static const I18nKeyword ERROR_FILE_NOT_FOUND("error_file_not_found");
+static const I18nKeyword ERROR_INVALID_PLAYER("error_invalid_player");
+static const I18nKeyword MATCH_CONFIG_ERROR("match_config_error");
+static const I18nKeyword MATCH_IN_PROGRESS("match_in_progress");
+static const I18nKeyword MATCH_NAME("match_name");
+static const I18nKeyword MATCH_NOT_IN_PROGRESS("match_not_in_progress");
+static const I18nKeyword MATCH_SCORES("match_scores");
+static const I18nKeyword MATCH_SCORES_TEAM("match_scores_team");
+static const I18nKeyword PLAYER_THETIME("player_thetime");
+static const I18nKeyword PLAYER_YOU_NOT_ADMIN("player_you_not_admin");
+static const I18nKeyword WARMUP_DISABLE("warmup_disable");
+
 // Syntax: cssm_help [command name]
 void cssmatch::cssm_help(const CCommand & args)
 {
@@ -94,7 +124,7 @@ void cssmatch::cssm_help(const CCommand & args)
 
             map<string, string> parameters;
             parameters["$command"] = commandName;
-            i18n->i18nMsg("error_command_not_found", parameters);
+            i18n->i18nMsg(ERROR_COMMAND_NOT_FOUND, parameters);
         }
     }
 }
@@ -145,7 +175,7 @@ void cssmatch::cssm_start(const CCommand & args)
             {
                 RecipientFilter recipients;
                 recipients.addAllPlayers();
-                i18n->i18nChatWarning(recipients, "match_config_error");
+                i18n->i18nChatWarning(recipients, MATCH_CONFIG_ERROR);
             }
             match->start(configuration, warmup, initialState);
 
@@ -158,11 +188,11 @@ void cssmatch::cssm_start(const CCommand & args)
             map<string, string> parameters;
             parameters["$file"] = configurationFile;
 
-            i18n->i18nMsg("error_file_not_found", parameters);
+            i18n->i18nMsg(ERROR_FILE_NOT_FOUND, parameters);
         }
         catch(const MatchManagerException & e)
         {
-            i18n->i18nMsg("match_in_progress");
+            i18n->i18nMsg(MATCH_IN_PROGRESS);
         }
         break;
     default:
@@ -189,7 +219,7 @@ void cssmatch::cssm_stop(const CCommand & args)
     {
         I18nManager * i18n = plugin->getI18nManager();
 
-        i18n->i18nMsg("match_not_in_progress");
+        i18n->i18nMsg(MATCH_NOT_IN_PROGRESS);
     }
 }
 
@@ -210,11 +240,11 @@ void cssmatch::cssm_retag(const CCommand & args)
         map<string, string> parameters;
         parameters["$team1"] = *lignup->clan1.getName();
         parameters["$team2"] = *lignup->clan2.getName();
-        i18n->i18nMsg("match_name", parameters);
+        i18n->i18nMsg(MATCH_NAME, parameters);
     }
     catch(const MatchManagerException & e)
     {
-        i18n->i18nMsg("match_not_in_progress");
+        i18n->i18nMsg(MATCH_NOT_IN_PROGRESS);
     }
 }
 
@@ -231,17 +261,17 @@ void cssmatch::cssm_go(const CCommand & args)
     {
         RecipientFilter recipients;
         recipients.addAllPlayers();
-        i18n->i18nChatSay(recipients, "admin_all_teams_say_ready");
+        i18n->i18nChatSay(recipients, ADMIN_ALL_TEAMS_SAY_READY);
 
         warmupState->endWarmup();
     }
     else if (currentState != match->getInitialState())
     {
-        i18n->i18nMsg("warmup_disable");
+        i18n->i18nMsg(WARMUP_DISABLE);
     }
     else
     {
-        i18n->i18nMsg("match_not_in_progress");
+        i18n->i18nMsg(MATCH_NOT_IN_PROGRESS);
     }
 }
 
@@ -259,11 +289,11 @@ void cssmatch::cssm_restartmanche(const CCommand & args)
 
         RecipientFilter recipients;
         recipients.addAllPlayers();
-        i18n->i18nChatSay(recipients, "admin_manche_restarted");
+        i18n->i18nChatSay(recipients, ADMIN_MANCHE_RESTARTED);
     }
     catch(const MatchManagerException & e)
     {
-        i18n->i18nMsg("match_not_in_progress");
+        i18n->i18nMsg(MATCH_NOT_IN_PROGRESS);
     }
 }
 
@@ -279,11 +309,11 @@ void cssmatch::cssm_restartround(const CCommand & args)
 
         RecipientFilter recipients;
         recipients.addAllPlayers();
-        i18n->i18nChatSay(recipients, "admin_round_restarted");
+        i18n->i18nChatSay(recipients, ADMIN_ROUND_RESTARTED);
     }
     catch(const MatchManagerException & e)
     {
-        i18n->i18nMsg("match_not_in_progress");
+        i18n->i18nMsg(MATCH_NOT_IN_PROGRESS);
     }
 }
 
@@ -336,7 +366,7 @@ void cssmatch::cssm_grant(const CCommand & args)
         if (find(adminlist->begin(), invalidSteamid, steamid) == invalidSteamid)
         {
             adminlist->push_back(steamid);
-            i18n->i18nMsg("admin_new_admin", parameters);
+            i18n->i18nMsg(ADMIN_NEW_ADMIN, parameters);
 
             // Update the player rights if he's connected
             ClanMember * player = NULL;
@@ -346,7 +376,7 @@ void cssmatch::cssm_grant(const CCommand & args)
             }
         }
         else
-            i18n->i18nMsg("admin_is_already_admin", parameters);
+            i18n->i18nMsg(ADMIN_IS_ALREADY_ADMIN, parameters);
     }
     else
         Msg("cssm_grant steamid\n");
@@ -386,7 +416,7 @@ void cssmatch::cssm_revoke(const CCommand & args)
         if (itSteamid != invalidSteamid)
         {
             adminlist->erase(itSteamid);
-            i18n->i18nMsg("admin_old_admin", parameters);
+            i18n->i18nMsg(ADMIN_OLD_ADMIN, parameters);
 
             // Update the player rights if he's connected
             ClanMember * player = NULL;
@@ -396,7 +426,7 @@ void cssmatch::cssm_revoke(const CCommand & args)
             }
         }
         else
-            i18n->i18nMsg("admin_is_not_admin", parameters);
+            i18n->i18nMsg(ADMIN_IS_NOT_ADMIN, parameters);
     }
     else
         Msg("cssm_revoke steamid\n");
@@ -418,12 +448,12 @@ void cssmatch::cssm_teamt(const CCommand & args)
 
             map<string, string> parameters;
             parameters["$team"] = name;
-            i18n->i18nMsg("admin_new_t_team_name", parameters);
+            i18n->i18nMsg(ADMIN_NEW_T_TEAM_NAME, parameters);
 
         }
         catch(const MatchManagerException & e)
         {
-            i18n->i18nMsg("match_not_in_progress");
+            i18n->i18nMsg(MATCH_NOT_IN_PROGRESS);
         }
     }
     else
@@ -445,12 +475,12 @@ void cssmatch::cssm_teamct(const CCommand & args)
 
             map<string, string> parameters;
             parameters["$team"] = name;
-            i18n->i18nMsg("admin_new_ct_team_name", parameters);
+            i18n->i18nMsg(ADMIN_NEW_CT_TEAM_NAME, parameters);
 
         }
         catch(const MatchManagerException & e)
         {
-            i18n->i18nMsg("match_not_in_progress");
+            i18n->i18nMsg(MATCH_NOT_IN_PROGRESS);
         }
     }
     else
@@ -469,10 +499,10 @@ void cssmatch::cssm_swap(const CCommand & args)
         CSSMATCH_VALID_PLAYER(PlayerHavingUserid, atoi(args.Arg(1)), target)
         {
             if (! target->swap(/*true*/))
-                i18n->i18nMsg("admin_spectator_player");
+                i18n->i18nMsg(ADMIN_SPECTATOR_PLAYER);
         }
         else
-            i18n->i18nMsg("error_invalid_player");
+            i18n->i18nMsg(ERROR_INVALID_PLAYER);
     }
     else
         Msg("cssm_swap userid\n");
@@ -490,15 +520,61 @@ void cssmatch::cssm_spec(const CCommand & args)
         CSSMATCH_VALID_PLAYER(PlayerHavingUserid, atoi(args.Arg(1)), target)
         {
             if (! target->spec())
-                i18n->i18nMsg("admin_spectator_player");
+                i18n->i18nMsg(ADMIN_SPECTATOR_PLAYER);
         }
         else
-            i18n->i18nMsg("error_invalid_player");
+            i18n->i18nMsg(ERROR_INVALID_PLAYER);
     }
     else
         Msg("cssm_spec userid\n");
 }
 
+// Syntax: cssm_perf [reset|csv]
+void cssmatch::cssm_perf(const CCommand & args)
+{
+    Profiler * profiler = Profiler::getInstance();
+
+    string action = (args.ArgC() > 1) ? args.Arg(1) : "";
+    if (action == "reset")
+    {
+        profiler->reset();
+        ServerPlugin::getInstance()->getCommandBuffer()->resetStats();
+    }
+    else if (action == "csv")
+    {
+        char formatDate[20];
+        strftime(formatDate, sizeof(formatDate), "%Y-%m-%d_%Hh%M", getLocalTime());
+        string filePath = string(REPORTS_PATH) + "/perf_" + formatDate + ".csv";
+
+        try
+        {
+            profiler->writeCsv(filePath);
+            Msg("%s\n", filePath.c_str());
+        }
+        catch(const ProfilerException & e)
+        {
+            CSSMATCH_PRINT_EXCEPTION(e);
+        }
+    }
+    else if (action.empty())
+    {
+        profiler->print();
+        ServerPlugin::getInstance()->getCommandBuffer()->printStats();
+    }
+    else
+        Msg("cssm_perf [reset|csv]\n");
+}
+
+void cssmatch::cssm_reload_translations(const CCommand & args)
+{
+    I18nManager * i18n = ServerPlugin::getInstance()->getI18nManager();
+
+    if (i18n->loadTranslations(true))
+        i18n->i18nMsg(ADMIN_TRANSLATIONS_RELOADED);
+    else
+        i18n->i18nMsg(ADMIN_TRANSLATIONS_NOT_RELOADED);
+}
+
 // ***************
 // Hooks callbacks
 // ***************
@@ -532,7 +608,7 @@ bool cssmatch::say_hook(ClanMember * user, const CCommand & args)
         {
             RecipientFilter recipients;
             recipients.addRecipient(user);
-            i18n->i18nChatSay(recipients, "player_you_not_admin");
+            i18n->i18nChatSay(recipients, PLAYER_YOU_NOT_ADMIN);
             plugin->queueCommand("cssm_adminlist\n");
         }
     }
@@ -551,11 +627,11 @@ bool cssmatch::say_hook(ClanMember * user, const CCommand & args)
             recipients.addRecipient(user);
             if (currentState != match->getInitialState())
             {
-                i18n->i18nChatSay(recipients, "warmup_disable");
+                i18n->i18nChatSay(recipients, WARMUP_DISABLE);
             }
             else
             {
-                i18n->i18nChatSay(recipients, "match_not_in_progress");
+                i18n->i18nChatSay(recipients, MATCH_NOT_IN_PROGRESS);
             }
         }
     }
@@ -581,8 +657,8 @@ bool cssmatch::say_hook(ClanMember * user, const CCommand & args)
         else
         {
             TeamCode team = user->getMyTeam();
-            list<ClanMember *> * playerlist = plugin->getPlayerlist();
-            list<ClanMember *>::const_iterator itPlayer;
+            const PlayerList * playerlist = plugin->getPlayerlist();
+            PlayerList::const_iterator itPlayer;
             for (itPlayer = playerlist->begin(); itPlayer != playerlist->end(); itPlayer++)
             {
                 if ((*itPlayer)->getMyTeam() == team)
@@ -590,9 +666,9 @@ bool cssmatch::say_hook(ClanMember * user, const CCommand & args)
             }
         }
 
-        i18n->i18nChatSay(recipients, "match_scores");
-        i18n->i18nChatSay(recipients, "match_scores_team", parameters1);
-        i18n->i18nChatSay(recipients, "match_scores_team", parameters2);
+        i18n->i18nChatSay(recipients, MATCH_SCORES);
+        i18n->i18nChatSay(recipients, MATCH_SCORES_TEAM, parameters1);
+        i18n->i18nChatSay(recipients, MATCH_SCORES_TEAM, parameters2);
     }
     // !teamt: cf cssm_teamt
     else if (chatCommand == "!teamt")
@@ -621,25 +697,25 @@ bool cssmatch::say_hook(ClanMember * user, const CCommand & args)
 
                     map<string, string> parameters;
                     parameters["$team"] = newName;
-                    i18n->i18nChatSay(recipients, "admin_new_t_team_name", parameters);
+                    i18n->i18nChatSay(recipients, ADMIN_NEW_T_TEAM_NAME, parameters);
                 }
                 catch(const MatchManagerException & e)
                 {
                     recipients.addRecipient(user);
-                    i18n->i18nChatSay(recipients, "match_not_in_progress");
+                    i18n->i18nChatSay(recipients, MATCH_NOT_IN_PROGRESS);
                 }
             }
             else
             {
                 recipients.addRecipient(user);
-                i18n->i18nChatSay(recipients, "admin_please_specify_tag");
+                i18n->i18nChatSay(recipients, ADMIN_PLEASE_SPECIFY_TAG);
             }
         }
         else
         {
             RecipientFilter recipients;
             recipients.addRecipient(user);
-            i18n->i18nChatSay(recipients, "player_you_not_admin");
+            i18n->i18nChatSay(recipients, PLAYER_YOU_NOT_ADMIN);
             plugin->queueCommand("cssm_adminlist\n");
         }
     }
@@ -670,25 +746,25 @@ bool cssmatch::say_hook(ClanMember * user, const CCommand & args)
 
                     map<string, string> parameters;
                     parameters["$team"] = newName;
-                    i18n->i18nChatSay(recipients, "admin_new_ct_team_name", parameters);
+                    i18n->i18nChatSay(recipients, ADMIN_NEW_CT_TEAM_NAME, parameters);
                 }
                 catch(const MatchManagerException & e)
                 {
                     recipients.addRecipient(user);
-                    i18n->i18nChatSay(recipients, "match_not_in_progress");
+                    i18n->i18nChatSay(recipients, MATCH_NOT_IN_PROGRESS);
                 }
             }
             else
             {
                 recipients.addRecipient(user);
-                i18n->i18nChatSay(recipients, "admin_please_specify_tag");
+                i18n->i18nChatSay(recipients, ADMIN_PLEASE_SPECIFY_TAG);
             }
         }
         else
         {
             RecipientFilter recipients;
             recipients.addRecipient(user);
-            i18n->i18nChatSay(recipients, "player_you_not_admin");
+            i18n->i18nChatSay(recipients, PLAYER_YOU_NOT_ADMIN);
             plugin->queueCommand("cssm_adminlist\n");
         }
     }
@@ -726,7 +802,7 @@ bool cssmatch::say_hook(ClanMember * user, const CCommand & args)
             {
                 RecipientFilter recipients;
                 recipients.addRecipient(user);
-                i18n->i18nChatSay(recipients, "admin_please_specify_password");
+                i18n->i18nChatSay(recipients, ADMIN_PLEASE_SPECIFY_PASSWORD);
             }
         }
     }
@@ -760,7 +836,7 @@ bool cssmatch::say_hook(ClanMember * user, const CCommand & args)
         else
             parameters["$minutes"] = "0" + toString(time->tm_min);
 
-        i18n->i18nChatSay(recipients, "player_thetime", parameters);
+        i18n->i18nChatSay(recipients, PLAYER_THETIME, parameters);
     }
 
     return eat;
@@ -81,6 +81,12 @@ namespace cssmatch
     /** Put a player to the spectator team, by userid */
     void cssm_spec(const CCommand & args);
 
+    /** Print the profiler statistics, reset them or write them in a CSV file */
+    void cssm_perf(const CCommand & args);
+
+    /** Compile the translation files again, then use the new translations */
+    void cssm_reload_translations(const CCommand & args);
+
     /** !go, !score, !teamt, etc. */
     bool say_hook(ClanMember * user, const CCommand & args);
 
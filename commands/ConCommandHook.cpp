@@ -26,6 +26,7 @@
 
 #include "ConCommandHook.h"
 #include "../plugin/ServerPlugin.h"
+#include "../plugin/Profiler.h"
 #include "../player/ClanMember.h"
 
 #include <string>
@@ -86,6 +87,7 @@ void ConCommandHook::Init()
 
 void ConCommandHook::Dispatch(const CCommand & args)
 {
+    CSSMATCH_PROFILE("ConCommandHook::Dispatch")
     if (hooked != NULL)
     {
         // Call the corresponding callback, and eat the command call if asked
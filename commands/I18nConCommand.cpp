@@ -44,7 +44,8 @@ char const * I18nConCommand::GetHelpText() const
 {
     // Return the translation
 
-    string translation = i18n->getTranslation(i18n->getDefaultLanguage(), ConCommand::GetHelpText());
+    string translation = i18n->getTranslation(i18n->getDefaultLanguage(),
+                                              I18nKeyword(ConCommand::GetHelpText()));
 
     char * text = new char [translation.size()+1];
     V_strcpy(text, translation.c_str());
@@ -26,15 +26,11 @@
 
 #include "ConfigurationFile.h"
 
-#include <fstream>
-#include <sstream>
-
 using namespace cssmatch;
 
 using std::string;
-using std::getline;
-using std::ifstream;
 using std::list;
+using std::vector;
 
 void ConfigurationFile::removeEndLine(string & line)
 {
@@ -81,11 +77,27 @@ void ConfigurationFile::trim(string & line)
     line = line.substr(iDataBegin, iDataEnd-iDataBegin);
 }
 
+void ConfigurationFile::trim(ConfigurationLine & line)
+{
+    // Trim front
+    while((line.length > 0) && ((*line.text == ' ') || (*line.text == '\t')))
+    {
+        line.text++;
+        line.length--;
+    }
+
+    // Trim back
+    while((line.length > 0)
+        && ((line.text[line.length-1] == ' ') || (line.text[line.length-1] == '\t')))
+    {
+        line.length--;
+    }
+}
+
 ConfigurationFile::ConfigurationFile(const string & path) throw (ConfigurationFileException)
     : filePath(path)
 {
-    ifstream file(filePath.c_str());
-    if (file.fail())
+    if (! content.open(filePath))
         throw ConfigurationFileException("The file " + filePath + " cannot be found");
 }
 
@@ -118,20 +130,49 @@ string ConfigurationFile::getPatchFromCfg() const
 
 void ConfigurationFile::getLines(list<string> & out)
 {
-    ifstream file(filePath.c_str());
+    vector<ConfigurationLine> lines;
+    getLines(lines);
 
-    if (! file.fail())
+    vector<ConfigurationLine>::const_iterator itLine;
+    for(itLine = lines.begin(); itLine != lines.end(); itLine++)
     {
-        string line;
+        out.push_back(itLine->str());
+    }
+}
 
-        while(getline(file, line))
-        {
-            removeComments(line);
-            removeEndLine(line);
-            trim(line);
+void ConfigurationFile::getLines(vector<ConfigurationLine> & out)
+{
+    const char * current = content.getData();
+    const char * last = current + content.getSize();
 
-            if (line.length() > 0)
-                out.push_back(line);
+    while(current < last)
+    {
+        const char * lineBegin = current;
+        const char * dataEnd = NULL; // where the comment or the Windows end line begins
+
+        while((current < last) && (*current != '\n'))
+        {
+            if ((dataEnd == NULL)
+                && ((*current == '\r')
+                    || ((*current == '/') && (current+1 < last) && (*(current+1) == '/'))))
+            {
+                dataEnd = current;
+            }
+            current++;
         }
+        if (dataEnd == NULL)
+            dataEnd = current;
+
+        ConfigurationLine line(lineBegin, dataEnd - lineBegin);
+        trim(line);
+        if (line.length > 0)
+            out.push_back(line);
+
+        current++; // pass the end line
     }
 }
+
+void ConfigurationFile::close()
+{
+    content.close();
+}
@@ -30,9 +30,11 @@
 #include "../exceptions/BaseException.h"
 
 #include "../misc/common.h"
+#include "MappedFile.h"
 
 #include <string>
 #include <list>
+#include <vector>
 
 /** cfg folder path */
 #define CFG_FOLDER_PATH "cstrike/cfg/"
@@ -45,6 +47,24 @@ namespace cssmatch
         ConfigurationFileException(const std::string & message) : BaseException(message){}
     };
 
+    /** Part of a configuration file line, pointing into the mapped file (not null-terminated) */
+    struct ConfigurationLine
+    {
+        /** First character */
+        const char * text;
+
+        /** Number of characters */
+        size_t length;
+
+        ConfigurationLine(const char * begin, size_t size) : text(begin), length(size){}
+
+        /** Copy the characters into a string */
+        std::string str() const
+        {
+            return std::string(text, length);
+        }
+    };
+
     /** Configuration file <br>
      * Commented line statements start with //
      */
@@ -53,6 +73,9 @@ namespace cssmatch
     protected:
         /** File's path */
         std::string filePath;
+
+        /** File's content */
+        MappedFile content;
     public:
         /** Make sure that the string doesn't contain a Windows/Linux end line character <br>
          * (Typically usefull when a file is saved under Windows then read under Linux.)
@@ -70,6 +93,11 @@ namespace cssmatch
          */
         static void trim(std::string & line);
 
+        /** Trim the line, without copy
+         * @param line The line to parse
+         */
+        static void trim(ConfigurationLine & line);
+
         /** Construct a handler for a configuration file
          * @param filePath The path of the file
          * @throw ConfigurationFileException if the file was not found
@@ -86,6 +114,15 @@ namespace cssmatch
          * @param out Out list
          */
         void getLines(std::list<std::string> & out);
+
+        /** Get all the file lines (stripped, without comments), in one pass and without copy <br>
+         * The lines point into the file content, and are valid until close() is called
+         * @param out Out vector
+         */
+        void getLines(std::vector<ConfigurationLine> & out);
+
+        /** Release the file content (no more lines can be read) */
+        void close();
     };
 }
 
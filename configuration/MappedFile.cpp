@@ -0,0 +1,142 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // _WIN32
+
+using namespace cssmatch;
+
+using std::string;
+
+MappedFile::MappedFile() : data(NULL), size(0)
+#ifdef _WIN32
+    , mapping(NULL)
+#endif // _WIN32
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const string & path)
+{
+    close();
+
+    bool success = false;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        DWORD fileSize = GetFileSize(file, NULL);
+        if (fileSize == 0)
+            success = true; // nothing to map
+        else if (fileSize != INVALID_FILE_SIZE)
+        {
+            mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping != NULL)
+            {
+                data = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                if (data != NULL)
+                {
+                    size = fileSize;
+                    success = true;
+                }
+                else
+                {
+                    CloseHandle(mapping);
+                    mapping = NULL;
+                }
+            }
+        }
+        // The mapping keeps its own reference to the file
+        CloseHandle(file);
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd != -1)
+    {
+        struct stat infos;
+        if (fstat(fd, &infos) == 0)
+        {
+            if (infos.st_size == 0)
+                success = true; // nothing to map
+            else
+            {
+                void * view = mmap(NULL, infos.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (view != MAP_FAILED)
+                {
+                    data = static_cast<const char *>(view);
+                    size = infos.st_size;
+                    success = true;
+                }
+            }
+        }
+        // The mapping keeps its own reference to the file
+        ::close(fd);
+    }
+#endif // _WIN32
+
+    return success;
+}
+
+void MappedFile::close()
+{
+    if (data != NULL)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        CloseHandle(mapping);
+        mapping = NULL;
+#else
+        munmap(const_cast<char *>(data), size);
+#endif // _WIN32
+        data = NULL;
+    }
+    size = 0;
+}
+
+const char * MappedFile::getData() const
+{
+    return data;
+}
+
+size_t MappedFile::getSize() const
+{
+    return size;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __MAPPED_FILE_H__
+#define __MAPPED_FILE_H__
+
+#include "../misc/CannotBeCopied.h"
+
+#include <string>
+
+namespace cssmatch
+{
+    /** Read-only view of a whole file, mapped in memory <br>
+     * The content is not null-terminated
+     */
+    class MappedFile : public CannotBeCopied
+    {
+    private:
+        /** First byte of the file (NULL if the file is empty or not mapped) */
+        const char * data;
+
+        /** File size in bytes */
+        size_t size;
+
+#ifdef _WIN32
+        /** File mapping object handle */
+        void * mapping;
+#endif // _WIN32
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        /** Map a file, after unmapping the previous one
+         * @param path The path of the file
+         * @return <code>true</code> if the file is mapped, <code>false</code> if it cannot be opened
+         */
+        bool open(const std::string & path);
+
+        /** Unmap the file */
+        void close();
+
+        /** Get the first byte of the file (maybe NULL if the file is empty) */
+        const char * getData() const;
+
+        /** Get the file size in bytes */
+        size_t getSize() const;
+    };
+}
+
+#endif // __MAPPED_FILE_H__
@@ -0,0 +1,528 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "TranslationBundle.h"
+#include "TranslationFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <algorithm>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif // _WIN32
+
+using namespace cssmatch;
+
+using std::string;
+using std::vector;
+using std::map;
+using std::set;
+
+namespace cssmatch
+{
+    /** Header of a translation bundle, followed by: <br>
+     * - languageCount TranslationBundleLanguage <br>
+     * - keywordCount TranslationBundleString, sorted <br>
+     * - languageCount * keywordCount TranslationBundleEntry <br>
+     * - placeholderCount offsets <br>
+     * - stringsSize characters
+     */
+    struct TranslationBundleHeader
+    {
+        char magic[8];
+        unsigned int version;
+        unsigned int languageCount;
+        unsigned int keywordCount;
+        unsigned int placeholderCount;
+        unsigned int stringsSize;
+    };
+
+    /** String stored in the strings section (not null-terminated) */
+    struct TranslationBundleString
+    {
+        unsigned int offset;
+        unsigned int length;
+    };
+
+    struct TranslationBundleLanguage
+    {
+        TranslationBundleString name;
+
+        /** 0 if the translation file is invalid (the language has no translation) */
+        unsigned int valid;
+
+        /** Size and modification date of the translation file */
+        unsigned int sourceSize;
+        unsigned int sourceTime;
+    };
+
+    struct TranslationBundleEntry
+    {
+        /** Offset is TRANSLATION_BUNDLE_MISSING if the translation does not exist */
+        TranslationBundleString text;
+
+        unsigned int firstPlaceholder;
+        unsigned int placeholderCount;
+    };
+}
+
+static const char TRANSLATION_BUNDLE_MAGIC[8] = {'C', 'S', 'S', 'M', 'I', '1', '8', 'N'};
+static const unsigned int TRANSLATION_BUNDLE_VERSION = 1;
+static const unsigned int TRANSLATION_BUNDLE_MISSING = 0xFFFFFFFF;
+
+/** Get the size and modification date of a file
+ * @return <code>false</code> if the file does not exist
+ */
+static bool getSourceInfos(const string & path, unsigned int & size, unsigned int & time)
+{
+    struct stat infos;
+    bool success = (stat(path.c_str(), &infos) == 0);
+    if (success)
+    {
+        size = (unsigned int)infos.st_size;
+        time = (unsigned int)infos.st_mtime;
+    }
+    return success;
+}
+
+/** Append a string to the strings section */
+static TranslationBundleString addString(string & strings, const string & value)
+{
+    TranslationBundleString added;
+    added.offset = strings.size();
+    added.length = value.size();
+    strings.append(value);
+    return added;
+}
+
+int TranslationBundle::compare(const TranslationBundleString & bundled, const string & other) const
+{
+    return -other.compare(0, other.size(), strings + bundled.offset, bundled.length);
+}
+
+TranslationBundle::TranslationBundle()
+    : header(NULL), languages(NULL), keywords(NULL), entries(NULL), placeholders(NULL),
+    strings(NULL)
+{
+}
+
+bool TranslationBundle::open(const string & path)
+{
+    close();
+
+    if ((! content.open(path)) || (content.getSize() < sizeof(TranslationBundleHeader)))
+    {
+        content.close();
+        return false;
+    }
+
+    const char * data = content.getData();
+    const TranslationBundleHeader * bundleHeader =
+        reinterpret_cast<const TranslationBundleHeader *>(data);
+
+    // Do the sections fit in the file?
+    unsigned long long languagesSize =
+        (unsigned long long)bundleHeader->languageCount * sizeof(TranslationBundleLanguage);
+    unsigned long long keywordsSize =
+        (unsigned long long)bundleHeader->keywordCount * sizeof(TranslationBundleString);
+    unsigned long long entriesSize = (unsigned long long)bundleHeader->languageCount *
+        bundleHeader->keywordCount * sizeof(TranslationBundleEntry);
+    unsigned long long placeholdersSize =
+        (unsigned long long)bundleHeader->placeholderCount * sizeof(unsigned int);
+    unsigned long long expectedSize = sizeof(TranslationBundleHeader) + languagesSize +
+        keywordsSize + entriesSize + placeholdersSize + bundleHeader->stringsSize;
+
+    if ((memcmp(bundleHeader->magic, TRANSLATION_BUNDLE_MAGIC, sizeof(bundleHeader->magic)) != 0)
+        || (bundleHeader->version != TRANSLATION_BUNDLE_VERSION)
+        || (expectedSize != content.getSize()))
+    {
+        content.close();
+        return false;
+    }
+
+    const char * section = data + sizeof(TranslationBundleHeader);
+    const TranslationBundleLanguage * bundleLanguages =
+        reinterpret_cast<const TranslationBundleLanguage *>(section);
+    section += languagesSize;
+    const TranslationBundleString * bundleKeywords =
+        reinterpret_cast<const TranslationBundleString *>(section);
+    section += keywordsSize;
+    const TranslationBundleEntry * bundleEntries =
+        reinterpret_cast<const TranslationBundleEntry *>(section);
+    section += entriesSize;
+    const unsigned int * bundlePlaceholders = reinterpret_cast<const unsigned int *>(section);
+    section += placeholdersSize;
+
+    // Does every string/placeholder refer to the bundle?
+    unsigned int stringsSize = bundleHeader->stringsSize;
+    bool valid = true;
+    for(unsigned int i = 0; valid && (i < bundleHeader->languageCount); i++)
+    {
+        const TranslationBundleString & name = bundleLanguages[i].name;
+        valid = (name.offset <= stringsSize) && (name.length <= stringsSize - name.offset);
+    }
+    for(unsigned int i = 0; valid && (i < bundleHeader->keywordCount); i++)
+    {
+        const TranslationBundleString & keyword = bundleKeywords[i];
+        valid = (keyword.offset <= stringsSize) && (keyword.length <= stringsSize - keyword.offset);
+    }
+    unsigned long long entryCount = entriesSize / sizeof(TranslationBundleEntry);
+    for(unsigned long long i = 0; valid && (i < entryCount); i++)
+    {
+        const TranslationBundleEntry & entry = bundleEntries[i];
+        if (entry.text.offset != TRANSLATION_BUNDLE_MISSING)
+        {
+            unsigned int placeholderCount = bundleHeader->placeholderCount;
+            valid = (entry.text.offset <= stringsSize)
+                && (entry.text.length <= stringsSize - entry.text.offset)
+                && (entry.firstPlaceholder <= placeholderCount)
+                && (entry.placeholderCount <= placeholderCount - entry.firstPlaceholder);
+            for(unsigned int j = 0; valid && (j < entry.placeholderCount); j++)
+                valid = (bundlePlaceholders[entry.firstPlaceholder + j] < entry.text.length);
+        }
+    }
+
+    if (valid)
+    {
+        header = bundleHeader;
+        languages = bundleLanguages;
+        keywords = bundleKeywords;
+        entries = bundleEntries;
+        placeholders = bundlePlaceholders;
+        strings = section;
+    }
+    else
+        content.close();
+
+    return valid;
+}
+
+void TranslationBundle::close()
+{
+    content.close();
+    header = NULL;
+    languages = NULL;
+    keywords = NULL;
+    entries = NULL;
+    placeholders = NULL;
+    strings = NULL;
+}
+
+bool TranslationBundle::isUpToDate(const string & folder,
+                                   const vector<string> & languageNames) const
+{
+    bool upToDate = (header != NULL) && (header->languageCount == languageNames.size());
+
+    for(unsigned int i = 0; upToDate && (i < header->languageCount); i++)
+    {
+        const TranslationBundleLanguage & language = languages[i];
+        unsigned int size = 0;
+        unsigned int time = 0;
+
+        upToDate = (compare(language.name, languageNames[i]) == 0)
+            && getSourceInfos(folder + languageNames[i] + ".txt", size, time)
+            && (language.sourceSize == size) && (language.sourceTime == time);
+    }
+
+    return upToDate;
+}
+
+int TranslationBundle::getLanguageCount() const
+{
+    return (header != NULL) ? header->languageCount : 0;
+}
+
+string TranslationBundle::getLanguageName(int language) const
+{
+    const TranslationBundleString & name = languages[language].name;
+    return string(strings + name.offset, name.length);
+}
+
+bool TranslationBundle::isValid(int language) const
+{
+    return languages[language].valid != 0;
+}
+
+int TranslationBundle::findLanguage(const string & language) const
+{
+    int languageIndex = -1;
+
+    if (header != NULL)
+    {
+        for(unsigned int i = 0; (languageIndex == -1) && (i < header->languageCount); i++)
+        {
+            if ((languages[i].valid != 0) && (compare(languages[i].name, language) == 0))
+                languageIndex = i;
+        }
+    }
+
+    return languageIndex;
+}
+
+int TranslationBundle::getKeywordCount() const
+{
+    return (header != NULL) ? header->keywordCount : 0;
+}
+
+string TranslationBundle::getKeywordName(int keyword) const
+{
+    const TranslationBundleString & name = keywords[keyword];
+    return string(strings + name.offset, name.length);
+}
+
+int TranslationBundle::findKeyword(const string & keyword) const
+{
+    int keywordIndex = -1;
+
+    if (header != NULL)
+    {
+        // Binary search on the sorted keywords
+        unsigned int first = 0;
+        unsigned int last = header->keywordCount;
+        while((keywordIndex == -1) && (first < last))
+        {
+            unsigned int middle = first + (last - first) / 2;
+            int result = compare(keywords[middle], keyword);
+            if (result < 0)
+                first = middle + 1;
+            else if (result > 0)
+                last = middle;
+            else
+                keywordIndex = middle;
+        }
+    }
+
+    return keywordIndex;
+}
+
+bool TranslationBundle::hasTranslation(int language, int keyword) const
+{
+    const TranslationBundleEntry & entry = entries[language * header->keywordCount + keyword];
+    return entry.text.offset != TRANSLATION_BUNDLE_MISSING;
+}
+
+bool TranslationBundle::render(int language,
+                               int keyword,
+                               const map<string, string> & parameters,
+                               string & buffer) const
+{
+    const TranslationBundleEntry & entry = entries[language * header->keywordCount + keyword];
+
+    bool found = (entry.text.offset != TRANSLATION_BUNDLE_MISSING);
+    if (found)
+    {
+        CompiledTranslation::render(strings + entry.text.offset, entry.text.length,
+                                    placeholders + entry.firstPlaceholder, entry.placeholderCount,
+                                    parameters, buffer);
+    }
+
+    return found;
+}
+
+void TranslationBundle::listLanguages(const string & folder, vector<string> & out)
+{
+    static const string extension = ".txt";
+
+#ifdef _WIN32
+    WIN32_FIND_DATAA found;
+    HANDLE search = FindFirstFileA((folder + "*" + extension).c_str(), &found);
+    if (search != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            string fileName = found.cFileName;
+            if ((found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+                out.push_back(fileName.substr(0, fileName.size() - extension.size()));
+        }
+        while(FindNextFileA(search, &found));
+        FindClose(search);
+    }
+#else
+    DIR * directory = opendir(folder.c_str());
+    if (directory != NULL)
+    {
+        dirent * found = readdir(directory);
+        while(found != NULL)
+        {
+            string fileName = found->d_name;
+            if ((fileName.size() > extension.size())
+                && (fileName.compare(fileName.size() - extension.size(), extension.size(),
+                                     extension) == 0))
+                out.push_back(fileName.substr(0, fileName.size() - extension.size()));
+            found = readdir(directory);
+        }
+        closedir(directory);
+    }
+#endif // _WIN32
+
+    std::sort(out.begin(), out.end());
+}
+
+void TranslationBundle::compile(const string & folder,
+                                const vector<string> & languageNames,
+                                const string & path) throw(ConfigurationFileException)
+{
+    // Parse the translation files
+    vector<TranslationFile *> files(languageNames.size(), (TranslationFile *)NULL);
+    vector<TranslationBundleLanguage> bundleLanguages(languageNames.size());
+    set<string> keywordSet;
+    string bundleStrings;
+
+    for(size_t i = 0; i < languageNames.size(); i++)
+    {
+        string filePath = folder + languageNames[i] + ".txt";
+
+        TranslationBundleLanguage & language = bundleLanguages[i];
+        language.name = addString(bundleStrings, languageNames[i]);
+        language.valid = 0;
+        language.sourceSize = 0;
+        language.sourceTime = 0;
+        getSourceInfos(filePath, language.sourceSize, language.sourceTime);
+
+        try
+        {
+            files[i] = new TranslationFile(filePath);
+            language.valid = 1;
+
+            const map<string, CompiledTranslation> & translations = files[i]->getTranslations();
+            map<string, CompiledTranslation>::const_iterator itTranslation;
+            for(itTranslation = translations.begin(); itTranslation != translations.end();
+                itTranslation++)
+            {
+                keywordSet.insert(itTranslation->first);
+            }
+        }
+        catch(const ConfigurationFileException & e)
+        {
+            CSSMATCH_PRINT_EXCEPTION(e);
+        }
+    }
+
+    // Index the keywords (the set is already sorted)
+    vector<TranslationBundleString> bundleKeywords;
+    bundleKeywords.reserve(keywordSet.size());
+    set<string>::const_iterator itKeyword;
+    for(itKeyword = keywordSet.begin(); itKeyword != keywordSet.end(); itKeyword++)
+    {
+        bundleKeywords.push_back(addString(bundleStrings, *itKeyword));
+    }
+
+    // Fill the {language, keyword} => translation table
+    TranslationBundleEntry missing;
+    missing.text.offset = TRANSLATION_BUNDLE_MISSING;
+    missing.text.length = 0;
+    missing.firstPlaceholder = 0;
+    missing.placeholderCount = 0;
+    vector<TranslationBundleEntry> bundleEntries(files.size() * keywordSet.size(), missing);
+    vector<unsigned int> bundlePlaceholders;
+
+    for(size_t i = 0; i < files.size(); i++)
+    {
+        if (files[i] == NULL)
+            continue;
+
+        // Both the translations and the keywords are sorted
+        size_t iKeyword = 0;
+        itKeyword = keywordSet.begin();
+
+        const map<string, CompiledTranslation> & translations = files[i]->getTranslations();
+        map<string, CompiledTranslation>::const_iterator itTranslation;
+        for(itTranslation = translations.begin(); itTranslation != translations.end();
+            itTranslation++)
+        {
+            while(*itKeyword != itTranslation->first)
+            {
+                itKeyword++;
+                iKeyword++;
+            }
+
+            const CompiledTranslation & translation = itTranslation->second;
+            const vector<size_t> & offsets = translation.getPlaceholders();
+
+            TranslationBundleEntry & entry = bundleEntries[i * keywordSet.size() + iKeyword];
+            entry.text = addString(bundleStrings, translation.getText());
+            entry.firstPlaceholder = bundlePlaceholders.size();
+            entry.placeholderCount = offsets.size();
+            bundlePlaceholders.insert(bundlePlaceholders.end(), offsets.begin(), offsets.end());
+        }
+
+        delete files[i];
+    }
+
+    TranslationBundleHeader bundleHeader;
+    memset(&bundleHeader, 0, sizeof(bundleHeader));
+    memcpy(bundleHeader.magic, TRANSLATION_BUNDLE_MAGIC, sizeof(bundleHeader.magic));
+    bundleHeader.version = TRANSLATION_BUNDLE_VERSION;
+    bundleHeader.languageCount = bundleLanguages.size();
+    bundleHeader.keywordCount = bundleKeywords.size();
+    bundleHeader.placeholderCount = bundlePlaceholders.size();
+    bundleHeader.stringsSize = bundleStrings.size();
+
+    // Write the bundle
+    FILE * file = fopen(path.c_str(), "wb");
+    if (file == NULL)
+        throw ConfigurationFileException("Unable to create " + path);
+
+    bool success = (fwrite(&bundleHeader, sizeof(bundleHeader), 1, file) == 1);
+    if (success && (! bundleLanguages.empty()))
+        success = (fwrite(&bundleLanguages[0], sizeof(TranslationBundleLanguage),
+                          bundleLanguages.size(), file) == bundleLanguages.size());
+    if (success && (! bundleKeywords.empty()))
+        success = (fwrite(&bundleKeywords[0], sizeof(TranslationBundleString),
+                          bundleKeywords.size(), file) == bundleKeywords.size());
+    if (success && (! bundleEntries.empty()))
+        success = (fwrite(&bundleEntries[0], sizeof(TranslationBundleEntry),
+                          bundleEntries.size(), file) == bundleEntries.size());
+    if (success && (! bundlePlaceholders.empty()))
+        success = (fwrite(&bundlePlaceholders[0], sizeof(unsigned int),
+                          bundlePlaceholders.size(), file) == bundlePlaceholders.size());
+    if (success && (! bundleStrings.empty()))
+        success = (fwrite(bundleStrings.data(), 1, bundleStrings.size(), file)
+                   == bundleStrings.size());
+    fclose(file);
+
+    if (! success)
+    {
+        remove(path.c_str());
+        throw ConfigurationFileException("Unable to write " + path);
+    }
+}
+
+bool TranslationBundle::replace(const string & source, const string & path)
+{
+#ifdef _WIN32
+    // rename fails if the destination exists
+    return MoveFileExA(source.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(source.c_str(), path.c_str()) == 0;
+#endif // _WIN32
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __TRANSLATION_BUNDLE_H__
+#define __TRANSLATION_BUNDLE_H__
+
+#include "ConfigurationFile.h" // ConfigurationFileException
+#include "MappedFile.h"
+#include "../misc/CannotBeCopied.h"
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace cssmatch
+{
+    struct TranslationBundleHeader;
+    struct TranslationBundleLanguage;
+    struct TranslationBundleString;
+    struct TranslationBundleEntry;
+
+    /** All the translation files compiled into a single binary file <br>
+     * The bundle contains: <br>
+     * - the languages (name, size and modification date of the source file) <br>
+     * - the keywords, sorted (a keyword gets the same index for all the languages) <br>
+     * - a {language, keyword} => translation table, with the translations already compiled
+     *   (see CompiledTranslation) <br>
+     * The bundle is mapped in memory, so the translations are used without parse nor copy
+     */
+    class TranslationBundle : public CannotBeCopied
+    {
+    private:
+        /** Bundle content */
+        MappedFile content;
+
+        // Bundle sections (NULL if no bundle is open)
+        const TranslationBundleHeader * header;
+        const TranslationBundleLanguage * languages;
+        const TranslationBundleString * keywords;
+        const TranslationBundleEntry * entries;
+        const unsigned int * placeholders;
+        const char * strings;
+
+        /** Compare a string from the bundle with another string */
+        int compare(const TranslationBundleString & bundled, const std::string & other) const;
+    public:
+        TranslationBundle();
+
+        /** Map a bundle file
+         * @param path The path of the bundle
+         * @return <code>true</code> if the bundle is valid, <code>false</code> otherwise
+         */
+        bool open(const std::string & path);
+
+        /** Unmap the bundle */
+        void close();
+
+        /** Check if the bundle was compiled from the current version of the translation files
+         * @param folder The folder containing the translation files
+         * @param languageNames The languages found in this folder (see listLanguages)
+         * @return <code>true</code> if no translation file was added, removed or modified since
+         */
+        bool isUpToDate(const std::string & folder,
+                        const std::vector<std::string> & languageNames) const;
+
+        /** Get the number of languages, including the invalid ones */
+        int getLanguageCount() const;
+
+        /** Get the name of a language
+         * @param language The language index
+         */
+        std::string getLanguageName(int language) const;
+
+        /** Was the translation file of a language valid?
+         * @param language The language index
+         */
+        bool isValid(int language) const;
+
+        /** Get the index of a language
+         * @param language The language name
+         * @return The language index, or -1 if the language is not in the bundle
+         */
+        int findLanguage(const std::string & language) const;
+
+        /** Get the number of keywords, translated in at least one language */
+        int getKeywordCount() const;
+
+        /** Get a keyword
+         * @param keyword The keyword index
+         */
+        std::string getKeywordName(int keyword) const;
+
+        /** Get the index of a keyword
+         * @param keyword The keyword
+         * @return The keyword index, or -1 if the keyword is not in the bundle
+         */
+        int findKeyword(const std::string & keyword) const;
+
+        /** Check if a language has a translation for a keyword
+         * @param language The language index
+         * @param keyword The keyword index
+         */
+        bool hasTranslation(int language, int keyword) const;
+
+        /** Append a translation to a buffer, replacing its parameters
+         * @param language The language index
+         * @param keyword The keyword index
+         * @param parameters The {parameter => value} map
+         * @param buffer The string where the translation will be appended
+         * @return <code>false</code> if the language has no translation for this keyword
+         */
+        bool render(int language,
+                    int keyword,
+                    const std::map<std::string, std::string> & parameters,
+                    std::string & buffer) const;
+
+        /** List the languages having a translation file (i.e. the names of the .txt files)
+         * @param folder The folder containing the translation files
+         * @param out Out vector, sorted
+         */
+        static void listLanguages(const std::string & folder, std::vector<std::string> & out);
+
+        /** Compile the translation files into a bundle <br>
+         * The invalid translation files are skipped
+         * @param folder The folder containing the translation files
+         * @param languageNames The languages to compile
+         * @param path The path of the bundle to write
+         * @throws ConfigurationFileException if the bundle cannot be written
+         */
+        static void compile(const std::string & folder,
+                            const std::vector<std::string> & languageNames,
+                            const std::string & path) throw(ConfigurationFileException);
+
+        /** Replace a bundle file by another one (e.g. a bundle compiled aside) <br>
+         * On Windows, the bundle to replace must not be mapped
+         * @param source The path of the new bundle
+         * @param path The path of the bundle to replace
+         * @return <code>true</code> if the bundle was replaced, <code>false</code> if both
+         * files were left untouched
+         */
+        static bool replace(const std::string & source, const std::string & path);
+    };
+}
+
+#endif // __TRANSLATION_BUNDLE_H__
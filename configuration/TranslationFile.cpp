@@ -26,72 +26,113 @@
 
 #include "TranslationFile.h"
 
+#include <cstring> // memchr
+
 using namespace cssmatch;
 
 using std::string;
 using std::list;
 using std::map;
+using std::vector;
+
+CompiledTranslation::CompiledTranslation()
+{}
+
+CompiledTranslation::CompiledTranslation(const string & translation) : text(translation)
+{
+    size_t iParam = text.find('$');
+    while(iParam != string::npos)
+    {
+        placeholders.push_back(iParam);
+        iParam = text.find('$', iParam + 1);
+    }
+}
+
+const string & CompiledTranslation::getText() const
+{
+    return text;
+}
+
+const vector<size_t> & CompiledTranslation::getPlaceholders() const
+{
+    return placeholders;
+}
+
+void CompiledTranslation::render(const map<string, string> & parameters, string & buffer) const
+{
+    render(text.data(), text.size(), placeholders.empty() ? NULL : &placeholders[0],
+           placeholders.size(), parameters, buffer);
+}
 
 void TranslationFile::parse() throw(TranslationException)
 {
-    list<string> lines;
+    vector<ConfigurationLine> lines;
     getLines(lines);
 
     // I - Where is the header ?
-    parseHeader(lines);
+    size_t iFirstLine = parseHeader(lines);
     // No header => no translations
     if (header.empty())
+    {
+        close();
         throw TranslationException("The file " + filePath + " does not have a valid header");
+    }
 
     // II - Header found, try to get the translations
-    parseTranslations(lines);
+    parseTranslations(lines, iFirstLine);
+
+    // The lines point into the file, which is no longer needed
+    close();
 }
 
-void TranslationFile::parseHeader(list<string> & lines)
+size_t TranslationFile::parseHeader(const vector<ConfigurationLine> & lines)
 {
-    while((! lines.empty()) && header.empty())
+    size_t iLine = 0;
+    size_t lineCount = lines.size();
+    while((iLine < lineCount) && header.empty())
     {
-        list<string>::const_reference line = lines.front();
+        const ConfigurationLine & line = lines[iLine];
 
         // Search for [some header] statement
-        size_t iHeaderBegins = line.find("[");
-        if (iHeaderBegins != string::npos)
+        const char * headerBegins = static_cast<const char *>(memchr(line.text, '[', line.length));
+        if (headerBegins != NULL)
         {
-            size_t iHeaderEnds = line.find("]");
-            if (iHeaderEnds != string::npos)
+            size_t remaining = line.text + line.length - headerBegins;
+            const char * headerEnds =
+                static_cast<const char *>(memchr(headerBegins, ']', remaining));
+            if (headerEnds != NULL)
             {
-                setHeader(line.substr(iHeaderBegins, iHeaderEnds - iHeaderBegins + 1));
+                setHeader(string(headerBegins, headerEnds + 1));
                 //Msg("Found header: '%s'\n",translationFile->getHeader().c_str());
             }
         }
         // Else we ignore this invalid line
-        lines.pop_front();
+        iLine++;
     }
+
+    return iLine;
 }
 
-// BEURK !
-void TranslationFile::parseTranslations(list<string> & lines)
+void TranslationFile::parseTranslations(const vector<ConfigurationLine> & lines, size_t iFirstLine)
 {
     // Search for "keyword = translation" statement
     //	(quotation marks are optionnals, but can delimit the begin/end of a string)
 
-    while(! lines.empty())
-    {
-        list<string>::const_reference line = lines.front();
+    string dataValue;
 
-        size_t iEqual = string::npos;
-        size_t lineSize = line.size();
+    size_t lineCount = lines.size();
+    for(size_t iLine = iFirstLine; iLine < lineCount; iLine++)
+    {
+        const ConfigurationLine & line = lines[iLine];
 
         bool betweenQuotes = false; // true if we are between quotation marks
 
         // Where is the "=" symbol ?
-        string::const_iterator itChar = line.begin();
-        string::const_iterator lastChar = line.end();
+        size_t iEqual = 0;
         bool equalFound = false;
-        while((itChar != lastChar) && (! equalFound))
+        while((iEqual < line.length) && (! equalFound))
         {
-            iEqual++;
-            switch(*itChar)
+            switch(line.text[iEqual])
             {
             case '"': // Quoted string
                 betweenQuotes = (! betweenQuotes);
@@ -102,57 +143,63 @@ void TranslationFile::parseTranslations(list<string> & lines)
                 break;
             }
 
-            itChar++;
+            if (! equalFound)
+                iEqual++;
         }
 
-        // Is the symbol between quotation marks ?
-        if (iEqual != lineSize-1)
-        { // No, we can get the data
-            string dataName = line.substr(0, iEqual); //
-            ConfigurationFile::trim(dataName);
+        // Is there something after the symbol?
+        if ((! equalFound) || (iEqual == line.length-1))
+            continue; // No, we ignore this invalid line
+
+        // Keyword part :
+
+        ConfigurationLine dataName(line.text, iEqual);
+        ConfigurationFile::trim(dataName);
+        if (dataName.length < 2)
+            continue;
+
+        // Remove the quotes if needed
+        if ((dataName.text[0] == '"') && (dataName.text[dataName.length-1] == '"'))
+        {
+            dataName.text++;
+            dataName.length -= 2;
+        }
 
-            // Keyword part :
+        // Translation part :
 
-            size_t iLastCharDataName = dataName.size() - 1;
-            if (iLastCharDataName>0)
+        // +1 to pass the equal symbol
+        ConfigurationLine dataSlice(line.text + iEqual + 1, line.length - iEqual - 1);
+        ConfigurationFile::trim(dataSlice);
+        if (dataSlice.length < 2)
+            continue;
+
+        // Remove the quotes if needed
+        if ((dataSlice.text[0] == '"') && (dataSlice.text[dataSlice.length-1] == '"'))
+        {
+            dataSlice.text++;
+            dataSlice.length -= 2;
+        }
+
+        // \n are replaced by the corresponding escape sequence
+        dataValue.clear();
+        for(size_t iChar = 0; iChar < dataSlice.length; iChar++)
+        {
+            if ((dataSlice.text[iChar] == '\\') && (iChar+1 < dataSlice.length)
+                && (dataSlice.text[iChar+1] == 'n'))
             {
-                // Remove the quotes if needed
-                if ((dataName[0] == '"') && (dataName[iLastCharDataName] == '"'))
-                    dataName = dataName.substr(1, iLastCharDataName - 1);
-
-                // Get the translation value part
-                string dataValue = line.substr(iEqual+1, lineSize); // +1 to pass the equal symbol
-                ConfigurationFile::trim(dataValue);
-
-                // Translation part :
-
-                // Remove the quotes if needed
-                size_t iLastCharDataValue = dataValue.size()-1;
-                if (iLastCharDataValue>0)
-                {
-                    if ((dataValue[0] == '"') && (dataValue[iLastCharDataValue] == '"'))
-                        dataValue = dataValue.substr(1, iLastCharDataValue - 1);
-
-                    // \n are replaced by the corresponding escape sequence
-                    size_t iEndLine = dataValue.find("\\n");
-                    while (iEndLine != string::npos)
-                    {
-                        dataValue.replace(iEndLine, 2, "\n", 0, 1);
-                        iEndLine = dataValue.find("\\n");
-                    }
-
-                    if ((dataName.size() > 0) && (dataValue.size() > 0))
-                    {
-                        addTranslation(dataName, dataValue);
-                        //Msg("Found: '%s'='%s'\n",dataName.c_str(),dataValue.c_str());
-                    }
-                    // Else we ignore this invalid line
-                }
+                dataValue += '\n';
+                iChar++;
             }
+            else
+                dataValue += dataSlice.text[iChar];
         }
-        // Else we ignore this invalid line
 
-        lines.pop_front();
+        if ((dataName.length > 0) && (dataValue.size() > 0))
+        {
+            addTranslation(dataName.str(), dataValue);
+            //Msg("Found: '%s'='%s'\n",dataName.c_str(),dataValue.c_str());
+        }
+        // Else we ignore this invalid line
     }
 }
 
@@ -171,6 +218,11 @@ string TranslationFile::getHeader() const
     return header;
 }
 
+const map<string, CompiledTranslation> & TranslationFile::getTranslations() const
+{
+    return translations;
+}
+
 void TranslationFile::setHeader(const string & newHeader)
 {
     header = newHeader;
@@ -178,7 +230,7 @@ void TranslationFile::setHeader(const string & newHeader)
 
 void TranslationFile::addTranslation(const string & keyword, const string & translation)
 {
-    translations[keyword] = translation;
+    translations[keyword] = CompiledTranslation(translation);
 }
 
 bool TranslationFile::keywordExists(const string & keyword) const
@@ -186,11 +238,19 @@ bool TranslationFile::keywordExists(const string & keyword) const
     return translations.find(keyword) != translations.end();
 }
 
-string TranslationFile::operator [](const string & keyword) throw (TranslationException)
+const string & TranslationFile::operator [](const string & keyword) const
+    throw (TranslationException)
 {
-    if (keywordExists(keyword))
-        return translations[keyword];
-    else
+    return getCompiled(keyword).getText();
+}
+
+const CompiledTranslation & TranslationFile::getCompiled(const string & keyword) const
+    throw (TranslationException)
+{
+    map<string, CompiledTranslation>::const_iterator itTranslation = translations.find(keyword);
+    if (itTranslation == translations.end())
         throw TranslationException(
             keyword + " does not correspond to a known translation in the file " + filePath);
+
+    return itTranslation->second;
 }
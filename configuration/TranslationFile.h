@@ -33,6 +33,7 @@
 #include "../misc/BaseSingleton.h"
 
 #include <map>
+#include <vector>
 
 namespace cssmatch
 {
@@ -42,6 +43,94 @@ namespace cssmatch
         TranslationException(const std::string & message) : ConfigurationFileException(message){};
     };
 
+    /** Translation compiled at load time <br>
+     * The positions of the '$' characters (i.e. the potential parameters) are computed once,
+     * so a message can be rendered in a single pass without searching the parameters again
+     */
+    class CompiledTranslation
+    {
+    private:
+        /** The raw translation */
+        std::string text;
+
+        /** Offsets of the parameter candidates in the translation */
+        std::vector<size_t> placeholders;
+    public:
+        CompiledTranslation();
+
+        /**
+         * @param translation The raw translation to compile
+         */
+        CompiledTranslation(const std::string & translation);
+
+        /** Get the raw translation */
+        const std::string & getText() const;
+
+        /** Get the offsets of the parameter candidates */
+        const std::vector<size_t> & getPlaceholders() const;
+
+        /** Append the translation to a buffer, replacing its parameters <br>
+         * When several parameters match the same placeholder, the longest one is used
+         * (e.g. $team1 has priority over $team)
+         * @param parameters The {parameter => value} map
+         * @param buffer The string where the translation will be appended
+         */
+        void render(const std::map<std::string, std::string> & parameters,
+                    std::string & buffer) const;
+
+        /** Append a translation to a buffer, replacing its parameters (see above)
+         * @param text The raw translation (not null-terminated)
+         * @param length The size of the raw translation
+         * @param placeholders The offsets of the parameter candidates in the translation
+         * @param placeholderCount The number of parameter candidates
+         * @param parameters The {parameter => value} map
+         * @param buffer The string where the translation will be appended
+         */
+        template<typename Offset>
+        static void render( const char * text,
+                            size_t length,
+                            const Offset * placeholders,
+                            size_t placeholderCount,
+                            const std::map<std::string, std::string> & parameters,
+                            std::string & buffer)
+        {
+            typedef std::map<std::string, std::string>::const_iterator ParameterIterator;
+
+            size_t iLiteral = 0; // where the next literal part begins
+
+            for(size_t iPlaceholder = 0; iPlaceholder < placeholderCount; iPlaceholder++)
+            {
+                size_t iParam = placeholders[iPlaceholder];
+                if (iParam < iLiteral)
+                    continue; // already consumed by the previous parameter
+
+                // Which parameter matches here? (the longest one wins)
+                ParameterIterator match = parameters.end();
+                ParameterIterator itParameters = parameters.begin();
+                ParameterIterator lastParameter = parameters.end();
+                for(; itParameters != lastParameter; itParameters++)
+                {
+                    const std::string & parameter = itParameters->first;
+                    size_t size = parameter.size();
+                    if ((size <= length - iParam)
+                        && (parameter.compare(0, size, text + iParam, size) == 0)
+                        && ((match == parameters.end()) || (parameter.size() > match->first.size())))
+                        match = itParameters;
+                }
+
+                if (match != parameters.end())
+                {
+                    buffer.append(text + iLiteral, iParam - iLiteral);
+                    buffer.append(match->second);
+                    iLiteral = iParam + match->first.size();
+                }
+                // Else the '$' is part of the literal text
+            }
+
+            buffer.append(text + iLiteral, length - iLiteral);
+        }
+    };
+
     /** Translation file <br>
      * Description: <br>
      *	- // marks the begin a commentary statement <br>
@@ -59,8 +148,8 @@ namespace cssmatch
         /** [header] */
         std::string header;
 
-        /** {keyword => translation} map */
-        std::map<std::string, std::string> translations;
+        /** {keyword => compiled translation} map */
+        std::map<std::string, CompiledTranslation> translations;
 
         /** Parse the translation file
          * @throws TranslationException if not header was found
@@ -69,13 +158,15 @@ namespace cssmatch
 
         /** Search the header
          * @param lines The lines to parse
+         * @return The index of the first line following the header
          */
-        void parseHeader(std::list<std::string> & lines);
+        size_t parseHeader(const std::vector<ConfigurationLine> & lines);
 
         /** Search the translations
-         * @param lines The remaining lines to parse
+         * @param lines The lines to parse
+         * @param iFirstLine The index of the first line to parse
          */
-        void parseTranslations(std::list<std::string> & lines);
+        void parseTranslations(const std::vector<ConfigurationLine> & lines, size_t iFirstLine);
     public:
         /** Load and parse a new translation file
          * @param filePath The path of the file to parse
@@ -88,6 +179,9 @@ namespace cssmatch
         /** Get the header content */
         std::string getHeader() const;
 
+        /** Get the {keyword => compiled translation} map */
+        const std::map<std::string, CompiledTranslation> & getTranslations() const;
+
         /** In-memory header modification */
         void setHeader(const std::string & newHeader);
 
@@ -108,7 +202,16 @@ namespace cssmatch
          * @return The translation
          * @throws TranslationException if the translation does not exist
          */
-        std::string operator [](const std::string & keyword) throw (TranslationException);
+        const std::string & operator [](const std::string & keyword) const
+            throw (TranslationException);
+
+        /** Get the compiled translation corresponding to a keyword
+         * @param keyword The keyword corresponding to the translation
+         * @return The compiled translation
+         * @throws TranslationException if the translation does not exist
+         */
+        const CompiledTranslation & getCompiled(const std::string & keyword) const
+            throw (TranslationException);
     };
 }
 
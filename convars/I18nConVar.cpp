@@ -83,7 +83,8 @@ char const * I18nConVar::GetHelpText() const
 {
     // Return the translation
 
-    string translation = i18n->getTranslation(i18n->getDefaultLanguage(), ConVar::GetHelpText());
+    string translation = i18n->getTranslation(i18n->getDefaultLanguage(),
+                                              I18nKeyword(ConVar::GetHelpText()));
 
     char * text = new char [translation.size()+1];
     V_strcpy(text, translation.c_str());
@@ -27,88 +27,33 @@
 #include "EntityProp.h"
 
 #include "edict.h" // BaseEntity, edict_t
-#include "dt_send.h" // SendTable
-
-#include "../plugin/ServerPlugin.h"
-
-#include <sstream>
 
 using namespace cssmatch;
 
 using std::string;
-using std::getline;
-using std::istringstream;
 
-void EntityProp::getOffset(SendTable * table,  istringstream & propPathLeft)
+void EntityProp::resolve()
 {
-    // Get the next step into the props table
-    string pathNextStep;
-    getline(propPathLeft, pathNextStep, '.');
-    //Msg("Scanning %s...\n", propPathLeft.c_str());
-
-    int nbrProps = table->GetNumProps();
-    int i=0;
-    while(i<nbrProps)
-    {
-        SendProp * sProp = table->GetProp(i);
-
-        if (pathNextStep == sProp->GetName())
-        {
-            offset += sProp->GetOffset();
-            switch(sProp->GetType())
-            {
-            case DPT_Int:
-            case DPT_Float:
-            case DPT_Vector:
-            case DPT_String:
-            case DPT_Array:
-                // Found the prop itself, the offset is up to date
-                i = nbrProps; // break
-                break;
-            case DPT_DataTable:
-                // Step reached, go to the next step
-                getOffset(sProp->GetDataTable(), propPathLeft);
-                break;
-            default:
-                // Prop not found
-                offset = 0;
-                i = nbrProps; // break
-            }
-        }
-        i++;
-    }
+    PropOffsetCache * cache = PropOffsetCache::getInstance();
+    offset = cache->find(key);
+    generation = cache->getGeneration();
 }
 
-void EntityProp::initialize()
+int EntityProp::getOffset() throw(EntityPropException)
 {
-    // Get all server classes
-    IServerGameDLL * serverGameDll = ServerPlugin::getInstance()->getInterfaces()->serverGameDll;
-    if (serverGameDll != NULL)
-    {
-        ServerClass * classes = serverGameDll->GetAllServerClasses();
-
-        // Search the suitable class
-        while (classes != NULL)
-        {
-            if (theClass == classes->GetName())
-            {
-                istringstream pathToProp(path);
+    if (generation != PropOffsetCache::getInstance()->getGeneration())
+        resolve();
 
-                getOffset(classes->m_pTable, pathToProp);
+    if (offset <= 0)
+        throw EntityPropException(string(
+                                      "CSSMatch was unable to find the offset of prop ") +
+                                  theClass + "." + path);
 
-                break;
-            }
-            else
-                classes = classes->m_pNext; // until m_pNext is NULL
-        }
-    }
-    else
-        CSSMATCH_PRINT(string(
-                        "Unable to find the offset of prop ") + theClass + 
-                        ", IServerGameDll instance not ready")
+    return offset;
 }
 
 EntityProp::EntityProp(const string & propClass, const string & propPath)
-    : initialized(false), offset(0), theClass(propClass), path(propPath)
+    : theClass(propClass), path(propPath), key(PropOffsetCache::makeKey(propClass, propPath)),
+      generation(-1), offset(0)
 {
 }
@@ -28,11 +28,10 @@
 #define __ENTITY_PROP_H__
 
 #include "../misc/common.h"
+#include "PropOffsetCache.h"
 
 #include <string>
-#include <fstream>
 
-class SendTable;
 struct edict_t;
 class CBaseEntity;
 
@@ -47,29 +46,30 @@ namespace cssmatch
         {}
     };
 
-    /** Handle the (networked) entities game properties*/
+    /** Handle the (networked) entities game properties <br>
+     * The offset is looked up in the PropOffsetCache, and looked up again only if the cache was
+     * rebuilt
+     */
     class EntityProp
     {
     private:
-        bool initialized;
-
         /** The prop class */
         std::string theClass;
 
         /** The prop path (e.g. step1.step2.prop) */
         std::string path;
 
+        /** The prop key in the PropOffsetCache */
+        PropKey key;
+
+        /** The PropOffsetCache generation the offset was found in */
+        int generation;
+
         /** The prop offset */
         int offset;
 
-        /** Compute the prop offset
-         * @param table The table which contains the prop
-         * @param propPathLeft Path left until the prop
-         */
-        void getOffset(SendTable * table, std::istringstream & propPathLeft);
-
-        /** Search the prop offset among the server props */
-        void initialize();
+        /** Get the prop offset from the PropOffsetCache */
+        void resolve();
     public:
         /** Initialize the handler
          * @param propClass The prop class
@@ -77,6 +77,11 @@ namespace cssmatch
          */
         EntityProp(const std::string & propClass, const std::string & propPath);
 
+        /** Get the prop offset into the entities
+         * @throws EntityPropException If the prop was not found
+         */
+        int getOffset() throw(EntityPropException);
+
         /** Retrieve a prop reference about a given entity
          * @param entity The VALID entity
          * @throws EntityPropException If the prop was not found
@@ -85,30 +90,41 @@ namespace cssmatch
         T & getProp(edict_t * entity) throw(EntityPropException);
     };
 
+    /** EntityProp whose type is fixed at compile-time
+     * @see EntityProp
+     */
     template<typename T>
-    T & EntityProp::getProp(edict_t * entity) throw(EntityPropException)
+    class TypedEntityProp : public EntityProp
     {
-        if (! initialized)
+    public:
+        /**
+         * @see EntityProp
+         */
+        TypedEntityProp(const std::string & propClass, const std::string & propPath)
+            : EntityProp(propClass, propPath)
+        {}
+
+        /** Retrieve a prop reference about a given entity
+         * @param entity The VALID entity
+         * @throws EntityPropException If the prop was not found
+         */
+        T & get(edict_t * entity) throw(EntityPropException)
         {
-            initialize();
-            initialized = true;
+            return getProp<T>(entity);
         }
+    };
 
-        T * prop = NULL;
+    template<typename T>
+    T & EntityProp::getProp(edict_t * entity) throw(EntityPropException)
+    {
+        int propOffset = getOffset();
 
-        if (offset > 0)
-        {
-            CBaseEntity * baseEntity = getBaseEntity(entity);
-            prop = reinterpret_cast<T *>(reinterpret_cast<char *>(baseEntity) + offset);
-            if (prop == NULL)
-                throw EntityPropException(std::string(
-                                              "CSSMatch was unable to retrieve prop ") + theClass +
-                                          "." + path + " for an entity");
-        }
-        else
+        CBaseEntity * baseEntity = getBaseEntity(entity);
+        T * prop = reinterpret_cast<T *>(reinterpret_cast<char *>(baseEntity) + propOffset);
+        if (prop == NULL)
             throw EntityPropException(std::string(
-                                          "CSSMatch was unable to find the offset of prop ") +
-                                      theClass + "." + path);
+                                          "CSSMatch was unable to retrieve prop ") + theClass +
+                                      "." + path + " for an entity");
 
         return *prop;
     }
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "EntityPropBatch.h"
+
+#include "edict.h" // BaseEntity, edict_t
+
+using namespace cssmatch;
+
+EntityPropBatch::EntityPropBatch() : propCount(0)
+{
+}
+
+int EntityPropBatch::add(TypedEntityProp<int> * prop)
+{
+    int column = -1;
+
+    if (propCount < ENTITY_PROP_BATCH_MAX_PROPS)
+    {
+        column = propCount++;
+        props[column] = prop;
+    }
+
+    return column;
+}
+
+int EntityPropBatch::getSize() const
+{
+    return propCount;
+}
+
+void EntityPropBatch::read(edict_t * const * entities, int entityCount, int * const * columns)
+{
+    int offsets[ENTITY_PROP_BATCH_MAX_PROPS];
+    for (int i=0; i<propCount; i++)
+    {
+        try
+        {
+            offsets[i] = props[i]->getOffset();
+        }
+        catch(const EntityPropException & e)
+        {
+            CSSMATCH_PRINT_EXCEPTION(e);
+            offsets[i] = 0;
+        }
+    }
+
+    for (int i=0; i<entityCount; i++)
+    {
+        char * baseEntity = reinterpret_cast<char *>(getBaseEntity(entities[i]));
+
+        for (int j=0; j<propCount; j++)
+        {
+            if ((baseEntity != NULL) && (offsets[j] > 0))
+                columns[j][i] = *reinterpret_cast<int *>(baseEntity + offsets[j]);
+            else
+                columns[j][i] = -1;
+        }
+    }
+}
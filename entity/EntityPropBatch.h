@@ -0,0 +1,72 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __ENTITY_PROP_BATCH_H__
+#define __ENTITY_PROP_BATCH_H__
+
+#include "EntityProp.h"
+
+/** Maximum number of props read by a batch */
+#define ENTITY_PROP_BATCH_MAX_PROPS 8
+
+namespace cssmatch
+{
+    /** Read several int props of several entities in one pass <br>
+     * The offsets are resolved once per read, and each entity is converted to its base entity
+     * once for all props, then the values are stored as a structure of arrays (one array per
+     * prop)
+     */
+    class EntityPropBatch
+    {
+    private:
+        /** The props to read */
+        TypedEntityProp<int> * props[ENTITY_PROP_BATCH_MAX_PROPS];
+
+        /** Number of props */
+        int propCount;
+    public:
+        EntityPropBatch();
+
+        /** Add a prop to read
+         * @param prop The prop handler (must live as long as the batch)
+         * @return The prop column, or -1 if the batch is full
+         */
+        int add(TypedEntityProp<int> * prop);
+
+        /** Get the number of props */
+        int getSize() const;
+
+        /** Read the props of some entities
+         * @param entities The entities
+         * @param entityCount The number of entities
+         * @param columns One array of <code>entityCount</code> values per prop, in the order the
+         * props were added. A value is -1 if the prop could not be read
+         */
+        void read(edict_t * const * entities, int entityCount, int * const * columns);
+    };
+}
+
+#endif // __ENTITY_PROP_BATCH_H__
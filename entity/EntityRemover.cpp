@@ -0,0 +1,172 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "EntityRemover.h"
+
+#include "../plugin/ServerPlugin.h"
+#include "../player/ClanMember.h"
+
+#include "edict.h"
+#include "eiface.h" // IVEngineServer
+#include "toolframework/itoolentity.h" // IServerTools
+
+#include <cstring>
+
+using namespace cssmatch;
+
+using std::string;
+
+EntityProp EntityRemover::myWeaponsHandler("CBaseCombatCharacter", "m_hMyWeapons");
+
+EntityRemover::EntityRemover() : queueSize(0)
+{
+}
+
+edict_t * EntityRemover::getEntityFromHandle(int handle)
+{
+    edict_t * entity = NULL;
+
+    ValveInterfaces * interfaces = ServerPlugin::getInstance()->getInterfaces();
+    int index = handle & ENT_ENTRY_MASK;
+
+    if ((index > 0) && (index < interfaces->gpGlobals->maxEntities))
+    {
+        edict_t * candidate = interfaces->engine->PEntityOfEntIndex(index);
+        if (isValidEntity(candidate))
+        {
+            // The serial number tells if the handle still refers to this entity
+            IServerNetworkable * networkable = candidate->GetNetworkable();
+            if ((networkable != NULL) &&
+                ((int)networkable->GetEntityHandle()->GetRefEHandle().ToInt() == handle))
+                entity = candidate;
+        }
+    }
+
+    return entity;
+}
+
+void EntityRemover::remove(edict_t * entity)
+{
+    CBaseEntity * baseEntity = getBaseEntity(entity);
+    if (baseEntity != NULL)
+        ServerPlugin::getInstance()->getInterfaces()->serverTools->RemoveEntity(baseEntity);
+}
+
+void EntityRemover::removePlayerItem(int userid, const string & className, bool useKnife)
+{
+    // Coalesce the removals asked several times during the same frame
+    int i = 0;
+    while((i < queueSize) &&
+          ((queue[i].userid != userid) || (className != queue[i].className)))
+    {
+        i++;
+    }
+
+    if (i < queueSize)
+        queue[i].useKnife |= useKnife;
+    else if (queueSize < ENTITY_REMOVER_QUEUE_SIZE)
+    {
+        PlayerItemRemoval & removal = queue[queueSize++];
+        removal.userid = userid;
+        strncpy(removal.className, className.c_str(), ENTITY_REMOVER_CLASS_LENGTH - 1);
+        removal.className[ENTITY_REMOVER_CLASS_LENGTH - 1] = '\0';
+        removal.useKnife = useKnife;
+    }
+    else
+        CSSMATCH_PRINT("Too many entity removals during this frame, " + className + " ignored");
+}
+
+void EntityRemover::flush()
+{
+    if (queueSize > 0)
+    {
+        ServerPlugin * plugin = ServerPlugin::getInstance();
+        ValveInterfaces * interfaces = plugin->getInterfaces();
+
+        int weaponsOffset = 0;
+        try
+        {
+            weaponsOffset = myWeaponsHandler.getOffset();
+        }
+        catch(const EntityPropException & e)
+        {
+            CSSMATCH_PRINT_EXCEPTION(e);
+        }
+
+        bool done[ENTITY_REMOVER_QUEUE_SIZE] = {false};
+        for(int i = 0; i < queueSize; i++)
+        {
+            if (! done[i])
+            {
+                ClanMember * owner = NULL;
+                CSSMATCH_VALID_PLAYER(PlayerHavingUserid, queue[i].userid, owner)
+                {
+                    char * baseEntity =
+                        reinterpret_cast<char *>(getBaseEntity(owner->getIdentity()->pEntity));
+                    bool useKnife = false;
+
+                    if ((baseEntity != NULL) && (weaponsOffset > 0))
+                    {
+                        // One walk of the player's weapons for all the removals
+                        int * weapons = reinterpret_cast<int *>(baseEntity + weaponsOffset);
+                        for(int j = 0; j < ENTITY_REMOVER_MAX_WEAPONS; j++)
+                        {
+                            edict_t * weapon = getEntityFromHandle(weapons[j]);
+                            if (weapon != NULL)
+                            {
+                                const char * weaponClass = weapon->GetClassName();
+                                for(int k = i; k < queueSize; k++)
+                                {
+                                    if ((queue[k].userid == queue[i].userid) &&
+                                        (strcmp(queue[k].className, weaponClass) == 0))
+                                    {
+                                        remove(weapon);
+                                        break;
+                                    }
+                                }
+                            }
+                        }
+                    }
+
+                    for(int k = i; k < queueSize; k++)
+                    {
+                        if (queue[k].userid == queue[i].userid)
+                        {
+                            useKnife |= queue[k].useKnife;
+                            done[k] = true;
+                        }
+                    }
+
+                    if (useKnife)
+                        interfaces->helpers->ClientCommand(owner->getIdentity()->pEntity,
+                                                           "use weapon_knife");
+                }
+            }
+        }
+
+        queueSize = 0;
+    }
+}
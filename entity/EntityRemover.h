@@ -0,0 +1,103 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __ENTITY_REMOVER_H__
+#define __ENTITY_REMOVER_H__
+
+#include "EntityProp.h"
+#include "../misc/BaseSingleton.h"
+
+/** Maximum number of removals waiting for the next flush */
+#define ENTITY_REMOVER_QUEUE_SIZE 64
+
+/** Maximum length of a weapon class name (including the terminating 0) */
+#define ENTITY_REMOVER_CLASS_LENGTH 32
+
+/** Number of weapon slots of a player (MAX_WEAPONS in the game) */
+#define ENTITY_REMOVER_MAX_WEAPONS 48
+
+namespace cssmatch
+{
+    /** Weapon removal waiting for the next flush */
+    struct PlayerItemRemoval
+    {
+        /** Who owns the weapon <br>
+         * userid (connection id), because when the removal is flushed the player may have
+         * disconnected
+         */
+        int userid;
+
+        /** Weapon class name (e.g. "weapon_c4") */
+        char className[ENTITY_REMOVER_CLASS_LENGTH];
+
+        /** Force the player to take knife? */
+        bool useKnife;
+    };
+
+    /** Remove entities without going through the console (no sv_cheats toggling, no ent_remove
+     * scanning all entities) <br>
+     * The weapon removals are queued then flushed once per frame: the removals asked for the
+     * same player during a frame cost one walk of the player's weapons
+     */
+    class EntityRemover : public BaseSingleton<EntityRemover>
+    {
+    private:
+        /** Pending removals */
+        PlayerItemRemoval queue[ENTITY_REMOVER_QUEUE_SIZE];
+
+        /** Number of pending removals */
+        int queueSize;
+
+        /** Entity prop giving the weapons of a player */
+        static EntityProp myWeaponsHandler;
+
+        /** Find the entity corresponding to a handle
+         * @param handle The handle value
+         * @return The entity, or NULL if the handle is not valid anymore
+         */
+        static edict_t * getEntityFromHandle(int handle);
+
+        friend class BaseSingleton<EntityRemover>;
+        EntityRemover();
+    public:
+        /** Remove an entity right now
+         * @param entity The entity to remove
+         */
+        void remove(edict_t * entity);
+
+        /** Queue the removal of a weapon owned by a player
+         * @param userid The player userid
+         * @param className The weapon class name (e.g. "weapon_c4")
+         * @param useKnife <code>true</code> to force the player to take the knife after that
+         */
+        void removePlayerItem(int userid, const std::string & className, bool useKnife);
+
+        /** Do the pending removals (called once per frame) */
+        void flush();
+    };
+}
+
+#endif // __ENTITY_REMOVER_H__
@@ -0,0 +1,337 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "PropOffsetCache.h"
+
+#include "dt_send.h" // SendTable
+#include "server_class.h" // ServerClass
+
+#include "../plugin/ServerPlugin.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+using namespace cssmatch;
+
+using std::string;
+using std::vector;
+
+/** Header of PROP_OFFSET_CACHE_FILE, followed by <code>count</code> (key, offset) pairs */
+struct PropOffsetFileHeader
+{
+    char magic[8];
+    int version;
+    int count;
+    unsigned int binarySize;
+    unsigned int binaryTime;
+};
+
+static const char PROP_OFFSET_MAGIC[8] = {'C', 'S', 'S', 'M', 'P', 'R', 'O', 'P'};
+static const int PROP_OFFSET_VERSION = 3;
+
+/** The server binary (the first one found), the server classes layout changes only with it */
+static const char * SERVER_BINARIES[] =
+{
+#ifdef _WIN32
+    "cstrike/bin/server.dll"
+#else
+    "cstrike/bin/server.so",
+    "cstrike/bin/server_i486.so"
+#endif // _WIN32
+};
+
+PropOffsetCache::PropOffsetCache() : size(0), generation(0), ready(false)
+{
+}
+
+PropKey PropOffsetCache::hash(const char * text, PropKey seed)
+{
+    while(*text != '\0')
+    {
+        seed ^= static_cast<unsigned char>(*text++);
+        seed *= 1099511628211ULL;
+    }
+    return seed;
+}
+
+PropKey PropOffsetCache::makeKey(const string & propClass, const string & propPath)
+{
+    return hash(propPath.c_str(), hash(".", hash(propClass.c_str())));
+}
+
+void PropOffsetCache::insert(PropKey key, int offset)
+{
+    if (key == 0) // 0 marks the free slots
+        key = 1;
+
+    if ((size + 1) * 2 > (int)entries.size())
+    {
+        // Keep the load factor under 50%
+        vector<Entry> oldEntries;
+        oldEntries.swap(entries);
+
+        Entry freeEntry = {0, 0};
+        entries.resize(oldEntries.empty() ? PROP_OFFSET_CACHE_INITIAL_SLOTS :
+                                            oldEntries.size() * 2, freeEntry);
+        size = 0;
+
+        vector<Entry>::const_iterator itEntry = oldEntries.begin();
+        vector<Entry>::const_iterator lastEntry = oldEntries.end();
+        while(itEntry != lastEntry)
+        {
+            if (itEntry->key != 0)
+                insert(itEntry->key, itEntry->offset);
+            itEntry++;
+        }
+    }
+
+    size_t mask = entries.size() - 1;
+    size_t slot = static_cast<size_t>(key) & mask;
+    while(entries[slot].key != 0)
+    {
+        if (entries[slot].key == key)
+            return; // the first prop found wins, as the handlers used to do
+        slot = (slot + 1) & mask;
+    }
+
+    entries[slot].key = key;
+    entries[slot].offset = offset;
+    size++;
+}
+
+void PropOffsetCache::scanTable(SendTable * table, PropKey prefix, int baseOffset)
+{
+    int nbrProps = table->GetNumProps();
+    for (int i=0; i<nbrProps; i++)
+    {
+        SendProp * sProp = table->GetProp(i);
+
+        PropKey key = hash(sProp->GetName(), prefix);
+        int offset = baseOffset + sProp->GetOffset();
+
+        switch(sProp->GetType())
+        {
+        case DPT_Int:
+        case DPT_Float:
+        case DPT_Vector:
+        case DPT_VectorXY:
+        case DPT_String:
+        case DPT_Array:
+            insert(key, offset);
+            break;
+        case DPT_DataTable:
+            insert(key, offset);
+            if (sProp->GetDataTable() != NULL)
+                scanTable(sProp->GetDataTable(), hash(".", key), offset);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+bool PropOffsetCache::getBinaryStamp(unsigned int & binarySize, unsigned int & binaryTime)
+{
+    bool found = false;
+
+    int nbrBinaries = sizeof(SERVER_BINARIES) / sizeof(SERVER_BINARIES[0]);
+    for (int i=0; (i<nbrBinaries) && (! found); i++)
+    {
+        struct stat infos;
+        found = (stat(SERVER_BINARIES[i], &infos) == 0);
+        if (found)
+        {
+            binarySize = (unsigned int)infos.st_size;
+            binaryTime = (unsigned int)infos.st_mtime;
+        }
+    }
+
+    return found;
+}
+
+bool PropOffsetCache::load(unsigned int binarySize, unsigned int binaryTime)
+{
+    bool success = false;
+
+    FILE * file = fopen(PROP_OFFSET_CACHE_FILE, "rb");
+    if (file != NULL)
+    {
+        PropOffsetFileHeader header;
+        if ((fread(&header, sizeof(header), 1, file) == 1) &&
+            (memcmp(header.magic, PROP_OFFSET_MAGIC, sizeof(header.magic)) == 0) &&
+            (header.version == PROP_OFFSET_VERSION) &&
+            (header.binarySize == binarySize) &&
+            (header.binaryTime == binaryTime) &&
+            (header.count > 0))
+        {
+            vector<Entry> saved(header.count);
+            if (fread(&saved[0], sizeof(Entry), header.count, file) == (size_t)header.count)
+            {
+                vector<Entry>::const_iterator itEntry = saved.begin();
+                vector<Entry>::const_iterator lastEntry = saved.end();
+                while(itEntry != lastEntry)
+                {
+                    insert(itEntry->key, itEntry->offset);
+                    itEntry++;
+                }
+                success = true;
+            }
+        }
+        fclose(file);
+    }
+
+    return success;
+}
+
+void PropOffsetCache::save(unsigned int binarySize, unsigned int binaryTime) const
+{
+    vector<Entry> used;
+    used.reserve(size);
+
+    vector<Entry>::const_iterator itEntry = entries.begin();
+    vector<Entry>::const_iterator lastEntry = entries.end();
+    while(itEntry != lastEntry)
+    {
+        if (itEntry->key != 0)
+            used.push_back(*itEntry);
+        itEntry++;
+    }
+
+    PropOffsetFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PROP_OFFSET_MAGIC, sizeof(header.magic));
+    header.version = PROP_OFFSET_VERSION;
+    header.count = (int)used.size();
+    header.binarySize = binarySize;
+    header.binaryTime = binaryTime;
+
+    FILE * file = fopen(PROP_OFFSET_CACHE_FILE, "wb");
+    if (file != NULL)
+    {
+        bool success = (fwrite(&header, sizeof(header), 1, file) == 1);
+        if (success && (! used.empty()))
+            success = (fwrite(&used[0], sizeof(Entry), used.size(), file) == used.size());
+        fclose(file);
+
+        if (! success)
+        {
+            CSSMATCH_PRINT("Unable to write " PROP_OFFSET_CACHE_FILE);
+            remove(PROP_OFFSET_CACHE_FILE);
+        }
+    }
+    else
+        CSSMATCH_PRINT("Unable to create " PROP_OFFSET_CACHE_FILE);
+}
+
+void PropOffsetCache::clear()
+{
+    entries.clear();
+    size = 0;
+}
+
+void PropOffsetCache::build()
+{
+    // The server binary is loaded once per process, so the layout can't change once indexed
+    if (! ready)
+    {
+        IServerGameDLL * serverGameDll =
+            ServerPlugin::getInstance()->getInterfaces()->serverGameDll;
+        if (serverGameDll != NULL)
+        {
+            clear();
+
+            unsigned int binarySize = 0;
+            unsigned int binaryTime = 0;
+            bool stamped = getBinaryStamp(binarySize, binaryTime);
+
+            if ((! stamped) || (! load(binarySize, binaryTime)))
+            {
+                ServerClass * classes = serverGameDll->GetAllServerClasses();
+                while (classes != NULL)
+                {
+                    if (classes->m_pTable != NULL)
+                        scanTable(classes->m_pTable, hash(".", hash(classes->GetName())), 0);
+                    classes = classes->m_pNext;
+                }
+
+                // Without the server binary, the file could not be checked on the next start
+                if (stamped)
+                    save(binarySize, binaryTime);
+            }
+
+            ready = true;
+            generation++;
+        }
+        else
+            CSSMATCH_PRINT("Unable to index the props offsets, IServerGameDll instance not ready")
+    }
+}
+
+bool PropOffsetCache::isReady() const
+{
+    return ready;
+}
+
+int PropOffsetCache::getGeneration() const
+{
+    return generation;
+}
+
+int PropOffsetCache::getSize() const
+{
+    return size;
+}
+
+int PropOffsetCache::find(PropKey key)
+{
+    if (! ready)
+        build();
+
+    int offset = 0;
+
+    if (size > 0)
+    {
+        if (key == 0)
+            key = 1;
+
+        size_t mask = entries.size() - 1;
+        size_t slot = static_cast<size_t>(key) & mask;
+        while(entries[slot].key != 0)
+        {
+            if (entries[slot].key == key)
+            {
+                offset = entries[slot].offset;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    return offset;
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __PROP_OFFSET_CACHE_H__
+#define __PROP_OFFSET_CACHE_H__
+
+#include "../misc/BaseSingleton.h"
+
+#include <string>
+#include <vector>
+
+class SendTable;
+
+/** File where the offsets are persisted between two server starts */
+#define PROP_OFFSET_CACHE_FILE "cstrike/cfg/cssmatch/propoffsets.bin"
+
+/** Initial number of slots of the index (must be a power of two) */
+#define PROP_OFFSET_CACHE_INITIAL_SLOTS 4096
+
+namespace cssmatch
+{
+    /** Hash of a prop full name, i.e. "Class.step1.step2.prop" */
+    typedef unsigned long long PropKey;
+
+    /** Index of the offset of every networked prop of every server class <br>
+     * The SendTables are walked once (or the index is loaded from the disk if the game binaries
+     * did not change), then finding an offset is a constant-time lookup
+     */
+    class PropOffsetCache : public BaseSingleton<PropOffsetCache>
+    {
+    private:
+        /** One slot of the index */
+        struct Entry
+        {
+            /** The prop key, 0 if the slot is free */
+            PropKey key;
+
+            /** The prop offset */
+            int offset;
+        };
+
+        /** Open-addressing table (linear probing) */
+        std::vector<Entry> entries;
+
+        /** Number of used slots */
+        int size;
+
+        /** Incremented each time the index is rebuilt */
+        int generation;
+
+        /** Is the index built? */
+        bool ready;
+
+        /** Add a prop to the index (the first prop found under a given name wins)
+         * @param key The prop key
+         * @param offset The prop offset
+         */
+        void insert(PropKey key, int offset);
+
+        /** Index all the props of a table, and recursively of its sub-tables
+         * @param table The table to scan
+         * @param prefix The key of the path leading to this table
+         * @param baseOffset The offset of this table
+         */
+        void scanTable(SendTable * table, PropKey prefix, int baseOffset);
+
+        /** Get the size and modification time of the server binary <br>
+         * A game update replaces the binary, and thus may change the server classes layout
+         * @param binarySize Out size of the binary
+         * @param binaryTime Out modification time of the binary
+         * @return <code>false</code> if the server binary was not found
+         */
+        static bool getBinaryStamp(unsigned int & binarySize, unsigned int & binaryTime);
+
+        /** Load the index from PROP_OFFSET_CACHE_FILE
+         * @param binarySize The size of the current server binary
+         * @param binaryTime The modification time of the current server binary
+         * @return <code>true</code> if the file was saved for this server binary
+         */
+        bool load(unsigned int binarySize, unsigned int binaryTime);
+
+        /** Save the index into PROP_OFFSET_CACHE_FILE
+         * @param binarySize The size of the current server binary
+         * @param binaryTime The modification time of the current server binary
+         */
+        void save(unsigned int binarySize, unsigned int binaryTime) const;
+
+        /** Empty the index */
+        void clear();
+
+        friend class BaseSingleton<PropOffsetCache>;
+        PropOffsetCache();
+    public:
+        /** Hash a string (FNV-1a), continuing a previous hash
+         * @param text The string to hash
+         * @param seed The previous hash
+         */
+        static PropKey hash(const char * text, PropKey seed = 14695981039346656037ULL);
+
+        /** Compute the key of a prop
+         * @param propClass The prop class
+         * @param propPath The prop path - Step separator is "." (e.g. step1.step2.prop)
+         */
+        static PropKey makeKey(const std::string & propClass, const std::string & propPath);
+
+        /** Build the index, if not already done (and if the server classes are available) */
+        void build();
+
+        /** Is the index built? */
+        bool isReady() const;
+
+        /** Get the number of times the index was rebuilt <br>
+         * The handlers compare it to their own to know if their offset is still valid
+         */
+        int getGeneration() const;
+
+        /** Get the number of indexed props */
+        int getSize() const;
+
+        /** Find the offset of a prop (the index is built if needed)
+         * @param key The prop key
+         * @return The prop offset, or 0 if the prop was not found
+         */
+        int find(PropKey key);
+    };
+}
+
+#endif // __PROP_OFFSET_CACHE_H__
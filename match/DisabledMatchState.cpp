@@ -45,6 +45,11 @@ using namespace cssmatch;
 using std::map;
 using std::string;
 
+// Translation keywords
+static const I18nKeyword ERROR_FILE_NOT_FOUND("error_file_not_found");
+static const I18nKeyword MENU_DISABLE("menu_disable");
+static const I18nKeyword MENU_ENABLE("menu_enable");
+
 DisabledMatchState::DisabledMatchState()
 {
     disabledMenu = new Menu(NULL, "menu_no_match",
@@ -107,14 +112,12 @@ void DisabledMatchState::restartState()
 void DisabledMatchState::showMenu(Player * recipient)
 {
     ServerPlugin * plugin = ServerPlugin::getInstance();
-    ValveInterfaces * interfaces = plugin->getInterfaces();
     I18nManager * i18n = plugin->getI18nManager();
-    string language = interfaces->engine->GetClientConVarValue(
-        recipient->getIdentity()->index, "cl_language");
+    int language = recipient->getLanguageId();
     bool alltalk = plugin->getConVar("sv_alltalk")->GetBool();
 
     map<string, string> parameters;
-    parameters["$action"] = i18n->getTranslation(language, alltalk ? "menu_disable" : "menu_enable");
+    parameters["$action"] = i18n->getTranslation(language, alltalk ? MENU_DISABLE : MENU_ENABLE);
 
     if (plugin->getConVar("cssmatch_advanced")->GetBool())
         recipient->sendMenu(menuWithAdmin, 1, parameters);
@@ -289,7 +292,7 @@ void DisabledMatchState::configQuestionCallback(Player * player, int choice, Men
             map<string, string> parameters;
             parameters["$file"] = selected->text;
 
-            i18n->i18nMsg("error_file_not_found", parameters);
+            i18n->i18nMsg(ERROR_FILE_NOT_FOUND, parameters);
         }
         //catch(const MatchManagerException & e)
         //{
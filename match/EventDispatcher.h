@@ -0,0 +1,162 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __EVENT_DISPATCHER_H__
+#define __EVENT_DISPATCHER_H__
+
+#include "../plugin/Profiler.h"
+
+#include "igameevents.h" // IGameEventManager2, IGameEventListener2, IGameEvent
+
+#include <cstring>
+#include <string>
+
+/** Number of slots in an EventDispatcher table (power of two, twice the number of events we listen) */
+#define EVENT_DISPATCHER_SIZE 16
+
+namespace cssmatch
+{
+    /** Hash an event name (FNV-1a), without building a std::string */
+    inline unsigned int hashEventName(const char * name)
+    {
+        unsigned int hash = 2166136261u;
+        while(*name != '\0')
+        {
+            hash ^= (unsigned char)*name;
+            hash *= 16777619u;
+            name++;
+        }
+        return hash;
+    }
+
+    /** {event name => member callback} table used by the event listeners <br>
+     * The names are hashed once when the callbacks are registered, then an event is dispatched
+     * by probing a flat table (no allocation) <br>
+     * Unknown events are ignored <br>
+     * Each callback is profiled under the name "listener::event"
+     */
+    template<class T>
+    class EventDispatcher
+    {
+    public:
+        typedef void (T::*EventCallback)(IGameEvent * event);
+    private:
+        struct Slot
+        {
+            std::string name;
+            unsigned int hash;
+            EventCallback callback;
+            int probe;
+
+            Slot() : hash(0), callback(NULL), probe(-1){}
+        };
+
+        /** Name of the listener, used to name the profiler probes */
+        std::string listenerName;
+
+        /** Open addressing table, a slot without callback is free */
+        Slot slots[EVENT_DISPATCHER_SIZE];
+
+        /** Get the slot corresponding to an event
+         * @param name The event name
+         * @return The slot, or NULL if the event is unknown
+         */
+        const Slot * find(const char * name) const
+        {
+            const Slot * found = NULL;
+
+            unsigned int hash = hashEventName(name);
+            for(int i = 0; i < EVENT_DISPATCHER_SIZE; i++)
+            {
+                const Slot & slot = slots[(hash + i) & (EVENT_DISPATCHER_SIZE - 1)];
+                if (slot.callback == NULL)
+                    break;
+                if ((slot.hash == hash) && (strcmp(slot.name.c_str(), name) == 0))
+                {
+                    found = &slot;
+                    break;
+                }
+            }
+
+            return found;
+        }
+    public:
+        /**
+         * @param listener Name of the listener using this table
+         */
+        EventDispatcher(const std::string & listener) : listenerName(listener){}
+
+        /** Register a callback
+         * @param name The event name
+         * @param callback The member function to call when this event is fired
+         */
+        void addCallback(const std::string & name, EventCallback callback)
+        {
+            unsigned int hash = hashEventName(name.c_str());
+            for(int i = 0; i < EVENT_DISPATCHER_SIZE; i++)
+            {
+                Slot & slot = slots[(hash + i) & (EVENT_DISPATCHER_SIZE - 1)];
+                if ((slot.callback == NULL) || (slot.name == name))
+                {
+                    slot.name = name;
+                    slot.hash = hash;
+                    slot.callback = callback;
+                    slot.probe = Profiler::getInstance()->registerProbe(listenerName + "::" + name);
+                    break;
+                }
+            }
+        }
+
+        /** Call the callback corresponding to an event
+         * @param listener The instance which listens the event
+         * @param event The event fired
+         */
+        void dispatch(T * listener, IGameEvent * event) const
+        {
+            const Slot * slot = find(event->GetName());
+            if (slot != NULL)
+            {
+                ProfileScope profileScope(slot->probe);
+                (listener->*slot->callback)(event);
+            }
+        }
+
+        /** Subscribe a listener to all the events of the table
+         * @param manager Valve's IGameEventManager2 instance
+         * @param listener The instance which listens the events
+         */
+        void listen(IGameEventManager2 * manager, IGameEventListener2 * listener) const
+        {
+            for(int i = 0; i < EVENT_DISPATCHER_SIZE; i++)
+            {
+                if (slots[i].callback != NULL)
+                    manager->AddListener(listener, slots[i].name.c_str(), true);
+            }
+        }
+    };
+}
+
+#endif // __EVENT_DISPATCHER_H__
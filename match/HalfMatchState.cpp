@@ -48,7 +48,25 @@ using std::map;
 using std::ostringstream;
 using std::for_each;
 
-HalfMatchState::HalfMatchState() : finished(false), roundRestarted(false), halfRestarted(false)
+// Translation keywords
+static const I18nKeyword ADMIN_MANCHE_RESTARTED("admin_manche_restarted");
+static const I18nKeyword ADMIN_MANCHE_RESTARTED_BY("admin_manche_restarted_by");
+static const I18nKeyword ADMIN_ROUND_RESTARTED("admin_round_restarted");
+static const I18nKeyword ADMIN_ROUND_RESTARTED_BY("admin_round_restarted_by");
+static const I18nKeyword ERROR_TV_NOT_CONNECTED("error_tv_not_connected");
+static const I18nKeyword MATCH_DEAD_TIME("match_dead_time");
+static const I18nKeyword MATCH_END_CURRENT_MANCHE("match_end_current_manche");
+static const I18nKeyword MATCH_END_MANCHE_POPUP("match_end_manche_popup");
+static const I18nKeyword MATCH_GO("match_go");
+static const I18nKeyword MATCH_NAME("match_name");
+static const I18nKeyword MATCH_RESTARTS("match_restarts");
+static const I18nKeyword MATCH_ROUND_POPUP("match_round_popup");
+static const I18nKeyword MATCH_START_MANCHE("match_start_manche");
+static const I18nKeyword MENU_DISABLE("menu_disable");
+static const I18nKeyword MENU_ENABLE("menu_enable");
+
+HalfMatchState::HalfMatchState()
+    : eventCallbacks("HalfMatchState"), finished(false), roundRestarted(false), halfRestarted(false)
 {
     halfMenu =
         new Menu(NULL, "menu_match",
@@ -69,9 +87,9 @@ HalfMatchState::HalfMatchState() : finished(false), roundRestarted(false), halfR
     menuWithAdmin->addLine(true, "menu_retag");
     menuWithAdmin->addLine(true, "menu_restart_manche");
 
-    eventCallbacks["player_death"] = &HalfMatchState::player_death;
-    eventCallbacks["round_start"] = &HalfMatchState::round_start;
-    eventCallbacks["round_end"] = &HalfMatchState::round_end;
+    eventCallbacks.addCallback("player_death", &HalfMatchState::player_death);
+    eventCallbacks.addCallback("round_start", &HalfMatchState::round_start);
+    eventCallbacks.addCallback("round_end", &HalfMatchState::round_end);
 }
 
 HalfMatchState::~HalfMatchState()
@@ -89,14 +107,11 @@ void HalfMatchState::startState()
     I18nManager * i18n = plugin->getI18nManager();
 
     // Subscribe to the needed game events
-    map<string, EventCallback>::iterator itEvent;
-    for(itEvent = eventCallbacks.begin(); itEvent != eventCallbacks.end(); itEvent++)
-    {
-        interfaces->gameeventmanager2->AddListener(this, itEvent->first.c_str(), true);
-    }
+    eventCallbacks.listen(interfaces->gameeventmanager2, this);
 
     infos->roundNumber = -2; // a negative round number causes a game restart (see round_start)
     finished = false; // (This half is not finished yet)
+    roundStates.clear();
 
     RecipientFilter recipients;
     recipients.addAllPlayers();
@@ -122,7 +137,7 @@ void HalfMatchState::startState()
         }
         catch(const TvRecordException & e)
         {
-            i18n->i18nChatWarning(recipients, "error_tv_not_connected");
+            i18n->i18nChatWarning(recipients, ERROR_TV_NOT_CONNECTED);
         }
     }
 
@@ -130,9 +145,9 @@ void HalfMatchState::startState()
     map<string, string> parameters;
     parameters["$current"] = toString(infos->halfNumber);
     parameters["$total"] = plugin->getConVar("cssmatch_sets")->GetString();
-    i18n->i18nChatSay(recipients, "match_start_manche", parameters);
+    i18n->i18nChatSay(recipients, MATCH_START_MANCHE, parameters);
 
-    i18n->i18nChatSay(recipients, "match_restarts");
+    i18n->i18nChatSay(recipients, MATCH_RESTARTS);
 
     plugin->queueCommand("mp_restartgame 2\n");
 }
@@ -214,9 +229,9 @@ void HalfMatchState::restartState()
         map<string, string> parameters;
         parameters["$current"] = toString(infos->halfNumber);
         parameters["$total"] = plugin->getConVar("cssmatch_sets")->GetString();
-        i18n->i18nChatSay(recipients, "match_start_manche", parameters);
+        i18n->i18nChatSay(recipients, MATCH_START_MANCHE, parameters);
 
-        i18n->i18nChatSay(recipients, "match_restarts");
+        i18n->i18nChatSay(recipients, MATCH_RESTARTS);
 
         // Do the restart
         plugin->queueCommand("mp_restartgame 2\n");
@@ -226,14 +241,12 @@ void HalfMatchState::restartState()
 void HalfMatchState::showMenu(Player * recipient)
 {
     ServerPlugin * plugin = ServerPlugin::getInstance();
-    ValveInterfaces * interfaces = plugin->getInterfaces();
     I18nManager * i18n = plugin->getI18nManager();
-    string language = interfaces->engine->GetClientConVarValue(
-        recipient->getIdentity()->index, "cl_language");
+    int language = recipient->getLanguageId();
     bool alltalk = plugin->getConVar("sv_alltalk")->GetBool();
 
     map<string, string> parameters;
-    parameters["$action"] = i18n->getTranslation(language, alltalk ? "menu_disable" : "menu_enable");
+    parameters["$action"] = i18n->getTranslation(language, alltalk ? MENU_DISABLE : MENU_ENABLE);
 
     if (plugin->getConVar("cssmatch_advanced")->GetBool())
         recipient->sendMenu(menuWithAdmin, 1, parameters);
@@ -270,10 +283,10 @@ void HalfMatchState::halfMenuCallback(Player * player, int choice, MenuLine * se
         if (isValidPlayerInfo(pInfo))
         {
             parameters["$admin"] = pInfo->GetName();
-            i18n->i18nChatSay(recipients, "admin_round_restarted_by", parameters, identity->index);
+            i18n->i18nChatSay(recipients, ADMIN_ROUND_RESTARTED_BY, parameters, identity->index);
         }
         else
-            i18n->i18nChatSay(recipients, "admin_round_restarted");
+            i18n->i18nChatSay(recipients, ADMIN_ROUND_RESTARTED);
 
         match->restartRound();
     }
@@ -294,7 +307,7 @@ void HalfMatchState::halfMenuCallback(Player * player, int choice, MenuLine * se
         map<string, string> parameters;
         parameters["$team1"] = *lignup->clan1.getName();
         parameters["$team2"] = *lignup->clan2.getName();
-        i18n->i18nChatSay(recipients, "match_name", parameters);
+        i18n->i18nChatSay(recipients, MATCH_NAME, parameters);
 
         player->quitMenu();
     }
@@ -310,10 +323,10 @@ void HalfMatchState::halfMenuCallback(Player * player, int choice, MenuLine * se
         if (isValidPlayerInfo(pInfo))
         {
             parameters["$admin"] = pInfo->GetName();
-            i18n->i18nChatSay(recipients, "admin_manche_restarted_by", parameters, identity->index);
+            i18n->i18nChatSay(recipients, ADMIN_MANCHE_RESTARTED_BY, parameters, identity->index);
         }
         else
-            i18n->i18nChatSay(recipients, "admin_manche_restarted");
+            i18n->i18nChatSay(recipients, ADMIN_MANCHE_RESTARTED);
 
         match->restartHalf();
     }
@@ -345,7 +358,7 @@ void HalfMatchState::endHalf()
     plugin->queueCommand("plugin_print\n");
 
     /*// Update the state of each player
-    list<ClanMember *> * playerlist = plugin->getPlayerlist();
+    const PlayerList * playerlist = plugin->getPlayerlist();
     for_each(playerlist->begin(),playerlist->end(),SaveHalfPlayerState());*/
 
     // Update the score history of each clan
@@ -382,7 +395,7 @@ void HalfMatchState::endHalf()
         {
             map<string, string> timeoutParameters;
             timeoutParameters["$time"] = toString(timeoutDuration);
-            plugin->addTimer(new TimerI18nChatSay(2.0f, recipients, "match_dead_time",
+            plugin->addTimer(new TimerI18nChatSay(2.0f, recipients, MATCH_DEAD_TIME,
                                                   timeoutParameters));
 
             TimeoutMatchState::doTimeout(timeoutDuration, nextState);
@@ -423,7 +436,7 @@ void HalfMatchState::finish()
 
     parameters["$current"] = toString(infos->halfNumber);
 
-    i18n->i18nChatSay(recipients, "match_end_current_manche", parameters);
+    i18n->i18nChatSay(recipients, MATCH_END_CURRENT_MANCHE, parameters);
 
     ClanStats * statsClan1 = lignup->clan1.getStats();
     parameters["$team1"] = *lignup->clan1.getName();
@@ -433,7 +446,7 @@ void HalfMatchState::finish()
     parameters["$team2"] = *lignup->clan2.getName();
     parameters["$score2"] = toString(statsClan2->scoreCT + statsClan2->scoreT);
 
-    i18n->i18nPopupSay(recipients, "match_end_manche_popup", 6, parameters);
+    i18n->i18nPopupSay(recipients, MATCH_END_MANCHE_POPUP, 6, parameters);
     //i18n->i18nConsoleSay(recipients,"match_end_manche_popup",parameters);
 }
 
@@ -441,7 +454,7 @@ void HalfMatchState::FireGameEvent(IGameEvent * event)
 {
     try
     {
-        (this->*eventCallbacks[event->GetName()])(event);
+        eventCallbacks.dispatch(this, event);
     }
     catch(const BaseException & e)
     {
@@ -454,6 +467,9 @@ void HalfMatchState::player_death(IGameEvent * event)
     // Update the score [history] of the involved players
 
     ServerPlugin * plugin = ServerPlugin::getInstance();
+    MatchJournal * journal = plugin->getMatch()->getJournal();
+    int victimDeaths = 0;
+    int attackerScore = 0;
 
     int idVictim = event->GetInt("userid");
     ClanMember * victim = NULL;
@@ -461,6 +477,7 @@ void HalfMatchState::player_death(IGameEvent * event)
     {
         PlayerScore * currentScore = victim->getCurrentScore();
         currentScore->deaths++;
+        victimDeaths = 1;
     }
 
     int idAttacker = event->GetInt("attacker");
@@ -471,11 +488,15 @@ void HalfMatchState::player_death(IGameEvent * event)
         {
             PlayerScore * currentScore = attacker->getCurrentScore();
             if (attacker->getMyTeam() != victim->getMyTeam())
-                currentScore->kills++;
+                attackerScore = 1;
             else
-                currentScore->kills--;
+                attackerScore = -1;
+            currentScore->kills += attackerScore;
         }
     }
+
+    journal->logKill(idAttacker, idVictim, attackerScore, victimDeaths,
+                     event->GetBool("headshot"), event->GetString("weapon"));
 }
 
 void HalfMatchState::round_start(IGameEvent * event)
@@ -492,7 +513,8 @@ void HalfMatchState::round_start(IGameEvent * event)
         MatchManager * match = plugin->getMatch();
         I18nManager * i18n = plugin->getI18nManager();
 
-        list<ClanMember *> * playerlist = plugin->getPlayerlist();
+        const PlayerList * playerlist = plugin->getPlayerlist();
+        MatchJournal * journal = match->getJournal();
 
         // Do the restart and announce the begin of a new round
 
@@ -517,12 +539,13 @@ void HalfMatchState::round_start(IGameEvent * event)
         case 0:
             match->sendStatus(recipients);
 
-            i18n->i18nChatSay(recipients, "match_go");
+            i18n->i18nChatSay(recipients, MATCH_GO);
 
             if (! halfRestarted)
             {
-                list<ClanMember *> * playerlist = plugin->getPlayerlist();
+                const PlayerList * playerlist = plugin->getPlayerlist();
                 for_each(playerlist->begin(), playerlist->end(), SaveHalfPlayerState());
+                journal->logEvent(JOURNAL_HALF_START);
             }
         default:
         {
@@ -530,6 +553,8 @@ void HalfMatchState::round_start(IGameEvent * event)
             if (roundRestarted)
             {
                 for_each(playerlist->begin(), playerlist->end(), RestoreRoundPlayerState());
+                roundStates.restore();
+                journal->logEvent(JOURNAL_ROUND_RESTART);
                 roundRestarted = false;
             }
             else
@@ -537,9 +562,12 @@ void HalfMatchState::round_start(IGameEvent * event)
                 if (halfRestarted)
                 {
                     for_each(playerlist->begin(), playerlist->end(), RestoreHalfPlayerScore());
+                    journal->logEvent(JOURNAL_HALF_RESTART);
                     halfRestarted = false;
                 }
                 for_each(playerlist->begin(), playerlist->end(), SaveRoundPlayerState());
+                roundStates.capture();
+                journal->logEvent(JOURNAL_ROUND_START);
             }
 
             parameters["$current"] = toString(infos->roundNumber);
@@ -548,7 +576,7 @@ void HalfMatchState::round_start(IGameEvent * event)
             parameters["$score1"] = toString(statsClan1->scoreCT + statsClan1->scoreT);
             parameters["$team2"] = *lignup->clan2.getName();
             parameters["$score2"] = toString(statsClan2->scoreCT + statsClan2->scoreT);
-            plugin->addTimer(new TimerI18nPopupSay(1.5f, recipients, "match_round_popup", 5,
+            plugin->addTimer(new TimerI18nPopupSay(1.5f, recipients, MATCH_ROUND_POPUP, 5,
                                                    parameters));
         }
         }
@@ -565,6 +593,7 @@ void HalfMatchState::round_end(IGameEvent * event)
 
     if (infos->roundNumber > 0) // otherwise the restarts haven't even occured yet
     {
+        bool scored = false;
         if ((plugin->getPlayerCount(T_TEAM) > 0) && (plugin->getPlayerCount(CT_TEAM) > 0)
             && (strcmp(event->GetString("message"), "#Round_Draw") != 0)
             && (strcmp(event->GetString("message"), "#Game_Commencing") != 0))
@@ -582,6 +611,7 @@ void HalfMatchState::round_end(IGameEvent * event)
                     winner->getStats()->scoreCT++;
                     break;
                 }
+                scored = true;
                 if (infos->roundNumber >= plugin->getConVar("cssmatch_rounds")->GetInt())
                     finish();
             }
@@ -594,6 +624,9 @@ void HalfMatchState::round_end(IGameEvent * event)
         {
             restartRound();
         }
+
+        match->getJournal()->logRoundEnd(event->GetInt("winner"), event->GetInt("reason"),
+                                         scored);
     }
 }
 
@@ -606,8 +639,8 @@ void SwapTimer::execute()
     ServerPlugin * plugin = ServerPlugin::getInstance();
     MatchManager * match = plugin->getMatch();
 
-    list<ClanMember *> * playerlist = plugin->getPlayerlist();
-    list<ClanMember *>::iterator itPlayer;
+    const PlayerList * playerlist = plugin->getPlayerlist();
+    PlayerList::const_iterator itPlayer;
     for(itPlayer = playerlist->begin(); itPlayer != playerlist->end(); itPlayer++)
     {
         (*itPlayer)->swap(/*false*/);
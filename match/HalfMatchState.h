@@ -31,6 +31,9 @@
 #include "../misc/BaseSingleton.h"
 #include "../plugin/BaseTimer.h"
 #include "../messages/Menu.h"
+#include "../player/RoundStateBuffer.h"
+
+#include "EventDispatcher.h"
 
 #include "igameevents.h" // IGameEventListener2, IGameEvent
 
@@ -49,10 +52,8 @@ namespace cssmatch
         : public BaseMatchState, public BaseSingleton<HalfMatchState>, public IGameEventListener2
     {
     private:
-        typedef void (HalfMatchState::*EventCallback)(IGameEvent * event);
-
-        /** {event => callback} map used in FireGameEvent */
-        std::map<std::string, EventCallback> eventCallbacks;
+        /** {event => callback} table used in FireGameEvent */
+        EventDispatcher<HalfMatchState> eventCallbacks;
 
         /** Menus for this state*/
         Menu * halfMenu;
@@ -64,6 +65,9 @@ namespace cssmatch
         // The last round/half has been restarted?
         bool roundRestarted, halfRestarted;
 
+        /** Money, weapons and position of the players at the start of the current round */
+        RoundStateBuffer roundStates;
+
         friend class BaseSingleton<HalfMatchState>;
         HalfMatchState();
         ~HalfMatchState();
@@ -30,6 +30,7 @@
 #include "../misc/common.h"
 #include "../player/Player.h"
 #include "../player/ClanMember.h"
+#include "../entity/EntityRemover.h"
 #include "../messages/I18nManager.h"
 #include "DisabledMatchState.h"
 #include "TimeoutMatchState.h"
@@ -46,7 +47,18 @@ using std::list;
 using std::map;
 using std::ostringstream;
 
-KnifeRoundMatchState::KnifeRoundMatchState()
+// Translation keywords
+static const I18nKeyword ADMIN_ROUND_RESTARTED("admin_round_restarted");
+static const I18nKeyword ADMIN_ROUND_RESTARTED_BY("admin_round_restarted_by");
+static const I18nKeyword KNIFEROUND_ANNOUNCEMENT("kniferound_announcement");
+static const I18nKeyword KNIFEROUND_DEAD_TIME("kniferound_dead_time");
+static const I18nKeyword KNIFEROUND_RESTARTS("kniferound_restarts");
+static const I18nKeyword KNIFEROUND_WINNER("kniferound_winner");
+static const I18nKeyword MATCH_NAME("match_name");
+static const I18nKeyword MENU_DISABLE("menu_disable");
+static const I18nKeyword MENU_ENABLE("menu_enable");
+
+KnifeRoundMatchState::KnifeRoundMatchState() : eventCallbacks("KnifeRoundMatchState")
 {
     kniferoundMenu = new Menu(NULL, "menu_kniferound",
                               new MenuCallback<KnifeRoundMatchState>(this,
@@ -67,11 +79,11 @@ KnifeRoundMatchState::KnifeRoundMatchState()
     menuWithAdmin->addLine(true, "menu_stop");
     menuWithAdmin->addLine(true, "menu_retag");
 
-    eventCallbacks["round_start"] = &KnifeRoundMatchState::round_start;
-    eventCallbacks["item_pickup"] = &KnifeRoundMatchState::item_pickup;
-    eventCallbacks["player_spawn"] = &KnifeRoundMatchState::player_spawn;
-    eventCallbacks["round_end"] = &KnifeRoundMatchState::round_end;
-    //eventCallbacks["bomb_beginplant"] = &KnifeRoundMatchState::bomb_beginplant;
+    eventCallbacks.addCallback("round_start", &KnifeRoundMatchState::round_start);
+    eventCallbacks.addCallback("item_pickup", &KnifeRoundMatchState::item_pickup);
+    eventCallbacks.addCallback("player_spawn", &KnifeRoundMatchState::player_spawn);
+    eventCallbacks.addCallback("round_end", &KnifeRoundMatchState::round_end);
+    //eventCallbacks.addCallback("bomb_beginplant", &KnifeRoundMatchState::bomb_beginplant);
 }
 
 KnifeRoundMatchState::~KnifeRoundMatchState()
@@ -104,13 +116,13 @@ void KnifeRoundMatchState::endKniferound(TeamCode winner)
     // Announce the winner
     map<string, string> parameters;
     parameters["$team"] = *infos->kniferoundWinner->getName();
-    i18n->i18nChatSay(recipients, "kniferound_winner", parameters);
+    i18n->i18nChatSay(recipients, KNIFEROUND_WINNER, parameters);
 
     // Invite the winners to choice a side
     TeamCode teamLoser = (winner == T_TEAM) ? CT_TEAM : T_TEAM;
 
-    list<ClanMember *> * playerlist = plugin->getPlayerlist();
-    list<ClanMember *>::iterator itPlayer;
+    const PlayerList * playerlist = plugin->getPlayerlist();
+    PlayerList::const_iterator itPlayer;
     for(itPlayer = playerlist->begin(); itPlayer != playerlist->end(); itPlayer++)
     {
         PlayerIdentity * identity = (*itPlayer)->getIdentity();
@@ -155,7 +167,7 @@ void KnifeRoundMatchState::endKniferound(TeamCode winner)
 
             //parameters["$team"] = // already set above
             parameters["$time"] = toString(timeoutDuration);
-            i18n->i18nChatSay(recipients, "kniferound_dead_time", parameters);
+            i18n->i18nChatSay(recipients, KNIFEROUND_DEAD_TIME, parameters);
         }
         else
         {
@@ -180,13 +192,9 @@ void KnifeRoundMatchState::startState()
     recipients.addAllPlayers();
 
     // Register to the needed events
-    map<string, EventCallback>::iterator itEvent;
-    for(itEvent = eventCallbacks.begin(); itEvent != eventCallbacks.end(); itEvent++)
-    {
-        interfaces->gameeventmanager2->AddListener(this, itEvent->first.c_str(), true);
-    }
+    eventCallbacks.listen(interfaces->gameeventmanager2, this);
 
-    i18n->i18nChatSay(recipients, "kniferound_restarts");
+    i18n->i18nChatSay(recipients, KNIFEROUND_RESTARTS);
 
     match->getInfos()->roundNumber = -2; // a negative round number causes a game restart (see
                                          // round_start)
@@ -224,14 +232,12 @@ void KnifeRoundMatchState::restartState()
 void KnifeRoundMatchState::showMenu(Player * recipient)
 {
     ServerPlugin * plugin = ServerPlugin::getInstance();
-    ValveInterfaces * interfaces = plugin->getInterfaces();
     I18nManager * i18n = plugin->getI18nManager();
-    string language = interfaces->engine->GetClientConVarValue(
-        recipient->getIdentity()->index, "cl_language");
+    int language = recipient->getLanguageId();
     bool alltalk = plugin->getConVar("sv_alltalk")->GetBool();
 
     map<string, string> parameters;
-    parameters["$action"] = i18n->getTranslation(language, alltalk ? "menu_disable" : "menu_enable");
+    parameters["$action"] = i18n->getTranslation(language, alltalk ? MENU_DISABLE : MENU_ENABLE);
 
     if (plugin->getConVar("cssmatch_advanced")->GetBool())
         recipient->sendMenu(menuWithAdmin, 1, parameters);
@@ -268,10 +274,10 @@ void KnifeRoundMatchState::kniferoundMenuCallback(Player * player, int choice, M
         if (isValidPlayerInfo(pInfo))
         {
             parameters["$admin"] = pInfo->GetName();
-            i18n->i18nChatSay(recipients, "admin_round_restarted_by", parameters, identity->index);
+            i18n->i18nChatSay(recipients, ADMIN_ROUND_RESTARTED_BY, parameters, identity->index);
         }
         else
-            i18n->i18nChatSay(recipients, "admin_round_restarted");
+            i18n->i18nChatSay(recipients, ADMIN_ROUND_RESTARTED);
 
         match->restartRound();
     }
@@ -293,7 +299,7 @@ void KnifeRoundMatchState::kniferoundMenuCallback(Player * player, int choice, M
         map<string, string> parameters;
         parameters["$team1"] = *lignup->clan1.getName();
         parameters["$team2"] = *lignup->clan2.getName();
-        i18n->i18nChatSay(recipients, "match_name", parameters);
+        i18n->i18nChatSay(recipients, MATCH_NAME, parameters);
 
         player->quitMenu();
     }
@@ -319,7 +325,7 @@ void KnifeRoundMatchState::FireGameEvent(IGameEvent * event)
 {
     try
     {
-        (this->*eventCallbacks[event->GetName()])(event);
+        eventCallbacks.dispatch(this, event);
     }
     catch(const BaseException & e)
     {
@@ -348,7 +354,7 @@ void KnifeRoundMatchState::round_start(IGameEvent * event)
         RecipientFilter recipients;
         recipients.addAllPlayers();
 
-        i18n->i18nChatSay(recipients, "kniferound_announcement");
+        i18n->i18nChatSay(recipients, KNIFEROUND_ANNOUNCEMENT);
     }
 }
 
@@ -370,12 +376,12 @@ void KnifeRoundMatchState::item_pickup(IGameEvent * event)
             if (item == "c4")
             {
                 if (! plugin->getConVar("cssmatch_kniferound_allows_c4")->GetBool())
-                    plugin->addTimer(new ItemRemoveTimer(userid, "weapon_c4", false));
+                    EntityRemover::getInstance()->removePlayerItem(userid, "weapon_c4", false);
             }
             else if (strstr(plugin->getConVar("cssmatch_weapons")->GetString(),
                             item.c_str()) != NULL)
             {
-                plugin->addTimer(new ItemRemoveTimer(userid, "weapon_" + item, true));
+                EntityRemover::getInstance()->removePlayerItem(userid, "weapon_" + item, true);
             }
         }
         else
@@ -449,31 +455,3 @@ void KnifeRoundMatchState::bomb_beginplant(IGameEvent * event)
             CSSMATCH_PRINT("Unable to find the player who plants the bomb");
     }
 }*/
-
-ItemRemoveTimer::ItemRemoveTimer(int playerUserid, const string & item, bool switchKnife)
-    : BaseTimer(0.1f), userid(playerUserid), toRemove(item), useKnife(switchKnife)
-{
-}
-
-void ItemRemoveTimer::execute()
-{
-    ServerPlugin * plugin = ServerPlugin::getInstance();
-    ConVar * sv_cheats = plugin->getConVar("sv_cheats");
-
-    ostringstream command;
-    command << "ent_remove_all " << toRemove << "\n";
-
-    sv_cheats->m_nValue = 1;
-    plugin->executeCommand(command.str());
-    sv_cheats->m_nValue = 0;
-
-    if (useKnife)
-    {
-		ClanMember * owner;
-		CSSMATCH_VALID_PLAYER(PlayerHavingUserid, userid, owner)
-		{
-			ValveInterfaces * interfaces = plugin->getInterfaces();
-			interfaces->helpers->ClientCommand(owner->getIdentity()->pEntity, "use weapon_knife");
-		}
-    }
-}
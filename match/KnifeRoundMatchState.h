@@ -33,6 +33,8 @@
 #include "../messages/Menu.h"
 #include "../plugin/BaseTimer.h"
 
+#include "EventDispatcher.h"
+
 #include "igameevents.h" // IGameEventListener2, IGameEvent
 
 #include <map>
@@ -51,10 +53,8 @@ namespace cssmatch
         public IGameEventListener2
     {
     private:
-        typedef void (KnifeRoundMatchState::*EventCallback)(IGameEvent * event);
-
-        /** {event => callback} map used in FireGameEvent */
-        std::map<std::string, EventCallback> eventCallbacks;
+        /** {event => callback} table used in FireGameEvent */
+        EventDispatcher<KnifeRoundMatchState> eventCallbacks;
 
         /** Menus for this state*/
         Menu * kniferoundMenu;
@@ -90,30 +90,6 @@ namespace cssmatch
         //void bomb_beginplant(IGameEvent * event);
     };
 
-    /** Removes an item the player has */
-    class ItemRemoveTimer : public BaseTimer
-    {
-    private:
-        /** Who owns the item */
-        int userid;
-		// userid (connection id), because when this timer ends the player may have disconnected
-
-        /** Item to remove */
-        std::string toRemove;
-
-        /** Force the player to take knife? */
-        bool useKnife;
-    public:
-		/**
-         * @param playerUserid Player's userid
-         * @param item Item to remove
-         * @see switchKnife <code>true</code> to force the user of the knife
-         */
-        ItemRemoveTimer(int playerUserid, const std::string & item, bool switchKnife);
-
-        void execute();
-    };
-
 }
 
 #endif // __KNIFEROUND_MATCH_STATE_H__
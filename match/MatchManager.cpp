@@ -34,6 +34,8 @@
 #include "../player/ClanMember.h"
 #include "../sourcetv/TvRecord.h"
 #include "../report/XmlReport.h"
+#include "../report/ReportWriter.h"
+#include "../player/ClanDetectionThread.h"
 
 #include <algorithm>
 #include <sstream>
@@ -44,11 +46,26 @@ using namespace cssmatch;
 
 using std::string;
 using std::list;
+using std::vector;
 using std::for_each;
 using std::map;
 using std::endl;
 using std::ostringstream;
 
+// Translation keywords
+static const I18nKeyword ERROR_FILE_NOT_FOUND("error_file_not_found");
+static const I18nKeyword MATCH_DEAD_TIME("match_dead_time");
+static const I18nKeyword MATCH_END("match_end");
+static const I18nKeyword MATCH_END_POPUP("match_end_popup");
+static const I18nKeyword MATCH_NO_WINNER("match_no_winner");
+static const I18nKeyword MATCH_PASSWORD_POPUP("match_password_popup");
+static const I18nKeyword MATCH_PASSWORD_REMEMBER("match_password_remember");
+static const I18nKeyword MATCH_PLEASE_CHANGELEVEL("match_please_changelevel");
+static const I18nKeyword MATCH_WINNER("match_winner");
+static const I18nKeyword PLAYER_JOIN_GAME("player_join_game");
+static const I18nKeyword SV_ALLTALK("sv_alltalk");
+static const I18nKeyword SV_CHEATS("sv_cheats");
+
 void MatchManager::updateHostname()
 {
     ServerPlugin * plugin = ServerPlugin::getInstance();
@@ -82,7 +99,7 @@ void MatchManager::propagateClanNameChanges(MatchClan * clan)
 }
 
 MatchManager::MatchManager(BaseMatchState * iniState) throw(MatchManagerException)
-    : initialState(iniState), currentState(NULL)
+    : eventCallbacks("MatchManager"), initialState(iniState), currentState(NULL)
 {
     if (iniState == NULL)
         throw MatchManagerException("Initial match state can't be NULL");
@@ -90,10 +107,10 @@ MatchManager::MatchManager(BaseMatchState * iniState) throw(MatchManagerExceptio
     currentState = iniState;
     currentState->startState();
 
-    eventCallbacks["player_activate"] = &MatchManager::player_activate;
-    eventCallbacks["player_disconnect"] = &MatchManager::player_disconnect;
-    eventCallbacks["player_team"] = &MatchManager::player_team;
-    eventCallbacks["player_changename"] = &MatchManager::player_changename;
+    eventCallbacks.addCallback("player_activate", &MatchManager::player_activate);
+    eventCallbacks.addCallback("player_disconnect", &MatchManager::player_disconnect);
+    eventCallbacks.addCallback("player_team", &MatchManager::player_team);
+    eventCallbacks.addCallback("player_changename", &MatchManager::player_changename);
 }
 
 
@@ -117,6 +134,11 @@ std::list<TvRecord *> * MatchManager::getRecords()
     return &records;
 }
 
+MatchJournal * MatchManager::getJournal()
+{
+    return &journal;
+}
+
 BaseMatchState * MatchManager::getInitialState() const
 {
     return initialState;
@@ -157,7 +179,7 @@ void MatchManager::FireGameEvent(IGameEvent * event)
 {
     try
     {
-        (this->*eventCallbacks[event->GetName()])(event);
+        eventCallbacks.dispatch(this, event);
     }
     catch(const BaseException & e)
     {
@@ -175,6 +197,9 @@ void MatchManager::player_activate(IGameEvent * event)
         ServerPlugin * plugin = ServerPlugin::getInstance();
         I18nManager * i18n = plugin->getI18nManager();
         IPlayerInfo * pInfo = player->getPlayerInfo();
+        PlayerIdentity * identity = player->getIdentity();
+        journal.logPlayer(identity->userid, identity->steamid);
+
         if (isValidPlayerInfo(pInfo))
         {
             RecipientFilter recipients;
@@ -182,7 +207,7 @@ void MatchManager::player_activate(IGameEvent * event)
             map<string, string> parameters;
             parameters["$username"] = pInfo->GetName();
 
-            i18n->i18nChatSay(recipients, "player_join_game", parameters);
+            i18n->i18nChatSay(recipients, PLAYER_JOIN_GAME, parameters);
         }
 
         /*RecipientFilter newplayerRecipient;
@@ -210,7 +235,7 @@ void MatchManager::player_disconnect(IGameEvent * event)
     // Announce the password too
     map<string, string> passParameters;
     passParameters["$password"] = plugin->getConVar("sv_password")->GetString();
-    plugin->addTimer(new TimerI18nChatSay(2.0f, recipients, "match_password_remember",
+    plugin->addTimer(new TimerI18nChatSay(2.0f, recipients, MATCH_PASSWORD_REMEMBER,
                                           passParameters));
 
     // If all the players have disconnected, stop the match (and thus the SourceTv record)
@@ -229,6 +254,8 @@ void MatchManager::player_team(IGameEvent * event)
     TeamCode newSide = (TeamCode)event->GetInt("team");
     TeamCode oldSide = (TeamCode)event->GetInt("oldteam");
 
+    journal.logTeam(event->GetInt("userid"), newSide, oldSide);
+
     int playercount = 0;
     TeamCode toReDetect = INVALID_TEAM;
     switch(newSide)
@@ -307,6 +334,46 @@ void MatchManager::detectClanName(TeamCode code, bool force) throw(MatchManagerE
         throw MatchManagerException("No match in progress");
 }
 
+void MatchManager::requestClanNameDetection(TeamCode code) throw(MatchManagerException)
+{
+    if (currentState != initialState)
+    {
+        ServerPlugin * plugin = ServerPlugin::getInstance();
+        ClanDetectionThread * detectionThread = plugin->getClanDetectionThread();
+
+        try
+        {
+            MatchClan * clan = getClan(code);
+            if (clan->isDetectionAllowed())
+            {
+                vector<string> names;
+                clan->getMemberNames(names);
+
+                if ((detectionThread != NULL) && (! clan->isDetectionCached(names)))
+                    detectionThread->post(clan, clan->newDetectionRequest(), names);
+                else
+                {
+                    clan->detectClanName(false);
+                    propagateClanNameChanges(clan);
+                }
+            }
+        }
+        catch(const MatchManagerException & e)
+        {
+            CSSMATCH_PRINT_EXCEPTION(e);
+        }
+    }
+    else
+        throw MatchManagerException("No match in progress");
+}
+
+void MatchManager::applyClanNameDetection(MatchClan * clan, unsigned int request,
+                                          vector<string> & names, const string & tag)
+{
+    if ((currentState != initialState) && clan->setDetection(request, names, tag))
+        propagateClanNameChanges(clan);
+}
+
 void MatchManager::setClanName(TeamCode code, const string & newName)
 {
     // Update the clan's name
@@ -355,7 +422,7 @@ throw(MatchManagerException)
         lignup.clan2.reset();
 
         // Reset all player stats
-        list<ClanMember *> * playerlist = plugin->getPlayerlist();
+        const PlayerList * playerlist = plugin->getPlayerlist();
         for_each(playerlist->begin(), playerlist->end(), ResetClanMember());
 
         // Cancel any timers in progress
@@ -388,18 +455,41 @@ throw(MatchManagerException)
         // Save the current date
         infos.startTime = *getLocalTime();
 
-        // Start to listen some events
-        map<string, EventCallback>::iterator itEvent;
-        for(itEvent = eventCallbacks.begin(); itEvent != eventCallbacks.end(); itEvent++)
+        // Start the journal of the match events
+        if (plugin->getConVar("cssmatch_report")->GetBool())
         {
-            interfaces->gameeventmanager2->AddListener(this, itEvent->first.c_str(), true);
+            char formatDate[20];
+            strftime(formatDate, sizeof(formatDate), "%Y-%m-%d_%Hh%M", &infos.startTime);
+
+            ostringstream journalPath;
+            journalPath << REPORTS_PATH << '/' << formatDate << '_' <<
+            interfaces->gpGlobals->mapname.ToCStr() << JOURNAL_EXTENSION;
+
+            try
+            {
+                journal.open(journalPath.str());
+
+                PlayerList::const_iterator itPlayer;
+                for(itPlayer = playerlist->begin(); itPlayer != playerlist->end(); itPlayer++)
+                {
+                    PlayerIdentity * identity = (*itPlayer)->getIdentity();
+                    journal.logPlayer(identity->userid, identity->steamid);
+                }
+            }
+            catch(const MatchJournalException & e)
+            {
+                CSSMATCH_PRINT_EXCEPTION(e);
+            }
         }
 
+        // Start to listen some events
+        eventCallbacks.listen(interfaces->gameeventmanager2, this);
+
         // Monitor some variable
         plugin->addTimer(new ConVarMonitorTimer(1.0f, plugin->getConVar("sv_alltalk"), "0",
-                                                "sv_alltalk"));
+                                                SV_ALLTALK));
         plugin->addTimer(new ConVarMonitorTimer(1.0f, plugin->getConVar("sv_cheats"), "0",
-                                                "sv_cheats"));
+                                                SV_CHEATS));
 
         // Set the new server password
         string password;
@@ -420,7 +510,7 @@ throw(MatchManagerException)
 
         map<string, string> parameters;
         parameters["$password"] = password;
-        plugin->addTimer(new TimerI18nPopupSay(5.0f, recipients, "match_password_popup", 5,
+        plugin->addTimer(new TimerI18nPopupSay(5.0f, recipients, MATCH_PASSWORD_POPUP, 5,
                                                parameters));
 
         // Maybe no warmup is needed
@@ -449,7 +539,7 @@ void MatchManager::stop() throw (MatchManagerException)
         RecipientFilter recipients;
         recipients.addAllPlayers();
 
-        i18n->i18nChatSay(recipients, "match_end");
+        i18n->i18nChatSay(recipients, MATCH_END);
 
         const string * tagClan1 = lignup.clan1.getName();
         ClanStats * clan1Stats = lignup.clan1.getStats();
@@ -463,30 +553,44 @@ void MatchManager::stop() throw (MatchManagerException)
         parameters["$score1"] = toString(clan1Score);
         parameters["$team2"] = *tagClan2;
         parameters["$score2"] = toString(clan2Score);
-        i18n->i18nPopupSay(recipients, "match_end_popup", 6, parameters);
+        i18n->i18nPopupSay(recipients, MATCH_END_POPUP, 6, parameters);
         //i18n->i18nConsoleSay(recipients,"match_end_popup",parameters);
 
         map<string, string> parametersWinner;
         if (clan1Score > clan2Score)
         {
             parametersWinner["$team"] = *tagClan1;
-            i18n->i18nChatSay(recipients, "match_winner", parametersWinner);
+            i18n->i18nChatSay(recipients, MATCH_WINNER, parametersWinner);
         }
         else if (clan1Score < clan2Score)
         {
             parametersWinner["$team"] = *tagClan2;
-            i18n->i18nChatSay(recipients, "match_winner", parametersWinner);
+            i18n->i18nChatSay(recipients, MATCH_WINNER, parametersWinner);
         }
         else
         {
-            i18n->i18nChatSay(recipients, "match_no_winner");
+            i18n->i18nChatSay(recipients, MATCH_NO_WINNER);
         }
 
         // Write the report
         if (plugin->getConVar("cssmatch_report")->GetBool())
         {
-            XmlReport report(this);
-            report.write();
+            // Captured now, written in background
+            ReportWriter * reportThread = plugin->getReportThread();
+            if (reportThread != NULL)
+                reportThread->post(new XmlReport(this));
+            else
+            {
+                XmlReport report(this);
+                try
+                {
+                    report.write();
+                }
+                catch(const ReportException & e)
+                {
+                    CSSMATCH_PRINT_EXCEPTION(e);
+                }
+            }
         }
 
         // Return to the initial state / context
@@ -502,7 +606,7 @@ void MatchManager::stop() throw (MatchManagerException)
                                                   // still count a while
                 map<string, string> timeoutParameters;
                 timeoutParameters["$time"] = toString(timeoutDuration);
-                plugin->addTimer(new TimerI18nChatSay(2.0f, recipients, "match_dead_time",
+                plugin->addTimer(new TimerI18nChatSay(2.0f, recipients, MATCH_DEAD_TIME,
                                                       timeoutParameters));
                 endCountdown.fire(timeoutDuration);
             }
@@ -530,6 +634,9 @@ void MatchManager::switchToInitialState()
     // Return to the initial state
     setMatchState(initialState);
 
+    // The journal is complete
+    journal.close();
+
     // Remove any old tv record
     for_each(records.begin(), records.end(), TvRecordToRemove());
     records.clear();
@@ -574,8 +681,8 @@ void MatchManager::sendStatus(RecipientFilter & recipients) const
            << "  Players:" << endl;
     i18n->consoleSay(recipients, status.str());
 
-    list<ClanMember *> * playerlist = plugin->getPlayerlist();
-    list<ClanMember *>::const_iterator itPlayer;
+    const PlayerList * playerlist = plugin->getPlayerlist();
+    PlayerList::const_iterator itPlayer;
     for (itPlayer = playerlist->begin(); itPlayer != playerlist->end(); itPlayer++)
     {
         status.str("");
@@ -609,8 +716,8 @@ void MatchManager::EndOfMatchCountdown::finish()
 
         map<string, string> parameters;
         parameters["$file"] = configPatch;
-        i18n->i18nChatWarning(recipients, "error_file_not_found", parameters);
-        i18n->i18nChatWarning(recipients, "match_please_changelevel");
+        i18n->i18nChatWarning(recipients, ERROR_FILE_NOT_FOUND, parameters);
+        i18n->i18nChatWarning(recipients, MATCH_PLEASE_CHANGELEVEL);
     }
 }
 
@@ -624,13 +731,13 @@ void ClanNameDetectionTimer::execute()
 {
     ServerPlugin * plugin = ServerPlugin::getInstance();
     MatchManager * manager = plugin->getMatch();
-    manager->detectClanName(team, false);
+    manager->requestClanNameDetection(team);
 }
 
 ConVarMonitorTimer::ConVarMonitorTimer( float delay,
                                         ConVar * varToWatch,
                                         const string & expectedValue,
-                                        const string & warningMessage)
+                                        const I18nKeyword & warningMessage)
     : BaseTimer(delay), toWatch(varToWatch), value(expectedValue), message(warningMessage)
 {
 }
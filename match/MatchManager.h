@@ -32,8 +32,11 @@
 #include "../exceptions/BaseException.h"
 #include "../messages/Countdown.h"
 #include "../messages/I18nManager.h"
+#include "../report/MatchJournal.h"
 #include "BaseMatchState.h"
 
+#include "EventDispatcher.h"
+
 #include "igameevents.h" // IGameEventListener2, IGameEvent
 
 #include <string>
@@ -103,10 +106,8 @@ namespace cssmatch
 
         EndOfMatchCountdown endCountdown;
 
-        typedef void (MatchManager::*EventCallback)(IGameEvent * event);
-
-        /** {event => callback} map used in FireGameEvent */
-        std::map<std::string, EventCallback> eventCallbacks;
+        /** {event => callback} table used in FireGameEvent */
+        EventDispatcher<MatchManager> eventCallbacks;
 
         /** hostname value when the match was launched */
         std::string hostnameTemplate;
@@ -126,6 +127,9 @@ namespace cssmatch
         /** SourceTv record list */
         std::list<TvRecord *> records;
 
+        /** Journal of the match events */
+        MatchJournal journal;
+
         /** Update "hostname" according to the clan names */
         void updateHostname();
 
@@ -153,6 +157,9 @@ namespace cssmatch
         /** Get the record list */
         std::list<TvRecord *> * getRecords();
 
+        /** Get the journal of the match events (not open if the journal could not be created) */
+        MatchJournal * getJournal();
+
         /** Get the initial/default match state (when no match is running) */
         BaseMatchState * getInitialState() const;
 
@@ -176,6 +183,21 @@ namespace cssmatch
          */
         void detectClanName(TeamCode code, bool force) throw(MatchManagerException);
 
+        /** Redetect a clan name on the clan detection thread <br>
+         * The detection is done immediately if the result is already known or if there is no
+         * detection thread
+         * @param code The clan's team code
+         * @throws MatchManagerException if no match is running
+         */
+        void requestClanNameDetection(TeamCode code) throw(MatchManagerException);
+
+        /** Apply a clan name detected by the clan detection thread <br>
+         * Outdated results are discarded
+         * @see MatchClan::setDetection
+         */
+        void applyClanNameDetection(MatchClan * clan, unsigned int request,
+                                    std::vector<std::string> & names, const std::string & tag);
+
         /** Update things (e.g.: hostname) with the last name of a clan
          * @param code The clan's team code
          * @param newName New name for the clan
@@ -254,7 +276,7 @@ namespace cssmatch
         std::string value;
 
         /** Message to send if the ConVar value is different from the expected value */
-        std::string message;
+        I18nKeyword message;
     public:
         /**
          * @param delay Time before starting
@@ -266,7 +288,7 @@ namespace cssmatch
         ConVarMonitorTimer( float delay,
                             ConVar * varToWatch,
                             const std::string & expectedValue,
-                            const std::string & warningMessage);
+                            const I18nKeyword & warningMessage);
 
         /** @see BaseTimer */
         void execute();
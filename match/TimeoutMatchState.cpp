@@ -34,6 +34,11 @@ using namespace cssmatch;
 using std::string;
 using std::map;
 
+// Translation keywords
+static const I18nKeyword MATCH_NAME("match_name");
+static const I18nKeyword MENU_DISABLE("menu_disable");
+static const I18nKeyword MENU_ENABLE("menu_enable");
+
 TimeoutMatchState::TimeoutMatchState() : duration(0), nextState(NULL)
 {
     timeoutMenu = new Menu(NULL, "menu_time-out",
@@ -95,14 +100,12 @@ void TimeoutMatchState::restartState()
 void TimeoutMatchState::showMenu(Player * recipient)
 {
     ServerPlugin * plugin = ServerPlugin::getInstance();
-    ValveInterfaces * interfaces = plugin->getInterfaces();
     I18nManager * i18n = plugin->getI18nManager();
-    string language = interfaces->engine->GetClientConVarValue(
-        recipient->getIdentity()->index, "cl_language");
+    int language = recipient->getLanguageId();
     bool alltalk = plugin->getConVar("sv_alltalk")->GetBool();
 
     map<string, string> parameters;
-    parameters["$action"] = i18n->getTranslation(language, alltalk ? "menu_disable" : "menu_enable");
+    parameters["$action"] = i18n->getTranslation(language, alltalk ? MENU_DISABLE : MENU_ENABLE);
 
     if (plugin->getConVar("cssmatch_advanced")->GetBool())
         recipient->sendMenu(menuWithAdmin, 1, parameters);
@@ -142,7 +145,7 @@ void TimeoutMatchState::timeoutMenuCallback(Player * player, int choice, MenuLin
         map<string, string> parameters;
         parameters["$team1"] = *lignup->clan1.getName();
         parameters["$team2"] = *lignup->clan2.getName();
-        i18n->i18nChatSay(recipients, "match_name", parameters);
+        i18n->i18nChatSay(recipients, MATCH_NAME, parameters);
 
         player->quitMenu();
     }
@@ -28,6 +28,7 @@
 
 #include "../plugin/ServerPlugin.h"
 #include "../player/ClanMember.h"
+#include "../entity/EntityRemover.h"
 #include "../messages/I18nManager.h"
 #include "MatchManager.h"
 #include "DisabledMatchState.h"
@@ -39,7 +40,20 @@ using std::string;
 using std::list;
 using std::map;
 
-WarmupMatchState::WarmupMatchState() : finished(false)
+// Translation keywords
+static const I18nKeyword ADMIN_ALL_TEAMS_SAY_READY("admin_all_teams_say_ready");
+static const I18nKeyword ADMIN_ALL_TEAMS_SAY_READY_BY("admin_all_teams_say_ready_by");
+static const I18nKeyword ADMIN_ROUND_RESTARTED("admin_round_restarted");
+static const I18nKeyword ADMIN_ROUND_RESTARTED_BY("admin_round_restarted_by");
+static const I18nKeyword MATCH_NAME("match_name");
+static const I18nKeyword MENU_DISABLE("menu_disable");
+static const I18nKeyword MENU_ENABLE("menu_enable");
+static const I18nKeyword WARMUP_ALL_READY("warmup_all_ready");
+static const I18nKeyword WARMUP_ALREADY_READY("warmup_already_ready");
+static const I18nKeyword WARMUP_ANNOUNCEMENT("warmup_announcement");
+static const I18nKeyword WARMUP_READY("warmup_ready");
+
+WarmupMatchState::WarmupMatchState() : eventCallbacks("WarmupMatchState"), finished(false)
 
 {
     warmupMenu = new Menu(NULL, "menu_warmup",
@@ -62,10 +76,10 @@ WarmupMatchState::WarmupMatchState() : finished(false)
     menuWithAdmin->addLine(true, "menu_retag");
     menuWithAdmin->addLine(true, "menu_go");
 
-    eventCallbacks["player_spawn"] = &WarmupMatchState::player_spawn;
-    eventCallbacks["round_start"] = &WarmupMatchState::round_start;
-    eventCallbacks["item_pickup"] = &WarmupMatchState::item_pickup;
-    //eventCallbacks["bomb_beginplant"] = &WarmupMatchState::bomb_beginplant;
+    eventCallbacks.addCallback("player_spawn", &WarmupMatchState::player_spawn);
+    eventCallbacks.addCallback("round_start", &WarmupMatchState::round_start);
+    eventCallbacks.addCallback("item_pickup", &WarmupMatchState::item_pickup);
+    //eventCallbacks.addCallback("bomb_beginplant", &WarmupMatchState::bomb_beginplant);
 }
 
 WarmupMatchState::~WarmupMatchState()
@@ -100,14 +114,9 @@ void WarmupMatchState::endWarmup()
     }
 }
 
-void WarmupMatchState::removeC4()
+void WarmupMatchState::removeC4(int userid)
 {
-    ServerPlugin * plugin = ServerPlugin::getInstance();
-    ConVar * sv_cheats = plugin->getConVar("sv_cheats");
-
-    sv_cheats->m_nValue = 1;
-    plugin->executeCommand("ent_remove weapon_c4\n");
-    sv_cheats->m_nValue = 0;
+    EntityRemover::getInstance()->removePlayerItem(userid, "weapon_c4", false);
 }
 
 void WarmupMatchState::doGo(Player * player)
@@ -132,7 +141,7 @@ void WarmupMatchState::doGo(Player * player)
         if (clan->isReady())
         {
             // Clan already "ready"
-            i18n->i18nChatSay(recipients, "warmup_already_ready", parameters,
+            i18n->i18nChatSay(recipients, WARMUP_ALREADY_READY, parameters,
                               player->getIdentity()->index);
         }
         else
@@ -142,13 +151,13 @@ void WarmupMatchState::doGo(Player * player)
             // If both clan1 and clan2 are ready, end the warmup
             if (otherClan->isReady())
             {
-                i18n->i18nChatSay(recipients, "warmup_all_ready");
+                i18n->i18nChatSay(recipients, WARMUP_ALL_READY);
                 endWarmup();
             }
             // Ohterwise just announce that this clan is ready
             else
             {
-                i18n->i18nChatSay(recipients, "warmup_ready", parameters,
+                i18n->i18nChatSay(recipients, WARMUP_READY, parameters,
                                   player->getIdentity()->index);
             }
         }
@@ -174,11 +183,7 @@ void WarmupMatchState::startState()
     plugin->queueCommand("mp_restartgame 2\n");
 
     // Subscribe to the needed game events
-    map<string, EventCallback>::iterator itEvent;
-    for(itEvent = eventCallbacks.begin(); itEvent != eventCallbacks.end(); itEvent++)
-    {
-        interfaces->gameeventmanager2->AddListener(this, itEvent->first.c_str(), true);
-    }
+    eventCallbacks.listen(interfaces->gameeventmanager2, this);
 
     match->getInfos()->roundNumber = 1;
 }
@@ -206,14 +211,12 @@ void WarmupMatchState::restartState()
 void WarmupMatchState::showMenu(Player * recipient)
 {
     ServerPlugin * plugin = ServerPlugin::getInstance();
-    ValveInterfaces * interfaces = plugin->getInterfaces();
     I18nManager * i18n = plugin->getI18nManager();
-    string language = interfaces->engine->GetClientConVarValue(
-        recipient->getIdentity()->index, "cl_language");
+    int language = recipient->getLanguageId();
     bool alltalk = plugin->getConVar("sv_alltalk")->GetBool();
 
     map<string, string> parameters;
-    parameters["$action"] = i18n->getTranslation(language, alltalk ? "menu_disable" : "menu_enable");
+    parameters["$action"] = i18n->getTranslation(language, alltalk ? MENU_DISABLE : MENU_ENABLE);
 
     if (plugin->getConVar("cssmatch_advanced")->GetBool())
         recipient->sendMenu(menuWithAdmin, 1, parameters);
@@ -250,10 +253,10 @@ void WarmupMatchState::warmupMenuCallback(Player * player, int choice, MenuLine
         if (isValidPlayerInfo(pInfo))
         {
             parameters["$admin"] = pInfo->GetName();
-            i18n->i18nChatSay(recipients, "admin_round_restarted_by", parameters, identity->index);
+            i18n->i18nChatSay(recipients, ADMIN_ROUND_RESTARTED_BY, parameters, identity->index);
         }
         else
-            i18n->i18nChatSay(recipients, "admin_round_restarted");
+            i18n->i18nChatSay(recipients, ADMIN_ROUND_RESTARTED);
 
         match->restartRound();
     }
@@ -274,7 +277,7 @@ void WarmupMatchState::warmupMenuCallback(Player * player, int choice, MenuLine
         map<string, string> parameters;
         parameters["$team1"] = *lignup->clan1.getName();
         parameters["$team2"] = *lignup->clan2.getName();
-        i18n->i18nChatSay(recipients, "match_name", parameters);
+        i18n->i18nChatSay(recipients, MATCH_NAME, parameters);
 
         player->quitMenu();
     }
@@ -290,11 +293,11 @@ void WarmupMatchState::warmupMenuCallback(Player * player, int choice, MenuLine
         if (isValidPlayerInfo(pInfo))
         {
             parameters["$admin"] = pInfo->GetName();
-            i18n->i18nChatSay(recipients, "admin_all_teams_say_ready_by", parameters,
+            i18n->i18nChatSay(recipients, ADMIN_ALL_TEAMS_SAY_READY_BY, parameters,
                               identity->index);
         }
         else
-            i18n->i18nChatSay(recipients, "admin_all_teams_say_ready");
+            i18n->i18nChatSay(recipients, ADMIN_ALL_TEAMS_SAY_READY);
 
         endWarmup();
     }
@@ -321,7 +324,7 @@ void WarmupMatchState::FireGameEvent(IGameEvent * event)
 {
     try
     {
-        (this->*eventCallbacks[event->GetName()])(event);
+        eventCallbacks.dispatch(this, event);
     }
     catch(const BaseException & e)
     {
@@ -375,7 +378,7 @@ void WarmupMatchState::round_start(IGameEvent * event)
         break;
     default:*/
     recipients.addAllPlayers();
-    i18n->i18nChatSay(recipients, "warmup_announcement");
+    i18n->i18nChatSay(recipients, WARMUP_ANNOUNCEMENT);
     /*	break;
     }*/
 }
@@ -391,7 +394,7 @@ void WarmupMatchState::item_pickup(IGameEvent * event)
 
     if (item == "c4")
     {
-        removeC4();
+        removeC4(event->GetInt("userid"));
     }
 }
 
@@ -32,6 +32,8 @@
 #include "../messages/Menu.h"
 #include "../messages/Countdown.h"
 
+#include "EventDispatcher.h"
+
 #include "igameevents.h" // IGameEventListener2, IGameEvent
 
 #include <map>
@@ -64,10 +66,8 @@ namespace cssmatch
 
         WarmupCountdown countdown;
 
-        typedef void (WarmupMatchState::*EventCallback)(IGameEvent * event);
-
-        /** {event => callback} map used in FireGameEvent */
-        std::map<std::string, EventCallback> eventCallbacks;
+        /** {event => callback} table used in FireGameEvent */
+        EventDispatcher<WarmupMatchState> eventCallbacks;
 
         /** Menus for this state*/
         Menu * warmupMenu;
@@ -76,8 +76,10 @@ namespace cssmatch
         /** Does this state finished ? */
         bool finished;
 
-        /** Remove the C4 */
-        void removeC4();
+        /** Remove the C4
+         * @param userid The userid of the player who owns the C4
+         */
+        void removeC4(int userid);
 
         friend class BaseSingleton<WarmupMatchState>;
         WarmupMatchState();
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "I18nKeyword.h"
+
+using namespace cssmatch;
+
+using std::string;
+using std::vector;
+using std::map;
+
+map<string, int> & I18nKeyword::getIds()
+{
+    static map<string, int> ids;
+    return ids;
+}
+
+vector<string> & I18nKeyword::getNames()
+{
+    static vector<string> names;
+    return names;
+}
+
+int I18nKeyword::registerKeyword(const string & keyword)
+{
+    int keywordId;
+
+    map<string, int> & ids = getIds();
+    map<string, int>::iterator itId = ids.find(keyword);
+    if (itId == ids.end())
+    {
+        vector<string> & names = getNames();
+        keywordId = names.size();
+        names.push_back(keyword);
+        ids[keyword] = keywordId;
+    }
+    else
+        keywordId = itId->second;
+
+    return keywordId;
+}
+
+I18nKeyword::I18nKeyword(const char * keyword) : id(registerKeyword(keyword))
+{
+}
+
+I18nKeyword::I18nKeyword(const string & keyword) : id(registerKeyword(keyword))
+{
+}
+
+int I18nKeyword::getId() const
+{
+    return id;
+}
+
+const string & I18nKeyword::getName() const
+{
+    return getNames()[id];
+}
+
+int I18nKeyword::getCount()
+{
+    return getNames().size();
+}
+
+const string & I18nKeyword::getName(int keywordId)
+{
+    return getNames()[keywordId];
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __I18N_KEYWORD_H__
+#define __I18N_KEYWORD_H__
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace cssmatch
+{
+    /** Translation keyword, interned into a small integer id <br>
+     * The ids are shared by all the languages, so the translations of a keyword are found by
+     * array indexing. The keywords are registered once, as static constants, e.g.: <br>
+     * <code>static const I18nKeyword MATCH_GO("match_go");</code> <br>
+     * A keyword only known at runtime (e.g. a menu line) must be constructed explicitly, it's
+     * then searched by name.
+     */
+    class I18nKeyword
+    {
+    private:
+        /** Keyword id */
+        int id;
+
+        /** {keyword => id} (constructed on first use, the keywords can be static objects) */
+        static std::map<std::string, int> & getIds();
+
+        /** {id => keyword} */
+        static std::vector<std::string> & getNames();
+
+        /** Get the id of a keyword, register the keyword if it's not already done */
+        static int registerKeyword(const std::string & keyword);
+    public:
+        /**
+         * @param keyword The keyword (from the translation files)
+         */
+        explicit I18nKeyword(const char * keyword);
+
+        /**
+         * @param keyword The keyword (from the translation files)
+         */
+        explicit I18nKeyword(const std::string & keyword);
+
+        /** Get the keyword id */
+        int getId() const;
+
+        /** Get the keyword itself */
+        const std::string & getName() const;
+
+        /** Get the number of keywords registered (the ids go from 0 to this count - 1) */
+        static int getCount();
+
+        /** Get a keyword from its id
+         * @param id The keyword id
+         * @return The keyword
+         */
+        static const std::string & getName(int id);
+    };
+}
+
+#endif // __I18N_KEYWORD_H__
@@ -27,8 +27,12 @@
 #include "I18nManager.h"
 
 #include "../configuration/TranslationFile.h"
+#include "../configuration/TranslationBundle.h"
 #include "../misc/common.h"
 #include "../plugin/ServerPlugin.h"
+#include "../plugin/Profiler.h"
+#include "../player/ClanMember.h"
+#include "../threading/ThreadPool.h"
 
 #include "../convars/convar.h"
 #include "eiface.h"
@@ -36,6 +40,7 @@
 #include <vector>
 
 using namespace cssmatch;
+using namespace threading;
 
 using std::string;
 using std::map;
@@ -43,33 +48,426 @@ using std::vector;
 
 map<string, string> I18nManager::WITHOUT_PARAMETERS;
 
+/** Index of a language/keyword not searched in the bundle yet */
+static const int UNRESOLVED_INDEX = -2;
+
 void I18nManager::updateMessageCache(   int recipientIndex,
-                                        const std::string & language,
-                                        const std::string & keyword,
+                                        int languageId,
+                                        const I18nKeyword & keyword,
                                         const std::map<std::string, std::string> & parameters)
 {
-    // Is the message already in the cache?
-    map<string, I18nMessage>::iterator itCache = messageCache.find(language);
-    if (itCache == messageCache.end())
+    if (languageId >= (int)messageCache.size())
+        messageCache.resize(languageNames.size());
+    I18nMessage & cached = messageCache[languageId];
+
+    // Is the message already rendered for this language?
+    if (! cached.rendered)
+    {
+        // No, render it once (the string keeps its capacity between the broadcasts)
+        cached.message.clear();
+        renderTranslation(languageId, keyword, parameters, cached.message);
+        cached.rendered = true;
+    }
+
+    cached.recipients.addRecipient(recipientIndex);
+}
+
+void I18nManager::prepareMessageCache(  RecipientFilter & recipients,
+                                        const I18nKeyword & keyword,
+                                        const map<string, string> & parameters)
+{
+    // A new message invalidates the rendered messages
+    if ((keyword.getId() != cachedKeyword) || (parameters != cachedParameters))
+    {
+        invalidateMessageCache();
+        cachedKeyword = keyword.getId();
+        cachedParameters = parameters;
+    }
+
+    const vector<int> * recipientVector = recipients.getVector();
+    vector<int>::const_iterator itIndex;
+    for(itIndex = recipientVector->begin(); itIndex != recipientVector->end(); itIndex++)
+    {
+        updateMessageCache(*itIndex, getClientLanguageId(*itIndex), keyword, parameters);
+    }
+}
+
+int I18nManager::getBundleLanguage(int languageId)
+{
+    if (languageId >= (int)bundleLanguages.size())
+        bundleLanguages.resize(languageNames.size(), UNRESOLVED_INDEX);
+
+    int & index = bundleLanguages[languageId];
+    if (index == UNRESOLVED_INDEX)
+        index = bundle->findLanguage(languageNames[languageId]);
+
+    return index;
+}
+
+int I18nManager::getBundleKeyword(const I18nKeyword & keyword)
+{
+    int keywordId = keyword.getId();
+    if (keywordId >= (int)bundleKeywords.size())
+        bundleKeywords.resize(I18nKeyword::getCount(), UNRESOLVED_INDEX);
+
+    int & index = bundleKeywords[keywordId];
+    if (index == UNRESOLVED_INDEX)
+    {
+        index = bundle->findKeyword(keyword.getName());
+#ifdef _DEBUG
+        // e.g. a keyword only known at runtime, registered after checkTranslations
+        if (index == -1)
+            CSSMATCH_PRINT("No translation for " + keyword.getName() + " in any language");
+#endif // _DEBUG
+    }
+
+    return index;
+}
+
+#ifdef _DEBUG
+void I18nManager::checkTranslations()
+{
+    // Each keyword of a translation file must be in every translation file
+    int keywordCount = bundle->getKeywordCount();
+    int languageCount = bundle->getLanguageCount();
+    for(int iKeyword = 0; iKeyword < keywordCount; iKeyword++)
     {
-        // No, construct/cache it
+        for(int iLanguage = 0; iLanguage < languageCount; iLanguage++)
+        {
+            if (bundle->isValid(iLanguage) && (! bundle->hasTranslation(iLanguage, iKeyword)))
+            {
+                CSSMATCH_PRINT("No translation for " + bundle->getKeywordName(iKeyword) + " in "
+                               + bundle->getLanguageName(iLanguage) + ".txt");
+            }
+        }
+    }
+
+    // Each keyword used by the plugin must be in the translation files
+    for(int keywordId = 0; keywordId < I18nKeyword::getCount(); keywordId++)
+    {
+        const string & keyword = I18nKeyword::getName(keywordId);
+        if (bundle->findKeyword(keyword) == -1)
+            CSSMATCH_PRINT("No translation for " + keyword + " in any language");
+    }
+}
+#endif // _DEBUG
+
+void I18nManager::renderTranslation(int languageId,
+                                    const I18nKeyword & keyword,
+                                    const map<string, string> & parameters,
+                                    string & buffer)
+{
+    // The bundle contains all the valid translation files
+    int bundleLanguage = -1;
+    if (bundle != NULL)
+    {
+        bundleLanguage = getBundleLanguage(languageId);
+        if ((bundleLanguage == -1) && (defaultLanguage != NULL))
+            bundleLanguage = getBundleLanguage(getLanguageId(defaultLanguage->GetString()));
+    }
+
+    if (bundleLanguage != -1)
+    {
+        int bundleKeyword = getBundleKeyword(keyword);
+        if ((bundleKeyword == -1) || (! bundle->render(bundleLanguage, bundleKeyword, parameters,
+                                                       buffer)))
+            buffer = "Missing translation, please update your translation files";
+    }
+    else
+    {
+        // Until the translations are loaded by the worker thread, only the default language is
+        // parsed here
+        string fileLanguage = languageNames[languageId];
+        if ((pendingLoad != NULL) && (defaultLanguage != NULL))
+            fileLanguage = defaultLanguage->GetString();
+
+        // We have to get the translations corresponding to this language
+        TranslationFile * translation = getTranslationFile(fileLanguage);
+
+        if (translation != NULL)
+        {
+            try
+            {
+                translation->getCompiled(keyword.getName()).render(parameters, buffer);
+            }
+            catch(const TranslationException & e)
+            {
+                //CSSMATCH_PRINT_EXCEPTION(e);
+                buffer = "Missing translation, please update your translation files";
+            }
+        }
+        else
+        {
+            buffer = "Missing default translation file, please update cssmatch_language";
+        }
+    }
+}
+
+int I18nManager::getLanguageId(const string & language)
+{
+    int languageId;
 
-        messageCache[language].message = getTranslation(language, keyword, parameters);
-        messageCache[language].recipients.addRecipient(recipientIndex);
+    map<string, int>::iterator itId = languageIds.find(language);
+    if (itId != languageIds.end())
+        languageId = itId->second;
+    else if (languageNames.size() < I18N_MAX_LANGUAGES)
+    {
+        languageId = languageNames.size();
+        languageNames.push_back(language);
+        languageIds[language] = languageId;
     }
     else
     {
-        // Yes, just add the new recipient to the recipient list
+        // The table is full (e.g. a client cycling their cl_language), use the default language
+        // The first default language is registered by setDefaultLanguage
+        languageId = 0;
+        if (defaultLanguage != NULL)
+        {
+            itId = languageIds.find(defaultLanguage->GetString());
+            if (itId != languageIds.end())
+                languageId = itId->second;
+        }
+    }
+
+    return languageId;
+}
+
+const string & I18nManager::getLanguageName(int languageId) const
+{
+    return languageNames[languageId];
+}
+
+int I18nManager::getClientLanguageId(int index)
+{
+    int languageId;
+
+    ClanMember * player = NULL;
+    if (ServerPlugin::getInstance()->getPlayer(PlayerHavingIndex(index), player))
+        languageId = player->getLanguageId();
+    else
+        languageId = getLanguageId(engine->GetClientConVarValue(index, "cl_language"));
+
+    return languageId;
+}
+
+void I18nManager::invalidateMessageCache()
+{
+    vector<I18nMessage>::iterator itMessage;
+    for(itMessage = messageCache.begin(); itMessage != messageCache.end(); itMessage++)
+    {
+        itMessage->rendered = false;
+    }
+}
+
+unsigned int I18nManager::getTranslationsVersion() const
+{
+    return translationsVersion;
+}
+
+/** Get the bundle corresponding to the current translation files (any thread) <br>
+ * If the existing bundle is not up to date, a new one is compiled at TRANSLATIONS_BUNDLE_TEMP_PATH
+ * @param recompile If <code>true</code>, compile the bundle even if it is up to date
+ * @param compiled Set to <code>true</code> if a new bundle was compiled
+ * @return The existing bundle if it is up to date, NULL otherwise
+ */
+static TranslationBundle * prepareBundle(bool recompile, bool & compiled)
+{
+    vector<string> languageNames;
+    TranslationBundle::listLanguages(TRANSLATIONS_FOLDER, languageNames);
+
+    TranslationBundle * loaded = new TranslationBundle();
+    if (recompile || (! loaded->open(TRANSLATIONS_BUNDLE_PATH)) ||
+        (! loaded->isUpToDate(TRANSLATIONS_FOLDER, languageNames)))
+    {
+        delete loaded;
+        loaded = NULL;
 
-        itCache->second.recipients.addRecipient(recipientIndex);
+        // The bundle is written aside, so the one in use stays valid if the compilation fails
+        try
+        {
+            TranslationBundle::compile(TRANSLATIONS_FOLDER, languageNames,
+                                       TRANSLATIONS_BUNDLE_TEMP_PATH);
+            compiled = true;
+        }
+        catch(const ConfigurationFileException & e)
+        {
+            CSSMATCH_PRINT_EXCEPTION(e);
+        }
     }
+
+    return loaded;
 }
 
-I18nManager::I18nManager() : defaultLanguage(NULL)
+namespace cssmatch
+{
+    /** Prepare the translation bundle on a worker thread (see prepareBundle) */
+    class TranslationLoadTask : public Task
+    {
+    public:
+        /** The existing bundle, if up to date */
+        TranslationBundle * loaded;
+
+        /** Was a new bundle compiled? */
+        bool compiled;
+
+        TranslationLoadTask() throw(ThreadException) : loaded(NULL), compiled(false)
+        {}
+
+        ~TranslationLoadTask()
+        {
+            delete loaded;
+        }
+
+        void run()
+        {
+            loaded = prepareBundle(false, compiled);
+        }
+    };
+}
+
+bool I18nManager::useBundle(TranslationBundle * loaded, bool compiled)
+{
+    if ((loaded == NULL) && compiled)
+    {
+#ifdef _WIN32
+        // A mapped file cannot be replaced, unmap the bundle in use meanwhile
+        if (bundle != NULL)
+            bundle->close();
+#endif // _WIN32
+        if (TranslationBundle::replace(TRANSLATIONS_BUNDLE_TEMP_PATH, TRANSLATIONS_BUNDLE_PATH))
+        {
+            loaded = new TranslationBundle();
+            if (! loaded->open(TRANSLATIONS_BUNDLE_PATH))
+            {
+                delete loaded;
+                loaded = NULL;
+            }
+        }
+        else
+            CSSMATCH_PRINT("Unable to replace " TRANSLATIONS_BUNDLE_PATH);
+#ifdef _WIN32
+        // Map the bundle in use again if it was kept
+        if ((loaded == NULL) && (bundle != NULL) && (! bundle->open(TRANSLATIONS_BUNDLE_PATH)))
+        {
+            delete bundle;
+            bundle = NULL;
+        }
+#endif // _WIN32
+    }
+
+    if (loaded != NULL)
+    {
+        delete bundle;
+        bundle = loaded;
+
+        // The translation files will be parsed again if they are still needed
+        map<string, TranslationFile *>::iterator itLanguage;
+        for(itLanguage = languages.begin(); itLanguage != languages.end(); itLanguage++)
+        {
+            delete itLanguage->second;
+        }
+        languages.clear();
+    }
+
+    // The cached messages were rendered from the previous translations
+    invalidateMessageCache();
+    translationsVersion++;
+
+    // The indexes are specific to each bundle
+    bundleLanguages.clear();
+    bundleKeywords.clear();
+#ifdef _DEBUG
+    if (bundle != NULL)
+        checkTranslations();
+#endif // _DEBUG
+
+    return loaded != NULL;
+}
+
+void I18nManager::waitPendingLoad()
+{
+    if (pendingLoad != NULL)
+    {
+        try
+        {
+            while(! pendingLoad->isDone())
+                pendingLoad->waitDone(THREAD_POOL_IDLE_WAIT);
+        }
+        catch(const ThreadException & e)
+        {
+            CSSMATCH_PRINT(e.getMessage());
+        }
+        publishTranslations();
+    }
+}
+
+bool I18nManager::loadTranslations(bool recompile)
+{
+    // Only one thread at a time can compile the bundle
+    waitPendingLoad();
+
+    bool compiled = false;
+    TranslationBundle * loaded = prepareBundle(recompile, compiled);
+    return useBundle(loaded, compiled);
+}
+
+void I18nManager::preloadTranslations()
+{
+    if (pendingLoad == NULL)
+    {
+        ThreadPool * pool = ServerPlugin::getInstance()->getWorkerPool();
+
+        bool submitted = false;
+        if (pool != NULL)
+        {
+            try
+            {
+                pendingLoad = new TranslationLoadTask();
+                submitted = pool->submit(pendingLoad);
+            }
+            catch(const ThreadException & e)
+            {
+                CSSMATCH_PRINT(e.getMessage());
+            }
+
+            if (! submitted)
+            {
+                delete pendingLoad;
+                pendingLoad = NULL;
+            }
+        }
+
+        if (! submitted)
+            loadTranslations(false);
+    }
+    // Else the files will be checked by the pending load
+}
+
+void I18nManager::publishTranslations()
+{
+    if ((pendingLoad != NULL) && pendingLoad->isDone())
+    {
+        useBundle(pendingLoad->loaded, pendingLoad->compiled);
+        pendingLoad->loaded = NULL;
+
+        delete pendingLoad;
+        pendingLoad = NULL;
+    }
+}
+
+I18nManager::I18nManager()
+    : defaultLanguage(NULL), bundle(NULL), pendingLoad(NULL), translationsVersion(0),
+      cachedKeyword(-1)
 {}
 
 I18nManager::~I18nManager()
 {
+    // The worker threads are stopped, the load is complete if it ever started
+    if ((pendingLoad != NULL) && pendingLoad->isDone())
+        delete pendingLoad;
+
+    delete bundle;
+
     map<string, TranslationFile *>::iterator itLanguage;
     for(itLanguage = languages.begin(); itLanguage != languages.end(); itLanguage++)
     {
@@ -80,6 +478,10 @@ I18nManager::~I18nManager()
 void I18nManager::setDefaultLanguage(ConVar * language)
 {
     defaultLanguage = language;
+
+    // Make sure the default language has an id, even if the language table gets full
+    if (language != NULL)
+        getLanguageId(language->GetString());
 }
 
 string I18nManager::getDefaultLanguage() const
@@ -143,188 +545,147 @@ TranslationFile * I18nManager::getTranslationFile(const string & language)
 }
 
 string I18nManager::getTranslation( const string & lang,
-                                    const string & keyword,
+                                    const I18nKeyword & keyword,
                                     const map<string, string> & parameters)
 {
-    string message;
-
-    // We have to get the translations corresponding to this language
-    TranslationFile * translation = getTranslationFile(lang);
-
-    if (translation != NULL)
-    {
-        try
-        {
-            message = (*translation)[keyword]; // copying it, because we will replace the parameters
+    return getTranslation(getLanguageId(lang), keyword, parameters);
+}
 
-            // Relace the parameters
-            // FIXME: unnecessarily called as many times as recipients
-            //	Make a lang cache system in the I18nManager methods ?
-            map<string, string>::const_iterator itParameters;
-            for(itParameters = parameters.begin(); itParameters != parameters.end(); itParameters++)
-            {
-                const string * parameter = &itParameters->first;
-                size_t parameterSize = parameter->size();
-                const string * value = &itParameters->second;
-                size_t valueSize = value->size();
-
-                // One option can be found multiple times
-                size_t iParam = message.find(*parameter);
-                while(iParam != string::npos)
-                {
-                    message.replace(iParam, parameterSize, *value, 0, valueSize);
-                    iParam = message.find(*parameter);
-                }
-            }
-        }
-        catch(const TranslationException & e)
-        {
-            //CSSMATCH_PRINT_EXCEPTION(e);
-            message = "Missing translation, please update your translation files";
-        }
-    }
-    else
-    {
-        message = "Missing default translation file, please update cssmatch_language";
-    }
+string I18nManager::getTranslation( int languageId,
+                                    const I18nKeyword & keyword,
+                                    const map<string, string> & parameters)
+{
+    renderBuffer.clear();
+    renderTranslation(languageId, keyword, parameters, renderBuffer);
 
-    return message;
+    return renderBuffer;
 }
 
 void I18nManager::i18nChatSay(  RecipientFilter & recipients,
-                                const string & keyword,
+                                const I18nKeyword & keyword,
                                 const map<string, string> & parameters,
                                 int playerIndex)
 {
-    const vector<int> * recipientVector = recipients.getVector();
-    vector<int>::const_iterator itIndex;
-    for(itIndex = recipientVector->begin(); itIndex != recipientVector->end(); itIndex++)
-    {
-        string language = engine->GetClientConVarValue(*itIndex, "cl_language");
-        updateMessageCache(*itIndex, language, keyword, parameters);
-    }
+    CSSMATCH_PROFILE("I18nManager::i18nChatSay")
+    prepareMessageCache(recipients, keyword, parameters);
 
-    map<string, I18nMessage>::iterator itMessage;
+    vector<I18nMessage>::iterator itMessage;
     for(itMessage = messageCache.begin(); itMessage != messageCache.end(); itMessage++)
     {
-        chatSay(itMessage->second.recipients, itMessage->second.message, playerIndex);
+        if (itMessage->recipients.GetRecipientCount() > 0)
+        {
+            chatSay(itMessage->recipients, itMessage->message, playerIndex);
+            itMessage->recipients.removeAllRecipients();
+        }
     }
-    messageCache.clear();
 }
 
 void I18nManager::i18nChatWarning(  RecipientFilter & recipients,
-                                    const string & keyword,
+                                    const I18nKeyword & keyword,
                                     const map<string, string> & parameters)
 {
-    const vector<int> * recipientVector = recipients.getVector();
-    vector<int>::const_iterator itIndex;
-    for(itIndex = recipientVector->begin(); itIndex != recipientVector->end(); itIndex++)
-    {
-        string language = engine->GetClientConVarValue(*itIndex, "cl_language");
-        updateMessageCache(*itIndex, language, keyword, parameters);
-    }
+    CSSMATCH_PROFILE("I18nManager::i18nChatWarning")
+    prepareMessageCache(recipients, keyword, parameters);
 
-    map<string, I18nMessage>::iterator itMessage;
+    vector<I18nMessage>::iterator itMessage;
     for(itMessage = messageCache.begin(); itMessage != messageCache.end(); itMessage++)
     {
-        chatWarning(itMessage->second.recipients, itMessage->second.message);
+        if (itMessage->recipients.GetRecipientCount() > 0)
+        {
+            chatWarning(itMessage->recipients, itMessage->message);
+            itMessage->recipients.removeAllRecipients();
+        }
     }
-    messageCache.clear();
 }
 
 void I18nManager::i18nPopupSay( RecipientFilter & recipients,
-                                const std::string & keyword,
+                                const I18nKeyword & keyword,
                                 int lifeTime,
                                 const map<string, string> & parameters,
                                 int flags)
 {
-    const vector<int> * recipientVector = recipients.getVector();
-    vector<int>::const_iterator itIndex;
-    for(itIndex = recipientVector->begin(); itIndex != recipientVector->end(); itIndex++)
-    {
-        string language = engine->GetClientConVarValue(*itIndex, "cl_language");
-        updateMessageCache(*itIndex, language, keyword, parameters);
-    }
+    CSSMATCH_PROFILE("I18nManager::i18nPopupSay")
+    prepareMessageCache(recipients, keyword, parameters);
 
-    map<string, I18nMessage>::iterator itMessage;
+    vector<I18nMessage>::iterator itMessage;
     for(itMessage = messageCache.begin(); itMessage != messageCache.end(); itMessage++)
     {
-        popupSay(itMessage->second.recipients, itMessage->second.message, lifeTime, flags);
+        if (itMessage->recipients.GetRecipientCount() > 0)
+        {
+            popupSay(itMessage->recipients, itMessage->message, lifeTime, flags);
+            itMessage->recipients.removeAllRecipients();
+        }
     }
-    messageCache.clear();
 }
 
 void I18nManager::i18nHintSay(  RecipientFilter & recipients,
-                                const string & keyword,
+                                const I18nKeyword & keyword,
                                 const map<string, string> & parameters)
 {
-    const vector<int> * recipientVector = recipients.getVector();
-    vector<int>::const_iterator itIndex;
-    for(itIndex = recipientVector->begin(); itIndex != recipientVector->end(); itIndex++)
-    {
-        string language = engine->GetClientConVarValue(*itIndex, "cl_language");
-        updateMessageCache(*itIndex, language, keyword, parameters);
-    }
+    CSSMATCH_PROFILE("I18nManager::i18nHintSay")
+    prepareMessageCache(recipients, keyword, parameters);
 
-    map<string, I18nMessage>::iterator itMessage;
+    vector<I18nMessage>::iterator itMessage;
     for(itMessage = messageCache.begin(); itMessage != messageCache.end(); itMessage++)
     {
-        hintSay(itMessage->second.recipients, itMessage->second.message);
+        if (itMessage->recipients.GetRecipientCount() > 0)
+        {
+            hintSay(itMessage->recipients, itMessage->message);
+            itMessage->recipients.removeAllRecipients();
+        }
     }
-    messageCache.clear();
 }
 
 void I18nManager::i18nCenterSay(RecipientFilter & recipients,
-                                const string & keyword,
+                                const I18nKeyword & keyword,
                                 const map<string, string> & parameters)
 {
-    const vector<int> * recipientVector = recipients.getVector();
-    vector<int>::const_iterator itIndex;
-    for(itIndex = recipientVector->begin(); itIndex != recipientVector->end(); itIndex++)
-    {
-        string language = engine->GetClientConVarValue(*itIndex, "cl_language");
-        updateMessageCache(*itIndex, language, keyword, parameters);
-    }
+    CSSMATCH_PROFILE("I18nManager::i18nCenterSay")
+    prepareMessageCache(recipients, keyword, parameters);
 
-    map<string, I18nMessage>::iterator itMessage;
+    vector<I18nMessage>::iterator itMessage;
     for(itMessage = messageCache.begin(); itMessage != messageCache.end(); itMessage++)
     {
-        centerSay(itMessage->second.recipients, itMessage->second.message);
+        if (itMessage->recipients.GetRecipientCount() > 0)
+        {
+            centerSay(itMessage->recipients, itMessage->message);
+            itMessage->recipients.removeAllRecipients();
+        }
     }
-    messageCache.clear();
 }
 
 void I18nManager::i18nConsoleSay(   RecipientFilter & recipients,
-                                    const string & keyword,
+                                    const I18nKeyword & keyword,
                                     const map<string, string> & parameters)
 {
-    const vector<int> * recipientVector = recipients.getVector();
-    vector<int>::const_iterator itIndex;
-    for(itIndex = recipientVector->begin(); itIndex != recipientVector->end(); itIndex++)
-    {
-        string language = engine->GetClientConVarValue(*itIndex, "cl_language");
-        updateMessageCache(*itIndex, language, keyword, parameters);
-    }
+    CSSMATCH_PROFILE("I18nManager::i18nConsoleSay")
+    prepareMessageCache(recipients, keyword, parameters);
 
-    map<string, I18nMessage>::iterator itMessage;
+    vector<I18nMessage>::iterator itMessage;
     for(itMessage = messageCache.begin(); itMessage != messageCache.end(); itMessage++)
     {
-        consoleSay(itMessage->second.recipients, itMessage->second.message);
+        if (itMessage->recipients.GetRecipientCount() > 0)
+        {
+            consoleSay(itMessage->recipients, itMessage->message);
+            itMessage->recipients.removeAllRecipients();
+        }
     }
-    messageCache.clear();
 }
 
-void I18nManager::i18nMsg(const string & keyword, const map<string, string> & parameters)
+void I18nManager::i18nMsg(const I18nKeyword & keyword, const map<string, string> & parameters)
 {
-    string message = getTranslation(defaultLanguage->GetString(), keyword, parameters);
-    Msg("%s\n", message.c_str());
+    CSSMATCH_PROFILE("I18nManager::i18nMsg")
+    renderBuffer.clear();
+    renderTranslation(getLanguageId(defaultLanguage->GetString()), keyword, parameters,
+                      renderBuffer);
+    Msg("%s\n", renderBuffer.c_str());
 
     // FIXME: uses the default language
 }
 
 TimerI18nChatSay::TimerI18nChatSay( float delay,
                                     RecipientFilter & recip,
-                                    const string & key,
+                                    const I18nKeyword & key,
                                     const map<string, string> & param,
                                     int pIndex)
     : BaseTimer(delay), recipients(recip), keyword(key), parameters(param), playerIndex(pIndex)
@@ -338,7 +699,7 @@ void TimerI18nChatSay::execute()
 
 TimerI18nPopupSay::TimerI18nPopupSay(   float delay,
                                         RecipientFilter & recip,
-                                        const string & key,
+                                        const I18nKeyword & key,
                                         int life,
                                         const map<string, string> & param,
                                         int fl)
@@ -29,6 +29,7 @@
 
 #include "UserMessagesManager.h"
 #include "RecipientFilter.h"
+#include "I18nKeyword.h"
 #include "../misc/CannotBeCopied.h"
 #include "../plugin/BaseTimer.h"
 
@@ -36,22 +37,40 @@ class ConVar;
 
 #include <map>
 #include <string>
+#include <vector>
 
 #define TRANSLATIONS_FOLDER "cstrike/cfg/cssmatch/languages/"
+#define TRANSLATIONS_BUNDLE_PATH TRANSLATIONS_FOLDER "translations.bin"
+#define TRANSLATIONS_BUNDLE_TEMP_PATH TRANSLATIONS_BUNDLE_PATH ".tmp"
+
+/** Maximum number of language ids (the clients choose their cl_language freely) */
+#define I18N_MAX_LANGUAGES 64
 
 namespace cssmatch
 {
     class TranslationFile;
+    class TranslationBundle;
+    class TranslationLoadTask;
 
     /** Support for internationalized/localized messages <br>
      * Messages can have parameters, prefixed by $ (e.g.: "The attacker is $attackername") <br>
      * These parameters are passed under the form of a {parameter => value} map <br>
      * <br>
      * Some things are cached: <br>
-     * - TranslationFile instances are cached into a {language => TranslationFile} map
-     *   (avoid mutiple parses of the translation files) <br>
+     * - All the translation files are compiled into a TranslationBundle, mapped when the plugin
+     *   is loaded (avoid parsing a translation file during a match) <br>
+     * - The bundle can be checked/compiled by a worker thread, then used by the game thread at
+     *   the next frame (avoid blocking the server while the translation files are parsed) <br>
+     * - The keywords are interned into ids (see I18nKeyword), the languages and keywords ids are
+     *   resolved once per bundle, then a translation is found by array indexing <br>
+     * - TranslationFile instances, used if the bundle is not available, are cached into a
+     *   {language => TranslationFile} map (avoid mutiple parses of the translation files) <br>
+     * - Each language name gets a small integer id, the players memorize the id of their
+     *   cl_language (avoid querying the engine for each recipient) <br>
+     * - The translations are compiled when the files are parsed, then rendered in a single pass
      * - When a localized message is prepared, the final messages are cached into a 
-     *   {language => I18nMessage} map (avoid multiple calls/searches and parameters handling)
+     *   flat array indexed by language id (avoid multiple calls/searches and parameters handling) <br>
+     *   These messages are kept until another keyword or parameter set is broadcasted
      */
     class I18nManager : public CannotBeCopied, public UserMessagesManager
     {
@@ -59,24 +78,108 @@ namespace cssmatch
         /** What is the default language? */
         ConVar * defaultLanguage;
 
+        /** All the translations (maybe NULL) */
+        TranslationBundle * bundle;
+
+        /** Bundle being loaded by a worker thread (maybe NULL) */
+        TranslationLoadTask * pendingLoad;
+
+        /** Incremented each time the translations in use are replaced */
+        unsigned int translationsVersion;
+
         /** {language name => translation set} */
         std::map<std::string, TranslationFile *> languages;
 
+        /** {language name => language id} */
+        std::map<std::string, int> languageIds;
+
+        /** {language id => language name} */
+        std::vector<std::string> languageNames;
+
+        /** {language id => language index in the bundle, or -1} (resolved on first use) */
+        std::vector<int> bundleLanguages;
+
+        /** {keyword id => keyword index in the bundle, or -1} (resolved on first use) */
+        std::vector<int> bundleKeywords;
+
         /** i18n message (used to cache a message depending to a language) */
         struct I18nMessage
         {
             RecipientFilter recipients;
             std::string message;
+            bool rendered;
+
+            I18nMessage() : rendered(false){}
         };
 
-        /** {language => I18nMessage} */
-        std::map<std::string, I18nMessage> messageCache;
+        /** {language id => I18nMessage} */
+        std::vector<I18nMessage> messageCache;
+
+        /** Keyword id of the messages in the cache (-1 if none) */
+        int cachedKeyword;
+
+        /** Parameters of the messages in the cache */
+        std::map<std::string, std::string> cachedParameters;
+
+        /** Reused buffer for the messages which are not cached */
+        std::string renderBuffer;
 
         /** Update the message cache */
         void updateMessageCache(    int recipientIndex,
-                                    const std::string & language,
-                                    const std::string & keyword,
+                                    int languageId,
+                                    const I18nKeyword & keyword,
                                     const std::map<std::string, std::string> & parameters);
+
+        /** Render the message for each language used by the recipients
+         * @param recipients Recipient list
+         * @param keyword The identifier of the translation to use
+         * @param parameters The message's parameters and their values
+         */
+        void prepareMessageCache(   RecipientFilter & recipients,
+                                    const I18nKeyword & keyword,
+                                    const std::map<std::string, std::string> & parameters);
+
+        /** Get the index of a language in the bundle (the bundle must be loaded)
+         * @param languageId The language id
+         * @return The language index, or -1 if the bundle has no translation for this language
+         */
+        int getBundleLanguage(int languageId);
+
+        /** Get the index of a keyword in the bundle (the bundle must be loaded)
+         * @param keyword The keyword
+         * @return The keyword index, or -1 if the bundle has no translation for this keyword
+         */
+        int getBundleKeyword(const I18nKeyword & keyword);
+
+#ifdef _DEBUG
+        /** Print the translations missing from the bundle: <br>
+         * - the keywords of the bundle which are not translated in every valid language <br>
+         * - the keywords registered by the plugin which are not in the bundle at all
+         */
+        void checkTranslations();
+#endif // _DEBUG
+
+        /** Append the translation of a message to a buffer
+         * @param languageId The language id of the translation
+         * @param keyword The identifier of the translation to retrieve
+         * @param parameters The message's parameters and their values
+         * @param buffer The string where the translation will be appended
+         */
+        void renderTranslation( int languageId,
+                                const I18nKeyword & keyword,
+                                const std::map<std::string, std::string> & parameters,
+                                std::string & buffer);
+
+        /** Replace the translations in use by a loaded bundle (game thread only)
+         * @param loaded The bundle (maybe NULL), the I18nManager takes its ownership
+         * @param compiled <code>true</code> if a new bundle was compiled aside, to use instead
+         * @return <code>true</code> if the translations in use were replaced
+         * @see TranslationLoadTask
+         */
+        bool useBundle(TranslationBundle * loaded, bool compiled);
+
+        /** Wait for the bundle being loaded by a worker thread, then use it */
+        void waitPendingLoad();
     public:
         /** Empty map for messages which have no option to parse */
         static std::map<std::string, std::string> WITHOUT_PARAMETERS;
@@ -93,6 +196,53 @@ namespace cssmatch
         /** Get the current default language */
         std::string getDefaultLanguage() const;
 
+        /** Get the id corresponding to a language name <br>
+         * Register the language if it's not already done. Once I18N_MAX_LANGUAGES languages are
+         * registered, the unknown languages get the id of the default language.
+         * @param language The language name (e.g. the cl_language value of a client)
+         * @return The language id
+         */
+        int getLanguageId(const std::string & language);
+
+        /** Get the name of a language
+         * @param languageId The language id, as returned by getLanguageId
+         * @return The language name
+         */
+        const std::string & getLanguageName(int languageId) const;
+
+        /** Get the language id of a client <br>
+         * Use the id memorized by the Player instance if any, or query the engine
+         * @param index The client index
+         * @return The language id
+         */
+        int getClientLanguageId(int index);
+
+        /** Forget the messages rendered for the last broadcast */
+        void invalidateMessageCache();
+
+        /** Get the version of the translations in use <br>
+         * The version changes each time the translations are replaced, so the texts rendered
+         * from the previous translations can be detected
+         */
+        unsigned int getTranslationsVersion() const;
+
+        /** Replace the translations in use by the translation bundle <br>
+         * The bundle is compiled from the translation files first if needed
+         * @param recompile If <code>true</code>, compile the bundle even if it is up to date
+         * @return <code>true</code> if the bundle was loaded, <code>false</code> if the
+         * translations in use were kept
+         */
+        bool loadTranslations(bool recompile);
+
+        /** Same as loadTranslations(false), but the bundle is loaded by a worker thread <br>
+         * The translations in use are kept until publishTranslations() replaces them. If there is
+         * none yet, the messages use the default language meanwhile.
+         */
+        void preloadTranslations();
+
+        /** Use the bundle loaded by the worker thread, if it's ready (called at each frame) */
+        void publishTranslations();
+
         /** Retrieve the TranslationFile instance corresponding to a language <br>
          * Store/Cache it if it's not already done
          * @param language The language which has to be used
@@ -106,10 +256,19 @@ namespace cssmatch
          * @param parameters If specified, the message's parameters and their values
          */
         std::string getTranslation( const std::string & language,
-                                    const std::string & keyword,
+                                    const I18nKeyword & keyword,
                                     const std::map<std::string,
                                                    std::string> & parameters = WITHOUT_PARAMETERS);
 
+        /** Retrieve the translation of a message
+         * @param languageId The language id of the translation
+         * @param keyword The identifier of the translation to retrieve
+         * @param parameters If specified, the message's parameters and their values
+         */
+        std::string getTranslation( int languageId,
+                                    const I18nKeyword & keyword,
+                                    const std::map<std::string,
+                                                   std::string> & parameters = WITHOUT_PARAMETERS);
 
         /** Send a chat message <br>
          * \001, \003 and \004 will colour the message
@@ -121,7 +280,7 @@ namespace cssmatch
          * @see UserMessagesManager::chatSay
          */
         void i18nChatSay(   RecipientFilter & recipients,
-                            const std::string & keyword,
+                            const I18nKeyword & keyword,
                             const std::map<std::string,
                                            std::string> & parameters = WITHOUT_PARAMETERS,
                             int playerIndex = CSSMATCH_INVALID_INDEX);
@@ -133,7 +292,7 @@ namespace cssmatch
          * @param parameters If specified, the message's parameters and their values
          */
         void i18nChatWarning(   RecipientFilter & recipients,
-                                const std::string & keyword,
+                                const I18nKeyword & keyword,
                                 const std::map<std::string,
                                                std::string> & parameters = WITHOUT_PARAMETERS);
 
@@ -145,7 +304,7 @@ namespace cssmatch
          * @param parameters If specified, the message's parameters and their values
          */
         void i18nPopupSay(  RecipientFilter & recipients,
-                            const std::string & keyword,
+                            const I18nKeyword & keyword,
                             int lifeTime,
                             const std::map<std::string,
                                            std::string> & parameters = WITHOUT_PARAMETERS,
@@ -157,7 +316,7 @@ namespace cssmatch
          * @param parameters If specified, the message's parameters and their values
          */
         void i18nHintSay(   RecipientFilter & recipients,
-                            const std::string & keyword,
+                            const I18nKeyword & keyword,
                             const std::map<std::string,
                                            std::string> & parameters = WITHOUT_PARAMETERS);
 
@@ -167,7 +326,7 @@ namespace cssmatch
          * @param parameters If specified, the message's parameters and their values
          */
         void i18nCenterSay( RecipientFilter & recipients,
-                            const std::string & keyword,
+                            const I18nKeyword & keyword,
                             const std::map<std::string,
                                            std::string> & parameters = WITHOUT_PARAMETERS);
 
@@ -177,7 +336,7 @@ namespace cssmatch
          * @param parameters If specified, the message's parameters and their values
          */
         void i18nConsoleSay(RecipientFilter & recipients,
-                            const std::string & keyword,
+                            const I18nKeyword & keyword,
                             const std::map<std::string,
                                            std::string> & parameters = WITHOUT_PARAMETERS);
 
@@ -185,7 +344,7 @@ namespace cssmatch
          * @param keyword The identifier of the translation to use
          * @param parameters If specified, the message's parameters and their values
          */
-        void i18nMsg(   const std::string & keyword,
+        void i18nMsg(   const I18nKeyword & keyword,
                         const std::map<std::string, std::string> & parameters = WITHOUT_PARAMETERS);
     };
 
@@ -202,7 +361,7 @@ namespace cssmatch
         RecipientFilter recipients;
 
         /** @see I18nManager::I18nChatSay */
-        std::string keyword;
+        I18nKeyword keyword;
 
         /** @see I18nManager::I18nChatSay */
         int playerIndex;
@@ -220,7 +379,7 @@ namespace cssmatch
          */
         TimerI18nChatSay(   float executionDate,
                             RecipientFilter & recipients,
-                            const std::string & keyword,
+                            const I18nKeyword & keyword,
                             const std::map<std::string,
                                            std::string> & parameters =
                                 I18nManager::WITHOUT_PARAMETERS,
@@ -243,7 +402,7 @@ namespace cssmatch
         RecipientFilter recipients;
 
         /** @see I18nManager::I18nChatSay */
-        std::string keyword;
+        I18nKeyword keyword;
 
         /** @see I18nManager::I18nPopupSay */
         int lifeTime;
@@ -265,7 +424,7 @@ namespace cssmatch
          */
         TimerI18nPopupSay(  float executionDate,
                             RecipientFilter & recipients,
-                            const std::string & keyword,
+                            const I18nKeyword & keyword,
                             int lifeTime,
                             const std::map<std::string,
                                            std::string> & parameters =
@@ -38,8 +38,42 @@ using std::map;
 using std::ostringstream;
 using std::min;
 
+// Translation keywords
+static const I18nKeyword MENU_CANT_DISPLAY("menu_cant_display");
+static const I18nKeyword MENU_CLOSE("menu_close");
+static const I18nKeyword MENU_EMPTY("menu_empty");
+
+/** Maximum number of rendered pages kept by a menu */
+static const size_t MENU_MAX_RENDERED_PAGES = 64;
+
+/** Hash a parameter set (FNV-1a of each name and value) */
+static unsigned int hashParameters(const map<string, string> & parameters)
+{
+    unsigned int hash = 2166136261u;
+
+    map<string, string>::const_iterator itParameter;
+    for(itParameter = parameters.begin(); itParameter != parameters.end(); itParameter++)
+    {
+        const string * fields[] = { &itParameter->first, &itParameter->second };
+        for(int iField = 0; iField < 2; iField++)
+        {
+            string::const_iterator itChar;
+            for(itChar = fields[iField]->begin(); itChar != fields[iField]->end(); itChar++)
+            {
+                hash ^= (unsigned char)*itChar;
+                hash *= 16777619u;
+            }
+            // Separate the fields, so {"ab" => "c"} and {"a" => "bc"} differ
+            hash ^= 0xFF;
+            hash *= 16777619u;
+        }
+    }
+
+    return hash;
+}
+
 Menu::Menu(Menu * parentMenu, const string & menuTitle, BaseMenuCallback * menuCallback)
-    : parent(parentMenu), title(menuTitle), callback(menuCallback)
+    : parent(parentMenu), title(menuTitle), callback(menuCallback), renderedVersion(0)
 {}
 
 Menu::~Menu()
@@ -58,6 +92,9 @@ Menu::~Menu()
 
 void Menu::addLine(MenuLine * toAdd)
 {
+    // The pages have to be rendered again
+    renderedPages.clear();
+
     int linecount = lines.size();
 
     if ((linecount == 0) && (parent != NULL)) // First option in the menu?
@@ -204,76 +241,144 @@ MenuLine * Menu::getLine(int page, int choice) throw(MenuException)
     return line;
 }
 
-void Menu::send(Player * recipient, int page, const map<string, string> & parameters)
+Menu::RenderedPage * Menu::findRenderedPage(  int page,
+                                                int languageId,
+                                                unsigned int parametersHash,
+                                                const map<string, string> & parameters)
+{
+    RenderedPage * found = NULL;
+
+    vector<RenderedPage>::iterator itPage = renderedPages.begin();
+    vector<RenderedPage>::iterator lastPage = renderedPages.end();
+    while((found == NULL) && (itPage != lastPage))
+    {
+        if ((itPage->page == page) && (itPage->languageId == languageId) &&
+            (itPage->parametersHash == parametersHash) && (itPage->parameters == parameters))
+            found = &*itPage;
+        itPage++;
+    }
+
+    return found;
+}
+
+bool Menu::renderPage(RenderedPage & rendered, RecipientFilter & recipients)
 {
     ServerPlugin * plugin = ServerPlugin::getInstance();
-    ValveInterfaces * interfaces = plugin->getInterfaces();
     I18nManager * i18n = plugin->getI18nManager();
 
-    int playerIndex = recipient->getIdentity()->index;
-    string language = interfaces->engine->GetClientConVarValue(playerIndex, "cl_language");
+    bool cacheable = true;
+    int language = rendered.languageId;
     int linecount = lines.size();
-    RecipientFilter recipientlist;
-    recipientlist.addRecipient(recipient);
 
-    int iBegin = (page-1)*9;
-    if ((iBegin >= 0) && (iBegin <= linecount))
-    {
-        //int iEnd = iBegin+9; // multi-page => bad sensibility
-        int iEnd = iBegin + min(linecount-iBegin, 9);
+    int iBegin = (rendered.page-1)*9;
+    //int iEnd = iBegin+9; // multi-page => bad sensibility
+    int iEnd = iBegin + min(linecount-iBegin, 9);
 
-        // Set the options that the player will be able to select
-        int optioncount = iEnd-iBegin;
-        int sensibilityFlags = OPTION_CANCEL;
-        if (optioncount == 9)
-        {
-            sensibilityFlags |= OPTION_ALL;
-        }
-        else
+    // Set the options that the player will be able to select
+    int optioncount = iEnd-iBegin;
+    rendered.sensibilityFlags = OPTION_CANCEL;
+    if (optioncount == 9)
+    {
+        rendered.sensibilityFlags |= OPTION_ALL;
+    }
+    else
+    {
+        optioncount--;
+        while(optioncount >= 0)
         {
+            rendered.sensibilityFlags |= (1<<optioncount);
             optioncount--;
-            while(optioncount >= 0)
-            {
-                sensibilityFlags |= (1<<optioncount);
-                optioncount--;
-            }
         }
+    }
 
-        ostringstream menu;
-        menu << i18n->getTranslation(language, title) << "\n";
+    ostringstream menu;
+    menu << i18n->getTranslation(language, I18nKeyword(title)) << "\n";
 
-        if (linecount == 0) // Is the menu empty ?
-        {
-            menu << " \n" << i18n->getTranslation(language, "menu_empty") << "\n \n";
+    if (linecount == 0) // Is the menu empty ?
+    {
+        menu << " \n" << i18n->getTranslation(language, MENU_EMPTY) << "\n \n";
 
-            CSSMATCH_PRINT("Empty menu " + title);
+        CSSMATCH_PRINT("Empty menu " + title);
+    }
+    else if ((iBegin < 0) || (iEnd > linecount))
+    {
+        map<string, string> errorParam;
+        errorParam["$site"] = CSSMATCH_SITE;
+        i18n->i18nChatSay(recipients, MENU_CANT_DISPLAY, errorParam);
+        cacheable = false;
+    }
+    else
+    {
+        int iOption = 1;
+        while(iBegin < iEnd)
+        {
+            MenuLine * line = lines[iBegin];
+
+            menu << "->" << iOption << ". ";
+            if (line->i18n)
+                menu << i18n->getTranslation(language, I18nKeyword(line->text),
+                                             rendered.parameters);
+            else
+                menu << line->text;
+            menu << "\n";
+
+            iOption++;
+            iBegin++;
         }
-        else if ((iBegin < 0) || (iEnd > linecount))
+    }
+    menu << "0. " << i18n->getTranslation(language, MENU_CLOSE);
+    rendered.text = menu.str();
+
+    return cacheable;
+}
+
+void Menu::send(Player * recipient, int page, const map<string, string> & parameters)
+{
+    ServerPlugin * plugin = ServerPlugin::getInstance();
+    I18nManager * i18n = plugin->getI18nManager();
+
+    int language = recipient->getLanguageId();
+    int linecount = lines.size();
+    RecipientFilter recipientlist;
+    recipientlist.addRecipient(recipient);
+
+    int iBegin = (page-1)*9;
+    if ((iBegin >= 0) && (iBegin <= linecount))
+    {
+        // The pages rendered from the previous translations are obsolete
+        unsigned int translationsVersion = i18n->getTranslationsVersion();
+        if (renderedVersion != translationsVersion)
         {
-            map<string, string> errorParam;
-            errorParam["$site"] = CSSMATCH_SITE;
-            i18n->i18nChatSay(recipientlist, "menu_cant_display", errorParam);
+            renderedPages.clear();
+            renderedVersion = translationsVersion;
         }
-        else
+
+        unsigned int parametersHash = hashParameters(parameters);
+        RenderedPage * rendered = findRenderedPage(page, language, parametersHash, parameters);
+        if (rendered == NULL)
         {
-            int iOption = 1;
-            while(iBegin < iEnd)
+            // Not rendered yet, render the page once
+            if (renderedPages.size() >= MENU_MAX_RENDERED_PAGES)
+                renderedPages.clear();
+
+            renderedPages.push_back(RenderedPage());
+            rendered = &renderedPages.back();
+            rendered->page = page;
+            rendered->languageId = language;
+            rendered->parametersHash = parametersHash;
+            rendered->parameters = parameters;
+
+            if (! renderPage(*rendered, recipientlist))
             {
-                MenuLine * line = lines[iBegin];
-
-                menu << "->" << iOption << ". ";
-                if (line->i18n)
-                    menu << i18n->getTranslation(language, line->text, parameters);
-                else
-                    menu << line->text;
-                menu << "\n";
-
-                iOption++;
-                iBegin++;
+                // Send this page once, but don't keep it
+                i18n->popupSay(recipientlist, rendered->text, -1, rendered->sensibilityFlags);
+                renderedPages.pop_back();
+                rendered = NULL;
             }
         }
-        menu << "0. " << i18n->getTranslation(language, "menu_close");
-        i18n->popupSay(recipientlist, menu.str(), -1, sensibilityFlags);
+
+        if (rendered != NULL)
+            i18n->popupSay(recipientlist, rendered->text, -1, rendered->sensibilityFlags);
     }
     else
         CSSMATCH_PRINT("Invalid menu page");
@@ -134,10 +134,58 @@ namespace cssmatch
         /** Menu lines */
         std::vector<MenuLine *> lines;
 
+        /** Menu page rendered for a language and a parameter set */
+        struct RenderedPage
+        {
+            /** The page number */
+            int page;
+
+            /** The language id of the translations */
+            int languageId;
+
+            /** Hash of the parameters (avoid comparing the parameters of each rendered page) */
+            unsigned int parametersHash;
+
+            /** The i18n parameters used by the lines */
+            std::map<std::string, std::string> parameters;
+
+            /** The options that the player is able to select */
+            int sensibilityFlags;
+
+            /** The popup text, ready to be sent */
+            std::string text;
+        };
+
+        /** Pages already rendered, sent as is until a line is added to the menu */
+        std::vector<RenderedPage> renderedPages;
+
+        /** Version of the translations used by the rendered pages */
+        unsigned int renderedVersion;
+
         /** Add a line to the menu
          * @param toAdd The line to add
          */
         void addLine(MenuLine * toAdd);
+
+        /** Find a page already rendered
+         * @param page The page number
+         * @param languageId The language id
+         * @param parametersHash The hash of the parameters
+         * @param parameters The i18n parameters
+         * @return The rendered page, or NULL if not found
+         */
+        RenderedPage * findRenderedPage(int page,
+                                        int languageId,
+                                        unsigned int parametersHash,
+                                        const std::map<std::string, std::string> & parameters);
+
+        /** Render a page of the menu (the page number must be valid)
+         * @param rendered The page to render (the page number, language and parameters set)
+         * @param recipients The recipient of the menu, in case of error
+         * @return <code>false</code> if the page can't be displayed properly and must not be
+         * cached
+         */
+        bool renderPage(RenderedPage & rendered, RecipientFilter & recipients);
     public:
         /**
          * @param parentMenu Parent menu
@@ -174,6 +222,8 @@ namespace cssmatch
         MenuLine * getLine(int page, int choice) throw(MenuException);
 
         /** Display the menu to a player <br>
+         * The page is rendered once per language and parameter set, then the rendered text is
+         * sent again each time the menu is displayed <br>
          * IMPORTANT: Use Player::sendMenu instead, otherwise the player will not be able to select anything
          * @param recipient The recipient
          * @param page The page number to send to the player
@@ -74,10 +74,15 @@ void RecipientFilter::addAllPlayers()
 {
     ServerPlugin * plugin = ServerPlugin::getInstance();
 
-    list<ClanMember *> * playerlist = plugin->getPlayerlist();
+    const PlayerList * playerlist = plugin->getPlayerlist();
     for_each(playerlist->begin(), playerlist->end(), PlayerToRecipient(this));
 }
 
+void RecipientFilter::removeAllRecipients()
+{
+    recipients.clear();
+}
+
 int RecipientFilter::GetRecipientIndex(int slot) const
 {
     int index = CSSMATCH_INVALID_INDEX;
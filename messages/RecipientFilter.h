@@ -74,6 +74,9 @@ namespace cssmatch
         /** Add every players to the recipient list */
         void addAllPlayers();
 
+        /** Empty the recipient list */
+        void removeAllRecipients();
+
         /** Get a vector of the recipient list */
         const std::vector<int> * getVector() const;
     };
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "UserMessageWriter.h"
+
+#include "bitbuf.h"
+
+#include <cstring>
+
+using namespace cssmatch;
+
+using std::string;
+
+void cssmatch::writeStringParts(bf_write * buffer,
+                                const char * prefix,
+                                const string & message,
+                                const char * suffix)
+{
+    buffer->WriteBytes(prefix, strlen(prefix));
+    buffer->WriteBytes(message.data(), message.size());
+    buffer->WriteString(suffix); // also writes the terminating null character
+}
+
+size_t cssmatch::writeStringSlice(  bf_write * buffer,
+                                    const string & message,
+                                    size_t offset,
+                                    size_t size)
+{
+    size_t messageSize = message.size();
+    size_t sliceSize = (offset < messageSize) ? messageSize - offset : 0;
+    if (sliceSize > size)
+        sliceSize = size;
+
+    buffer->WriteBytes(message.data() + offset, sliceSize);
+    buffer->WriteByte(0);
+
+    return offset + sliceSize;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __USER_MESSAGE_WRITER_H__
+#define __USER_MESSAGE_WRITER_H__
+
+class bf_write;
+
+#include <string>
+
+namespace cssmatch
+{
+    /** Write a null-terminated string made of several parts into a user message <br>
+     * The parts are written straight into the buffer, without building any intermediate string
+     * @param buffer The user message buffer
+     * @param prefix Written before the message
+     * @param message The message
+     * @param suffix Written after the message
+     */
+    void writeStringParts(  bf_write * buffer,
+                            const char * prefix,
+                            const std::string & message,
+                            const char * suffix);
+
+    /** Write a part of a message as a null-terminated string into a user message
+     * @param buffer The user message buffer
+     * @param message The message
+     * @param offset Where the part begins in the message
+     * @param size The maximum size of the part
+     * @return The offset where the next part begins
+     */
+    size_t writeStringSlice(bf_write * buffer,
+                            const std::string & message,
+                            size_t offset,
+                            size_t size);
+}
+
+#endif // __USER_MESSAGE_WRITER_H__
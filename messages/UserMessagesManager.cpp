@@ -27,209 +27,219 @@
 #include "UserMessagesManager.h"
 
 #include "RecipientFilter.h"
+#include "UserMessageWriter.h"
 #include "../plugin/ServerPlugin.h"
 
 #include "bitbuf.h"
 #include "IEngineSound.h"
 #include "soundflags.h" // CHAN_STATIC
 
-#include <algorithm>
-#include <sstream>
+#include <cstring>
 
 using namespace cssmatch;
 
-using std::map;
 using std::string;
-using std::ostringstream;
 using std::vector;
 
-int UserMessagesManager::findMessageType(const std::string & typeName)
+/** {message type => message type name} */
+static const char * MESSAGE_TYPE_NAMES[USER_MESSAGE_TYPE_COUNT] =
 {
-    int id = CSSMATCH_INVALID_MSG_TYPE;
-
-    // Does this message type already known?
-    map<string, int>::iterator itTypeId = messageTypes.find(typeName);
-    if (itTypeId == messageTypes.end())
+    "SayText",
+    "ShowMenu",
+    "HintText",
+    "VGUIMenu",
+    "TextMsg"
+};
+
+void UserMessagesManager::resolveMessageTypes()
+{
+    ServerPlugin * plugin = ServerPlugin::getInstance();
+    ValveInterfaces * interfaces = plugin->getInterfaces();
+
+    // Only the types not found yet are looked up
+    char foundName[20];
+    int foundNameSize = 0;
+    int nbTypes = plugin->getConVar("cssmatch_usermessages")->GetInt();
+    for(int i = 0; i < nbTypes; i++)
     {
-        // No, search/cache it
-        ServerPlugin * plugin = ServerPlugin::getInstance();
-        ValveInterfaces * interfaces = plugin->getInterfaces();
-
-        char foundName[20];
-        int foundNameSize = 0;
-        int i = 0;
-        int nbTypes = plugin->getConVar("cssmatch_usermessages")->GetInt();
-        while(i < nbTypes)
+        if (interfaces->serverGameDll->GetUserMessageInfo(i, foundName, sizeof(foundName),
+                                                          foundNameSize))
         {
-            if (interfaces->serverGameDll->GetUserMessageInfo(i, foundName, sizeof(foundName),
-                                                              foundNameSize))
+            for(int type = 0; type < USER_MESSAGE_TYPE_COUNT; type++)
             {
-                if (typeName == foundName)
-                {
-                    messageTypes[typeName] = i;
-                    id = i;
-                    break;
-                }
+                if ((messageTypes[type] == CSSMATCH_INVALID_MSG_TYPE)
+                    && (strcmp(MESSAGE_TYPE_NAMES[type], foundName) == 0))
+                    messageTypes[type] = i;
             }
-            i++;
         }
-        if (id == CSSMATCH_INVALID_MSG_TYPE)
-            CSSMATCH_PRINT("Unknown message type " + typeName)
-            }
-            else
-            {
-                // Yes
-                id = itTypeId->second;
-            }
-
-        return id;
     }
 
-    UserMessagesManager::UserMessagesManager()
+    // The table is complete once every type was found, the user messages may not be registered
+    // yet (e.g. a message sent early)
+    messageTypesResolved = true;
+    for(int type = 0; type < USER_MESSAGE_TYPE_COUNT; type++)
     {
-        engine = ServerPlugin::getInstance()->getInterfaces()->engine;
+        if (messageTypes[type] == CSSMATCH_INVALID_MSG_TYPE)
+        {
+            CSSMATCH_PRINT(string("Unknown message type ") + MESSAGE_TYPE_NAMES[type]);
+            messageTypesResolved = false;
+        }
     }
+}
 
-    UserMessagesManager::~UserMessagesManager()
-    {}
-
-    void UserMessagesManager::chatSay(RecipientFilter & recipients, const string & message,
-                                      int playerIndex)
-    {
-        ostringstream output;
-        output << "\004[" << CSSMATCH_NAME << "]\001 " << message << "\n";
+int UserMessagesManager::getMessageType(UserMessageType type)
+{
+    if (! messageTypesResolved)
+        resolveMessageTypes();
 
-        bf_write * pBitBuf = engine->UserMessageBegin(&recipients, findMessageType("SayText"));
+    return messageTypes[type];
+}
 
-        pBitBuf->WriteByte(playerIndex);
-        pBitBuf->WriteString(output.str().c_str());
-        pBitBuf->WriteByte(1); // DOCUMENT ME
+UserMessagesManager::UserMessagesManager() : messageTypesResolved(false)
+{
+    engine = ServerPlugin::getInstance()->getInterfaces()->engine;
 
-        engine->MessageEnd();
+    for(int type = 0; type < USER_MESSAGE_TYPE_COUNT; type++)
+    {
+        messageTypes[type] = CSSMATCH_INVALID_MSG_TYPE;
     }
+}
 
-    void UserMessagesManager::chatWarning(RecipientFilter & recipients, const string & message)
-    {
-        ostringstream output;
-        output << "\004[" << CSSMATCH_NAME << "]\003 " << message << "\n";
+UserMessagesManager::~UserMessagesManager()
+{}
 
-        bf_write * pBitBuf = engine->UserMessageBegin(&recipients, findMessageType("SayText"));
+void UserMessagesManager::chatSay(RecipientFilter & recipients, const string & message,
+                                  int playerIndex)
+{
+    bf_write * pBitBuf = engine->UserMessageBegin(&recipients, getMessageType(SAYTEXT_MSG));
 
-        pBitBuf->WriteByte(0x02); // \003 => team color
-        pBitBuf->WriteString(output.str().c_str());
-        pBitBuf->WriteByte(0x01); // \003 => team color
-        pBitBuf->WriteByte(1); // DOCUMENT ME
+    pBitBuf->WriteByte(playerIndex);
+    writeStringParts(pBitBuf, "\004[" CSSMATCH_NAME "]\001 ", message, "\n");
+    pBitBuf->WriteByte(1); // DOCUMENT ME
 
-        engine->MessageEnd();
-    }
+    engine->MessageEnd();
+}
 
-    void UserMessagesManager::popupSay( RecipientFilter & recipients,
-                                        const string & message,
-                                        int lifeTime,
-                                        int flags)
-    {
-        // Only CSSMATCH_MAX_MSG_SIZE bytes can be sent in one user message
-        // So, as the popup menus are generally large, they are split in n messages of
-        // CSSMATCH_MAX_MSG_SIZE bytes
+void UserMessagesManager::chatWarning(RecipientFilter & recipients, const string & message)
+{
+    bf_write * pBitBuf = engine->UserMessageBegin(&recipients, getMessageType(SAYTEXT_MSG));
 
-        int iBegin = 0;
-        int popupSize = message.size();
-        bool moreToSend = false;
+    pBitBuf->WriteByte(0x02); // \003 => team color
+    writeStringParts(pBitBuf, "\004[" CSSMATCH_NAME "]\003 ", message, "\n");
+    pBitBuf->WriteByte(0x01); // \003 => team color
+    pBitBuf->WriteByte(1); // DOCUMENT ME
 
-        do
-        {
-            string toSend = message.substr(iBegin, CSSMATCH_MAX_MSG_SIZE);
-            iBegin += CSSMATCH_MAX_MSG_SIZE;
+    engine->MessageEnd();
+}
+
+void UserMessagesManager::popupSay( RecipientFilter & recipients,
+                                    const string & message,
+                                    int lifeTime,
+                                    int flags)
+{
+    // Only CSSMATCH_MAX_MSG_SIZE bytes can be sent in one user message
+    // So, as the popup menus are generally large, they are split in n messages of
+    // CSSMATCH_MAX_MSG_SIZE bytes (each slice is directly written into the user message)
 
-            bf_write * pBuffer = engine->UserMessageBegin(&recipients, findMessageType("ShowMenu"));
+    int messageType = getMessageType(SHOWMENU_MSG);
+    size_t iBegin = 0;
+    size_t popupSize = message.size();
+    bool moreToSend = false;
 
-            pBuffer->WriteShort(flags); // set the flags
-            pBuffer->WriteChar(lifeTime); // set the lifetime
+    do
+    {
+        bf_write * pBuffer = engine->UserMessageBegin(&recipients, messageType);
 
-            moreToSend = iBegin < popupSize;
-            pBuffer->WriteByte(moreToSend); // Is the message completed?
+        pBuffer->WriteShort(flags); // set the flags
+        pBuffer->WriteChar(lifeTime); // set the lifetime
 
-            pBuffer->WriteString(toSend.c_str()); // set the text
+        moreToSend = iBegin + CSSMATCH_MAX_MSG_SIZE < popupSize;
+        pBuffer->WriteByte(moreToSend); // Is the message completed?
 
-            engine->MessageEnd();
-        }
-        while(moreToSend);
+        iBegin = writeStringSlice(pBuffer, message, iBegin, CSSMATCH_MAX_MSG_SIZE); // set the text
+
+        engine->MessageEnd();
     }
+    while(moreToSend);
+}
 
-    void UserMessagesManager::hintSay(RecipientFilter & recipients, const string & message)
-    {
-        ServerPlugin * plugin = ServerPlugin::getInstance();
-        ValveInterfaces * interfaces = plugin->getInterfaces();
+void UserMessagesManager::hintSay(RecipientFilter & recipients, const string & message)
+{
+    ServerPlugin * plugin = ServerPlugin::getInstance();
+    ValveInterfaces * interfaces = plugin->getInterfaces();
 
-        bf_write * pWrite = engine->UserMessageBegin(&recipients, findMessageType("HintText"));
+    bf_write * pWrite = engine->UserMessageBegin(&recipients, getMessageType(HINTTEXT_MSG));
 
-        pWrite->WriteString(message.c_str());
+    pWrite->WriteString(message.c_str());
 
-        engine->MessageEnd();
+    engine->MessageEnd();
 
-        // Stop the HintText annoying sound
-        const vector<int> * recipientlist = recipients.getVector();
-        vector<int>::const_iterator itIndex;
-        for (itIndex = recipientlist->begin(); itIndex != recipientlist->end(); itIndex++)
-        {
-            interfaces->sounds->StopSound(*itIndex, CHAN_STATIC, "UI/hint.wav");
-        }
+    // Stop the HintText annoying sound
+    const vector<int> * recipientlist = recipients.getVector();
+    vector<int>::const_iterator itIndex;
+    for (itIndex = recipientlist->begin(); itIndex != recipientlist->end(); itIndex++)
+    {
+        interfaces->sounds->StopSound(*itIndex, CHAN_STATIC, "UI/hint.wav");
     }
+}
 
-    void UserMessagesManager::motdSay(RecipientFilter recipients, MotdType type,
-                                      const string & title,
-                                      const string & message)
-    {
-        bf_write * pWrite = engine->UserMessageBegin(&recipients, findMessageType("VGUIMenu"));
+void UserMessagesManager::motdSay(RecipientFilter & recipients, MotdType type,
+                                  const string & title,
+                                  const string & message)
+{
+    char typeBuffer[12];
+    V_snprintf(typeBuffer, sizeof(typeBuffer), "%d", (int)type);
 
-        pWrite->WriteString("info"); // Let give some info about this message
-        pWrite->WriteByte(1); // 1=Show this message, 0=otherwise
-        pWrite->WriteByte(3); // "title", "type" and "msg"
+    bf_write * pWrite = engine->UserMessageBegin(&recipients, getMessageType(VGUIMENU_MSG));
 
-        pWrite->WriteString("title");
-        pWrite->WriteString(title.c_str());
+    pWrite->WriteString("info"); // Let give some info about this message
+    pWrite->WriteByte(1); // 1=Show this message, 0=otherwise
+    pWrite->WriteByte(3); // "title", "type" and "msg"
 
-        pWrite->WriteString("type");
-        pWrite->WriteString(toString(type).c_str());
+    pWrite->WriteString("title");
+    pWrite->WriteString(title.c_str());
 
-        pWrite->WriteString("msg");
-        pWrite->WriteString(message.c_str());
+    pWrite->WriteString("type");
+    pWrite->WriteString(typeBuffer);
 
-        engine->MessageEnd();
-    }
+    pWrite->WriteString("msg");
+    pWrite->WriteString(message.c_str());
 
-    void UserMessagesManager::showPanel(RecipientFilter recipients, const std::string & panelName,
-                                        bool show)
-    {
-        bf_write * pWrite = engine->UserMessageBegin(&recipients, findMessageType("VGUIMenu"));
+    engine->MessageEnd();
+}
 
-        pWrite->WriteString(panelName.c_str());
-        pWrite->WriteByte((int)show);
-        pWrite->WriteByte(0); // No more data
+void UserMessagesManager::showPanel(RecipientFilter & recipients, const std::string & panelName,
+                                    bool show)
+{
+    bf_write * pWrite = engine->UserMessageBegin(&recipients, getMessageType(VGUIMENU_MSG));
 
-        engine->MessageEnd();
-    }
+    pWrite->WriteString(panelName.c_str());
+    pWrite->WriteByte((int)show);
+    pWrite->WriteByte(0); // No more data
 
-    void UserMessagesManager::centerSay(RecipientFilter & recipients, const string & message)
-    {
-        bf_write * pWrite = engine->UserMessageBegin(&recipients, findMessageType("TextMsg"));
+    engine->MessageEnd();
+}
 
-        pWrite->WriteByte(4); // DOCUMENT ME
-        pWrite->WriteString(message.c_str());
-        pWrite->WriteByte(0); // DOCUMENT ME
+void UserMessagesManager::centerSay(RecipientFilter & recipients, const string & message)
+{
+    bf_write * pWrite = engine->UserMessageBegin(&recipients, getMessageType(TEXTMSG_MSG));
 
-        engine->MessageEnd();
-    }
+    pWrite->WriteByte(4); // DOCUMENT ME
+    pWrite->WriteString(message.c_str());
+    pWrite->WriteByte(0); // DOCUMENT ME
 
-    void UserMessagesManager::consoleSay(RecipientFilter & recipients, const string & message)
-    {
-        bf_write * pWrite = engine->UserMessageBegin(&recipients, findMessageType("TextMsg"));
+    engine->MessageEnd();
+}
+
+void UserMessagesManager::consoleSay(RecipientFilter & recipients, const string & message)
+{
+    bf_write * pWrite = engine->UserMessageBegin(&recipients, getMessageType(TEXTMSG_MSG));
 
-        pWrite->WriteByte(HUD_PRINTNOTIFY);
-        pWrite->WriteString(message.c_str());
+    pWrite->WriteByte(HUD_PRINTNOTIFY);
+    pWrite->WriteString(message.c_str());
 
-        engine->MessageEnd();
-    }
+    engine->MessageEnd();
+}
 
 /*void UserMessagesManager::consoleTell(int index, const string & message)
 {
@@ -32,7 +32,6 @@
 class IVEngineServer;
 
 #include <string>
-#include <map>
 
 /** Max popup size <br>
  * Beyond this value, the message can't be send in one message to the client, <br>
@@ -85,21 +84,43 @@ namespace cssmatch
         URL = 2
     };
 
+    /** User message types used by the plugin */
+    enum UserMessageType
+    {
+        SAYTEXT_MSG = 0,
+        SHOWMENU_MSG,
+        HINTTEXT_MSG,
+        VGUIMENU_MSG,
+        TEXTMSG_MSG,
+
+        /** Number of message types */
+        USER_MESSAGE_TYPE_COUNT
+    };
+
     /** Send different kind of message to the players */
     class UserMessagesManager
     {
     private:
-        /** {message type name => user message id} map filled by findMessageType */
-        std::map<std::string, int> messageTypes;
+        /** {message type => user message id} table filled by resolveMessageTypes */
+        int messageTypes[USER_MESSAGE_TYPE_COUNT];
+
+        /** Were all the message type ids resolved? */
+        bool messageTypesResolved;
+
+        /** Lookup the ids of the message types used by the plugin, which are not found yet <br>
+         * Done when the first message is sent (cssmatch_usermessages can be set by the server
+         * configuration after the plugin load), then again as long as a type is unknown
+         */
+        void resolveMessageTypes();
     protected:
         /** Valve's IVEngineServer instance */
         IVEngineServer * engine; // Optimisation
 
-        /** Lookup a message type id
-         * @param typeName The message type name (e.g. ShowMenu)
+        /** Get a message type id
+         * @param type The message type
          * @return The message type id, CSSMATCH_INVALID_MSG_TYPE otherwise
          */
-        int findMessageType(const std::string & typeName);
+        int getMessageType(UserMessageType type);
 
         /* Send a console message to a single client
          * @param index The client index
@@ -151,7 +172,7 @@ namespace cssmatch
          * @param message Message or URL
          * @see enum MotdType
          */
-        void motdSay(RecipientFilter recipients, MotdType type, const std::string & title,
+        void motdSay(RecipientFilter & recipients, MotdType type, const std::string & title,
                      const std::string & message);
 
         /** Show/Hide an existing vgui panel
@@ -159,7 +180,7 @@ namespace cssmatch
          * @param panelName Panel name
          * @param show <code>true</code>: show the panel, <code>false</code>: hide the panel
          */
-        void showPanel(RecipientFilter recipients, const std::string & panelName, bool show);
+        void showPanel(RecipientFilter & recipients, const std::string & panelName, bool show);
 
         /** Send a centered message
          * @param recipients Recipient list
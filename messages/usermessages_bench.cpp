@@ -0,0 +1,216 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+/* Micro-benchmark of the user messages formatting: counts the heap allocations per message kind
+ * Build with "make bench", it only depends on UserMessageWriter.cpp and the SDK's tier1
+ */
+
+#include "UserMessageWriter.h"
+#include "UserMessagesManager.h" // CSSMATCH_MAX_MSG_SIZE
+
+#include "bitbuf.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+
+using namespace cssmatch;
+
+using std::map;
+using std::ostringstream;
+using std::string;
+
+static unsigned long allocations = 0;
+
+void * operator new(size_t size) throw(std::bad_alloc)
+{
+    allocations++;
+    void * memory = malloc((size > 0) ? size : 1);
+    if (memory == NULL)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void * memory) throw()
+{
+    free(memory);
+}
+
+void * operator new[](size_t size) throw(std::bad_alloc)
+{
+    return operator new(size);
+}
+
+void operator delete[](void * memory) throw()
+{
+    operator delete(memory);
+}
+
+#define BENCH_ITERATIONS 100000
+
+/** One message kind formatted by the old and the new send path */
+struct BenchCase
+{
+    const char * name;
+    void (* legacy)(bf_write * buffer, const string & message);
+    void (* current)(bf_write * buffer, const string & message);
+};
+
+// Legacy send path: name lookup into a map, ostringstream and substr
+
+static map<string, int> legacyMessageTypes;
+
+static int legacyFindMessageType(const string & typeName)
+{
+    map<string, int>::iterator itTypeId = legacyMessageTypes.find(typeName);
+    return (itTypeId != legacyMessageTypes.end()) ? itTypeId->second : 0;
+}
+
+static void legacyChatSay(bf_write * buffer, const string & message)
+{
+    ostringstream output;
+    output << "\004[" << CSSMATCH_NAME << "]\001 " << message << "\n";
+
+    buffer->WriteByte(legacyFindMessageType("SayText"));
+    buffer->WriteString(output.str().c_str());
+}
+
+static void legacyPopupSay(bf_write * buffer, const string & message)
+{
+    int iBegin = 0;
+    int popupSize = message.size();
+    bool moreToSend = false;
+
+    do
+    {
+        string toSend = message.substr(iBegin, CSSMATCH_MAX_MSG_SIZE);
+        iBegin += CSSMATCH_MAX_MSG_SIZE;
+
+        buffer->Reset();
+        buffer->WriteByte(legacyFindMessageType("ShowMenu"));
+        moreToSend = iBegin < popupSize;
+        buffer->WriteByte(moreToSend);
+        buffer->WriteString(toSend.c_str());
+    }
+    while(moreToSend);
+}
+
+static void legacyHintSay(bf_write * buffer, const string & message)
+{
+    buffer->WriteByte(legacyFindMessageType("HintText"));
+    buffer->WriteString(message.c_str());
+}
+
+// Current send path: message type table and direct writes into the buffer
+
+static int messageTypes[USER_MESSAGE_TYPE_COUNT];
+
+static void chatSay(bf_write * buffer, const string & message)
+{
+    buffer->WriteByte(messageTypes[SAYTEXT_MSG]);
+    writeStringParts(buffer, "\004[" CSSMATCH_NAME "]\001 ", message, "\n");
+}
+
+static void popupSay(bf_write * buffer, const string & message)
+{
+    size_t iBegin = 0;
+    size_t popupSize = message.size();
+    bool moreToSend = false;
+
+    do
+    {
+        buffer->Reset();
+        buffer->WriteByte(messageTypes[SHOWMENU_MSG]);
+        moreToSend = iBegin + CSSMATCH_MAX_MSG_SIZE < popupSize;
+        buffer->WriteByte(moreToSend);
+        iBegin = writeStringSlice(buffer, message, iBegin, CSSMATCH_MAX_MSG_SIZE);
+    }
+    while(moreToSend);
+}
+
+static void hintSay(bf_write * buffer, const string & message)
+{
+    buffer->WriteByte(messageTypes[HINTTEXT_MSG]);
+    buffer->WriteString(message.c_str());
+}
+
+static void run(const BenchCase & bench, const string & message)
+{
+    char data[1024];
+    bf_write buffer(data, sizeof(data));
+
+    const char * paths[] = {"legacy", "current"};
+    for(int path = 0; path < 2; path++)
+    {
+        unsigned long before = allocations;
+        clock_t begin = clock();
+
+        for(int i = 0; i < BENCH_ITERATIONS; i++)
+        {
+            buffer.Reset();
+            if (path == 0)
+                bench.legacy(&buffer, message);
+            else
+                bench.current(&buffer, message);
+        }
+
+        double elapsed = (double)(clock() - begin) / CLOCKS_PER_SEC;
+        printf("%-8s %-8s %8.2f allocations/message %8.1f ns/message\n", bench.name, paths[path],
+               (double)(allocations - before) / BENCH_ITERATIONS,
+               elapsed * 1e9 / BENCH_ITERATIONS);
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    legacyMessageTypes["SayText"] = 3;
+    legacyMessageTypes["ShowMenu"] = 10;
+    legacyMessageTypes["HintText"] = 20;
+    messageTypes[SAYTEXT_MSG] = 3;
+    messageTypes[SHOWMENU_MSG] = 10;
+    messageTypes[HINTTEXT_MSG] = 20;
+
+    string chat = "The match will begin in 10 seconds, please stay in your team";
+    string popup;
+    for(int line = 1; line <= 9; line++)
+    {
+        popup += "->X. Some menu line with a long enough label\n";
+    }
+
+    BenchCase chatCase = {"chat", legacyChatSay, chatSay};
+    BenchCase popupCase = {"popup", legacyPopupSay, popupSay};
+    BenchCase hintCase = {"hint", legacyHintSay, hintSay};
+
+    run(chatCase, chat);
+    run(popupCase, popup);
+    run(hintCase, chat);
+
+    return 0;
+}
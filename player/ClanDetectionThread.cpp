@@ -0,0 +1,156 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "ClanDetectionThread.h"
+
+#include "../plugin/ServerPlugin.h"
+#include "../match/MatchManager.h"
+
+using namespace cssmatch;
+using namespace threading;
+
+using std::list;
+using std::string;
+using std::vector;
+
+ClanDetectionThread::ClanDetectionThread() : alive(true), resultsHead(0), resultsTail(0)
+{}
+
+bool ClanDetectionThread::popJob(ClanDetectionJob & job)
+{
+    bool found = false;
+
+    try
+    {
+        jobsMutex.lock();
+        if (! jobs.empty())
+        {
+            ClanDetectionJob & front = jobs.front();
+            job.clan = front.clan;
+            job.request = front.request;
+            job.names.swap(front.names);
+            jobs.pop_front();
+            found = true;
+        }
+        jobsMutex.unlock();
+    }
+    catch(const ThreadException & e)
+    {
+        // Retry later
+    }
+
+    return found;
+}
+
+void ClanDetectionThread::pushResult(ClanDetectionJob & job)
+{
+    unsigned int tail = resultsTail;
+
+    // Full? wait for the game thread (but don't block the plugin unload)
+    while((tail - resultsHead == CLAN_DETECTION_QUEUE_SIZE) && alive)
+        threading::sleep(10);
+
+    if (tail - resultsHead < CLAN_DETECTION_QUEUE_SIZE)
+    {
+        // Swapped, so no string buffer is shared between the threads
+        ClanDetectionJob & slot = results[tail & (CLAN_DETECTION_QUEUE_SIZE - 1)];
+        slot.clan = job.clan;
+        slot.request = job.request;
+        slot.names.swap(job.names);
+        slot.tag.swap(job.tag);
+
+        // The slot must be filled before being published
+        memoryBarrier();
+        resultsTail = tail + 1;
+    }
+}
+
+void ClanDetectionThread::run()
+{
+    ClanDetectionJob job;
+    while(alive)
+    {
+        if (popJob(job))
+        {
+            job.tag = (job.names.size() > 1) ? detector.detect(job.names) : "";
+            pushResult(job);
+        }
+        else
+            threading::sleep(10);
+    }
+}
+
+void ClanDetectionThread::end()
+{
+    alive = false;
+}
+
+void ClanDetectionThread::post(MatchClan * clan, unsigned int request, vector<string> & names)
+{
+    try
+    {
+        jobsMutex.lock();
+
+        // Only the last snapshot of a clan matters
+        list<ClanDetectionJob>::iterator itJob = jobs.begin();
+        while((itJob != jobs.end()) && (itJob->clan != clan))
+            itJob++;
+        if (itJob == jobs.end())
+            itJob = jobs.insert(jobs.end(), ClanDetectionJob());
+
+        itJob->clan = clan;
+        itJob->request = request;
+        itJob->names.swap(names);
+
+        jobsMutex.unlock();
+    }
+    catch(const ThreadException & e)
+    {
+        CSSMATCH_PRINT(e.getMessage());
+    }
+}
+
+void ClanDetectionThread::processResults()
+{
+    ServerPlugin * plugin = ServerPlugin::getInstance();
+    MatchManager * match = plugin->getMatch();
+
+    unsigned int head = resultsHead;
+    while(head != resultsTail)
+    {
+        // Read the slot only once it is published
+        memoryBarrier();
+
+        ClanDetectionJob & result = results[head & (CLAN_DETECTION_QUEUE_SIZE - 1)];
+        match->applyClanNameDetection(result.clan, result.request, result.names, result.tag);
+        result.names.clear();
+
+        // Release the slot
+        memoryBarrier();
+        head++;
+        resultsHead = head;
+    }
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __CLAN_DETECTION_THREAD_H__
+#define __CLAN_DETECTION_THREAD_H__
+
+#include "../threading/threading.h"
+#include "ClanTagDetector.h"
+
+#include <list>
+#include <string>
+#include <vector>
+
+/** Capacity of the result queue (power of two) */
+#define CLAN_DETECTION_QUEUE_SIZE 16
+
+namespace cssmatch
+{
+    class MatchClan;
+
+    /** A clan tag detection, and its result */
+    struct ClanDetectionJob
+    {
+        /** The clan concerned */
+        MatchClan * clan;
+
+        /** Request id (see MatchClan::newDetectionRequest) */
+        unsigned int request;
+
+        /** Snapshot of the member names */
+        std::vector<std::string> names;
+
+        /** The tag found */
+        std::string tag;
+
+        ClanDetectionJob() : clan(NULL), request(0){}
+    };
+
+    /** Detect the clan tags on a background thread <br>
+     * The game thread posts a snapshot of the member names, this thread runs the detection and
+     * the results come back through a lock-free single-producer/single-consumer queue, drained
+     * by the game thread which applies them (if they are still up to date).
+     */
+    class ClanDetectionThread : public threading::Thread
+    {
+    private:
+        volatile bool alive; // thread can continue?
+
+        /** Detections waiting to be done (at most one per clan) */
+        std::list<ClanDetectionJob> jobs;
+        threading::Mutex jobsMutex;
+
+        /** Result ring buffer (written by this thread, read by the game thread) */
+        ClanDetectionJob results[CLAN_DETECTION_QUEUE_SIZE];
+
+        /** Next result to read (only modified by the game thread) */
+        volatile unsigned int resultsHead;
+
+        /** Next result to write (only modified by this thread) */
+        volatile unsigned int resultsTail;
+
+        /** The detector used by this thread */
+        ClanTagDetector detector;
+
+        /** Get the next detection to do
+         * @return <code>false</code> if there is none
+         */
+        bool popJob(ClanDetectionJob & job);
+
+        /** Post a result, wait for a free slot if the queue is full */
+        void pushResult(ClanDetectionJob & job);
+    public:
+        ClanDetectionThread();
+
+        /**
+         * @see threading::Thread
+         */
+        void run();
+
+        /** Tell to the thread that it must exit */
+        void end();
+
+        /** Post a detection (game thread only) <br>
+         * A detection still pending for the same clan is replaced
+         * @param clan The clan
+         * @param request The request id
+         * @param names Snapshot of the member names (swapped)
+         */
+        void post(MatchClan * clan, unsigned int request, std::vector<std::string> & names);
+
+        /** Pop the results and give them to the match (game thread only) */
+        void processResults();
+    };
+}
+
+#endif // __CLAN_DETECTION_THREAD_H__
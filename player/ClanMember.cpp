@@ -31,8 +31,6 @@ using namespace cssmatch;
 using std::list;
 using std::string;
 
-EntityProp ClanMember::ownerHandler("CBaseCombatWeapon", "m_hOwner");
-
 ClanMember::ClanMember(int index, bool ref) : Player(index), referee(ref)
 {}
 
@@ -53,42 +51,8 @@ PlayerScore * ClanMember::getCurrentScore()
 
 void ClanMember::saveState(PlayerState * state)
 {
-    /*ServerPlugin * plugin = ServerPlugin::getInstance();
-    ValveInterfaces * interfaces = plugin->getInterfaces();
-
-    // Get the handle id of this player
-    IHandleEntity * handle = identity.pEntity->GetNetworkable()->GetEntityHandle();
-    const CBaseHandle & bHandle = handle->GetRefEHandle();
-    int handleid = bHandle.ToInt();
-
-    state->objects.clear();
-
-    // FIXME: Ouch! (playercount * entitycount) iterations!
-    for (int i = interfaces->gpGlobals->maxClients + 1; i < interfaces->engine->GetEntityCount(); i++)
-    {
-        edict_t * entity = interfaces->engine->PEntityOfEntIndex(i);
-        if (isValidEntity(entity))
-        {
-            int tempHandleid = entity->GetNetworkable()->GetEntityHandle()->GetRefEHandle().ToInt();
-
-            if ((strstr(entity->GetClassName(),"item_") != NULL) ||
-                (strstr(entity->GetClassName(),"weapon_") != NULL))
-            {
-                if (ownerHandler.getProp<int>(entity) == handleid)
-                {
-                    state->objects.push_back(entity->GetClassName());
-                }
-            }
-        }
-    }*/
-
     state->score.deaths = currentScore.deaths;
     state->score.kills = currentScore.kills;
-
-    /*state->account = getAccount();*/
-
-    //state->vecOrigin = getVecOrigin();
-    //state->angle = getViewAngle();
 }
 
 void ClanMember::restoreState(PlayerState * state)
@@ -96,21 +60,6 @@ void ClanMember::restoreState(PlayerState * state)
     currentScore.deaths = state->score.deaths;
     currentScore.kills = state->score.kills;
 
-    /*if (state->account > -1)
-        setAccount(state->account);*/
-
-    /*list<string>::const_iterator itObject;
-    for(itObject = state->objects.begin(); itObject != state->objects.end(); itObject++)
-    {
-        give(*itObject);
-    }*/
-
-    /*if (state->vecOrigin.IsValid())
-        setVecOrigin(state->vecOrigin);*/
-
-    /*if (state->angle.IsValid())
-        setang(state->angle);*/
-
     // TODO: Restore the kills/deaths in the scoreboard ?
 }
 
@@ -46,24 +46,12 @@ namespace cssmatch
         PlayerScore() : kills(0), deaths(0){}
     };
 
-    /** Player state (used when the round restarts) */
+    /** Player state (used when the round restarts) <br>
+     * The money, weapons and position are saved by RoundStateBuffer
+     */
     struct PlayerState
     {
         PlayerScore score;
-
-        //int account;
-
-        /* Weapons and items the player owns */
-        //std::list<std::string> objects;
-
-        /* Player coords */
-        //Vector vecOrigin;
-
-        /* Player angle */
-        //QAngle angle;
-
-        //PlayerState()
-        //	: account(0){}
     };
 
     /** CSSMatch player */
@@ -82,9 +70,6 @@ namespace cssmatch
         /** Is this player a referee (admin)? */
         bool referee;
 
-        /** Entity prop used to know who owns an object */
-        static EntityProp ownerHandler;
-
         // Functors
         friend struct ResetClanMember;
         friend struct SaveHalfPlayerState;
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "ClanTagDetector.h"
+
+using namespace cssmatch;
+
+using std::string;
+using std::vector;
+
+size_t ClanTagDetector::findSlot(int state, unsigned char character) const
+{
+    size_t slot = ((unsigned int)state * 2654435761u + character) & edgeTableMask;
+    while(edgeTable[slot] != -1)
+    {
+        const Edge & edge = edges[edgeTable[slot]];
+        if ((edge.character == character) && (edge.source == state))
+            break;
+        slot = (slot + 1) & edgeTableMask;
+    }
+    return slot;
+}
+
+int ClanTagDetector::getTransition(int state, unsigned char character) const
+{
+    int edge = edgeTable[findSlot(state, character)];
+    return (edge != -1) ? edges[edge].target : -1;
+}
+
+void ClanTagDetector::setTransition(int state, unsigned char character, int target)
+{
+    size_t slot = findSlot(state, character);
+    if (edgeTable[slot] != -1)
+        edges[edgeTable[slot]].target = target;
+    else
+    {
+        Edge newEdge;
+        newEdge.character = character;
+        newEdge.source = state;
+        newEdge.target = target;
+        newEdge.next = states[state].firstEdge;
+        states[state].firstEdge = (int)edges.size();
+        edgeTable[slot] = (int)edges.size();
+        edges.push_back(newEdge);
+    }
+}
+
+int ClanTagDetector::addState(int length, int link, int name, int end)
+{
+    State state;
+    state.length = length;
+    state.link = link;
+    state.firstEdge = -1;
+    state.count = 0;
+    state.lastName = -1;
+    state.name = name;
+    state.end = end;
+
+    states.push_back(state);
+    return (int)states.size() - 1;
+}
+
+int ClanTagDetector::cloneState(int state, int length)
+{
+    int clone = addState(length, states[state].link, states[state].name, states[state].end);
+
+    // Note: setTransition can reallocate edges, so no reference is kept
+    int edge = states[state].firstEdge;
+    while(edge != -1)
+    {
+        setTransition(clone, edges[edge].character, edges[edge].target);
+        edge = edges[edge].next;
+    }
+
+    return clone;
+}
+
+int ClanTagDetector::extend(int last, unsigned char character, int name, int end)
+{
+    int existing = getTransition(last, character);
+    if (existing != -1)
+    {
+        // This prefix is already known (common to a previous name)
+        if (states[last].length + 1 == states[existing].length)
+            return existing;
+
+        int clone = cloneState(existing, states[last].length + 1);
+        int state = last;
+        while((state != -1) && (getTransition(state, character) == existing))
+        {
+            setTransition(state, character, clone);
+            state = states[state].link;
+        }
+        states[existing].link = clone;
+        return clone;
+    }
+
+    int current = addState(states[last].length + 1, 0, name, end);
+    int state = last;
+    while((state != -1) && (getTransition(state, character) == -1))
+    {
+        setTransition(state, character, current);
+        state = states[state].link;
+    }
+
+    if (state != -1)
+    {
+        int next = getTransition(state, character);
+        if (states[state].length + 1 == states[next].length)
+            states[current].link = next;
+        else
+        {
+            int clone = cloneState(next, states[state].length + 1);
+            while((state != -1) && (getTransition(state, character) == next))
+            {
+                setTransition(state, character, clone);
+                state = states[state].link;
+            }
+            states[next].link = clone;
+            states[current].link = clone;
+        }
+    }
+
+    return current;
+}
+
+string ClanTagDetector::detect(const vector<string> & names)
+{
+    int nameCount = (int)names.size();
+
+    // An automaton has less than 2n states and 3n transitions, n being the total length
+    size_t totalLength = 0;
+    for(int iName = 0; iName < nameCount; iName++)
+        totalLength += names[iName].size();
+
+    size_t tableSize = 64;
+    while(tableSize < totalLength * 6)
+        tableSize <<= 1;
+    edgeTable.assign(tableSize, -1);
+    edgeTableMask = tableSize - 1;
+
+    states.clear();
+    edges.clear();
+    addState(0, -1, -1, -1);
+
+    // Build the automaton
+    for(int iName = 0; iName < nameCount; iName++)
+    {
+        const string & name = names[iName];
+        int last = 0;
+        for(int i = 0; i < (int)name.size(); i++)
+        {
+            last = extend(last, (unsigned char)name[i], iName, i);
+        }
+    }
+
+    // Count the names containing each state: each prefix of a name ends in a state whose
+    // suffix links lead to all the suffixes of this prefix
+    for(int iName = 0; iName < nameCount; iName++)
+    {
+        const string & name = names[iName];
+        int state = 0;
+        for(int i = 0; i < (int)name.size(); i++)
+        {
+            state = getTransition(state, (unsigned char)name[i]);
+
+            int suffix = state;
+            while((suffix > 0) && (states[suffix].lastName != iName))
+            {
+                states[suffix].lastName = iName;
+                states[suffix].count++;
+                suffix = states[suffix].link;
+            }
+        }
+    }
+
+    // Elect the longest substring shared by a majority
+    int majority = nameCount / 2;
+    int best = -1;
+    for(int i = 1; i < (int)states.size(); i++)
+    {
+        const State & state = states[i];
+        if ((state.count > majority) && (state.length >= CLAN_TAG_MIN_LENGTH))
+        {
+            // On a tie, prefer the earliest name/position recorded, so the result is stable
+            if ((best == -1) || (state.length > states[best].length) ||
+                ((state.length == states[best].length) &&
+                 ((state.name < states[best].name) ||
+                  ((state.name == states[best].name) && (state.end < states[best].end)))))
+                best = i;
+        }
+    }
+
+    string tag;
+    if (best != -1)
+    {
+        const State & state = states[best];
+        tag = names[state.name].substr(state.end - state.length + 1, state.length);
+    }
+    return tag;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __CLAN_TAG_DETECTOR_H__
+#define __CLAN_TAG_DETECTOR_H__
+
+#include <string>
+#include <vector>
+
+/** Minimum length of a detected clan tag */
+#define CLAN_TAG_MIN_LENGTH 3
+
+namespace cssmatch
+{
+    /** Find the longest substring shared by a majority of player names <br>
+     * Builds a generalized suffix automaton of the names, then counts for each state how many
+     * names contain it. The cost is linear in the total length of the names (instead of
+     * comparing each pair of names). <br>
+     * The buffers are kept between two detections.
+     */
+    class ClanTagDetector
+    {
+    protected:
+        /** Automaton transition, in a linked list per state (used to copy the transitions) */
+        struct Edge
+        {
+            unsigned char character;
+            int source;
+            int target;
+            int next;
+        };
+
+        /** Automaton state (a set of substrings with the same occurrences) */
+        struct State
+        {
+            /** Length of the longest substring of this state */
+            int length;
+
+            /** Suffix link */
+            int link;
+
+            /** First transition */
+            int firstEdge;
+
+            /** Number of names containing this state */
+            int count;
+
+            /** Last name counted */
+            int lastName;
+
+            /** One occurrence: name index and end position */
+            int name;
+            int end;
+        };
+
+        std::vector<State> states;
+        std::vector<Edge> edges;
+
+        /** Open addressing table {(state, character) => edge index} */
+        std::vector<int> edgeTable;
+
+        /** edgeTable size - 1 (the size is a power of two) */
+        size_t edgeTableMask;
+
+        /** Find the slot of a transition in edgeTable (empty slot if not found) */
+        size_t findSlot(int state, unsigned char character) const;
+
+        /** Get the transition of a state, or -1 */
+        int getTransition(int state, unsigned char character) const;
+
+        /** Set (or replace) the transition of a state */
+        void setTransition(int state, unsigned char character, int target);
+
+        /** Create a state */
+        int addState(int length, int link, int name, int end);
+
+        /** Copy a state and its transitions */
+        int cloneState(int state, int length);
+
+        /** Add a character to the automaton
+         * @param last The state of the current prefix
+         * @return The state of the new prefix
+         */
+        int extend(int last, unsigned char character, int name, int end);
+    public:
+        /** Find the longest substring (at least CLAN_TAG_MIN_LENGTH characters long) contained in
+         * more than half of the names
+         * @param names The names (an empty name counts as a member without any tag)
+         * @return The substring, or an empty string if none
+         */
+        std::string detect(const std::vector<std::string> & names);
+    };
+}
+
+#endif // __CLAN_TAG_DETECTOR_H__
@@ -40,44 +40,12 @@ using std::string;
 using std::list;
 using std::ostringstream;
 using std::map;
+using std::vector;
 
-MatchClan::MatchClan() : name("Nobody"), allowAutoDetect(true), ready(false)
+MatchClan::MatchClan() : name("Nobody"), allowAutoDetect(true), ready(false), detectionCached(false),
+    detectionRequest(0)
 {}
 
-// I'm static
-bool MatchClan::isValidClanName(const string & newName, const list<ClanMember *> & memberlist)
-{
-    bool valid = false;
-
-    if (newName.size() >= 3)
-    {
-        int majority = memberlist.size() / 2;
-        int occurences = 0;
-
-        list<ClanMember *>::const_iterator itMember = memberlist.begin();
-        while(itMember != memberlist.end())
-        {
-            IPlayerInfo * pInfo = (*itMember)->getPlayerInfo();
-            if (isValidPlayerInfo(pInfo))
-            {
-                string name = pInfo->GetName();
-                if (name.find(newName) != string::npos)
-                {
-                    occurences++;
-                    if (occurences > majority)
-                    {
-                        valid = true;
-                        break;
-                    }
-                }
-            }
-            itMember++;
-        }
-    }
-
-    return valid;
-}
-
 const string * MatchClan::getName() const
 {
     return &name;
@@ -89,31 +57,22 @@ void MatchClan::setName(const string & newName, bool forbidAutoDetect)
     allowAutoDetect = (! forbidAutoDetect);
 }
 
-void MatchClan::getMembers(list<ClanMember *> * members)
+const PlayerList * MatchClan::getMembers()
 {
     ServerPlugin * plugin = ServerPlugin::getInstance();
     MatchManager * match = plugin->getMatch();
 
+    TeamCode team = INVALID_TEAM;
     try
     {
-        TeamCode team = (match->getClan(CT_TEAM) == this) ? CT_TEAM : T_TEAM;
-
-        list<ClanMember *> * playerlist = plugin->getPlayerlist();
-        list<ClanMember *>::iterator itMembers;
-        for(itMembers = playerlist->begin(); itMembers != playerlist->end(); itMembers++)
-        {
-            //Msg("%i team%i\n",(*itMembers)->getIdentity()->userid,(*itMembers)->getMyTeam());
-            if ((*itMembers)->getMyTeam() == team)
-            {
-                members->push_back((*itMembers));
-                //Msg("=>> added\n");
-            }
-        }
+        team = (match->getClan(CT_TEAM) == this) ? CT_TEAM : T_TEAM;
     }
     catch(const MatchManagerException & e)
     {
         CSSMATCH_PRINT_EXCEPTION(e);
     }
+
+    return plugin->getTeamMembers(team);
 }
 
 ClanStats * MatchClan::getLastHalfState()
@@ -137,6 +96,8 @@ void MatchClan::reset()
     ready = false;
     setAllowDetection(true);
     name = "Nobody";
+    detectionCached = false;
+    detectionRequest++; // pending detections are outdated
 }
 
 void MatchClan::setAllowDetection(bool allow)
@@ -144,170 +105,117 @@ void MatchClan::setAllowDetection(bool allow)
     allowAutoDetect = allow;
 }
 
-void MatchClan::detectClanName(bool force)
+void MatchClan::applyDetection()
 {
-    // This function looks complex
-    // Actually, the clan tag should be found very fast in most cases
+    switch(detectedNames.size())
+    {
+    case 0:     // no player
+        setName("Nobody");
+        break;
+    case 1:     // 1 player
+        if (! detectedNames.front().empty())
+            setName(detectedNames.front());
+        else
+            setName("Nobody");
+        break;
+    default:     // at least 2 players
+        if (! detectedTag.empty())
+        {
+            string newName = detectedTag;
+            ConfigurationFile::trim(newName);
+            setName(newName);
+        }
+        // If no coherent name was found, we set a neutral name
+        else if (! detectedNames.front().empty())
+        {
+            ostringstream buffer;
+            buffer << detectedNames.front() << "'s clan";
+            setName(buffer.str());
+        }
+        else
+        {
+            setName("Nobody");
+            CSSMATCH_PRINT("Failed to find a clan name")
+        }
+    }
+}
 
+void MatchClan::detectClanName(bool force)
+{
     if (allowAutoDetect || force)
     {
-        ServerPlugin * plugin = ServerPlugin::getInstance();
-        ValveInterfaces * interfaces = plugin->getInterfaces();
+        // Find the longest part of name shared by a majority of members
+        // The detection is done again only if the roster or a name changed
 
-        list<ClanMember *> memberlist;
-        getMembers(&memberlist);
+        vector<string> names;
+        getMemberNames(names);
 
-        list<ClanMember *>::const_iterator itMember = memberlist.begin();
-        int majority = memberlist.size()  / 2;
-
-/*		// First, try elect the most used steam clan tag
-
-        map<string,int> tagStats; // clan tag => occurrences
-        string mostUsed; // most
-        while(itMember != memberlist.end())
+        if (! isDetectionCached(names))
         {
-            const char * community = "";
+            detectedTag = (names.size() > 1) ? tagDetector.detect(names) : "";
+            detectedNames.swap(names);
+            detectionCached = true;
+        }
 
-            IPlayerInfo * pInfo = (*itMember)->getPlayerInfo();
-            if (isValidPlayerInfo(pInfo) && (! pInfo->IsFakeClient()))
-                community = interfaces->engine->GetClientConVarValue((*itMember)->getIdentity()->index,"cl_clantag");
+        applyDetection();
+    }
+}
 
-            int occurences = ++tagStats[community];
-            if (tagStats[mostUsed] < occurences)
-                mostUsed = community;
+bool MatchClan::isDetectionAllowed() const
+{
+    return allowAutoDetect;
+}
 
-            if (occurences > majority)
-                break;
+void MatchClan::getMemberNames(vector<string> & names)
+{
+    ServerPlugin * plugin = ServerPlugin::getInstance();
+    const PlayerList * memberlist = getMembers();
 
-            itMember++;
-        }
+    names.clear();
+    names.reserve(memberlist->size());
 
-        if (! mostUsed.empty())
-            setName(mostUsed);
+    PlayerList::const_iterator itMember;
+    for(itMember = memberlist->begin(); itMember != memberlist->end(); itMember++)
+    {
+        const PlayerSnapshot * snapshot =
+            plugin->getPlayerSnapshot((*itMember)->getIdentity()->index);
+        if ((snapshot != NULL) && snapshot->valid)
+            names.push_back(snapshot->name);
         else
-        {
-            // Without steam clan tag, try to guess a clan name*/
+            names.push_back(""); // still counts in the majority
+    }
+}
 
-        switch(memberlist.size())
-        {
-        case 0:     // no player
-            setName("Nobody");
-            break;
-        case 1:     // 1 player
-        {
-            IPlayerInfo * pInfo = memberlist.front()->getPlayerInfo();
-            if (isValidPlayerInfo(pInfo))
-            {
-                setName(pInfo->GetName());
-            }
-            else
-                setName("Nobody");
-            break;
-        }
-        default:     // at least 2 players
+bool MatchClan::isDetectionCached(const vector<string> & names) const
+{
+    return detectionCached && (names == detectedNames);
+}
+
+unsigned int MatchClan::newDetectionRequest()
+{
+    return ++detectionRequest;
+}
+
+bool MatchClan::setDetection(unsigned int request, vector<string> & names, const string & tag)
+{
+    bool applied = false;
+
+    if ((request == detectionRequest) && allowAutoDetect)
+    {
+        vector<string> currentNames;
+        getMemberNames(currentNames);
+        if (currentNames == names)
         {
-            // 1. Get two members
-            // 2. Get their names
-            // 3. Accumulate consecutive/common characters until we find a clan name that satisfies
-            // isValidClanName
-            // 4. If no valid name was found, continue with two other members
-
-            bool foundName = false;         // true if a new clan name was found
-            int iMember = 0;
-
-            // 1.
-            itMember = memberlist.begin();
-            while((iMember <= majority) && (! foundName))
-            {
-                list<ClanMember *>::const_iterator itMember2 = itMember;
-                itMember2++;
-                while(itMember2 != memberlist.end() && (! foundName))
-                {
-                    ClanMember * member1 = *itMember;
-                    ClanMember * member2 = *itMember2;
-
-                    // 2.
-                    IPlayerInfo * pInfo1 = member1->getPlayerInfo();
-                    IPlayerInfo * pInfo2 = member2->getPlayerInfo();
-                    if (isValidPlayerInfo(pInfo1) && isValidPlayerInfo(pInfo2))
-                    {
-                        string memberName1 = pInfo1->GetName();
-                        string memberName2 = pInfo2->GetName();
-
-                        // 3.
-                        string newName;         // new clan name
-                        string::const_iterator itMemberName1 = memberName1.begin();
-                        string::const_iterator endMemberName1 = memberName1.end();
-                        string::const_iterator endMemberName2 = memberName2.end();
-
-                        // For each character of member1
-                        //	Is a character common to a character of member2?
-                        //		Try to accumulate all consecutive/common characters
-                        //		Is the clan name coherent?
-                        //			Found a new clan name!
-                        //	Otherwise continue
-                        while(itMemberName1 != endMemberName1)
-                        {
-                            string::const_iterator itMemberName2 = memberName2.begin();
-                            while((itMemberName1 != endMemberName1) &&
-                                  (itMemberName2 != endMemberName2))
-                            {
-                                // (itMemberName1 may changes here)
-
-                                if ((*itMemberName1) == (*itMemberName2))
-                                {         // Found a common character
-                                    newName += *itMemberName1;
-
-                                    itMemberName1++;
-                                    //itMemberName2++; // see below
-                                }
-                                else if (MatchClan::isValidClanName(newName, memberlist))
-                                {         // Found a coherent clan name
-                                    ConfigurationFile::trim(newName);
-                                    setName(newName);
-                                    foundName = true;
-
-                                    // Break the two last while
-                                    itMemberName1 = endMemberName1 - 1;
-                                    itMemberName2 = endMemberName2 - 1;
-                                }
-                                else
-                                    newName = "";
-
-                                itMemberName2++;
-                            }
-
-                            if (itMemberName1 != endMemberName1)
-                                itMemberName1++;
-                        }
-                    }
-
-                    itMember2++;
-                }
-                itMember++;
-                iMember++;
-            }
-
-            // If no coherent name was found, we set a neutral name
-            if (! foundName)
-            {
-                IPlayerInfo * pInfo = memberlist.front()->getPlayerInfo();
-                if (isValidPlayerInfo(pInfo))
-                {
-                    ostringstream buffer;
-                    buffer << pInfo->GetName() << "'s clan";
-                    setName(buffer.str());
-                }
-                else
-                {
-                    setName("Nobody");
-                    CSSMATCH_PRINT("Failed to find a clan name")
-                }
-            }
-        }
+            detectedNames.swap(names);
+            detectedTag = tag;
+            detectionCached = true;
+
+            applyDetection();
+            applied = true;
         }
-        /*}*/
     }
+
+    return applied;
 }
 
 bool MatchClan::isReady() const
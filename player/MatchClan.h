@@ -28,9 +28,12 @@
 #define __MATCH_CLAN_H__
 
 #include "Player.h"
+#include "PlayerRegistry.h"
+#include "ClanTagDetector.h"
 
 #include <string>
 #include <list>
+#include <vector>
 
 namespace cssmatch
 {
@@ -67,12 +70,23 @@ namespace cssmatch
         /** Is the clan ready to end the warmup time? */
         bool ready;
 
-        /** Valid a clan name (used when the clan name is automatically detected)
-         * @param newName Clan name to test
-         * @param memberlist Clan members
-         */
-        static bool isValidClanName(const std::string & newName,
-                                    const std::list<ClanMember *> & memberlist);
+        /** Clan tag detection */
+        ClanTagDetector tagDetector;
+
+        /** Member names used by the last detection */
+        std::vector<std::string> detectedNames;
+
+        /** Tag found by the last detection (empty if none) */
+        std::string detectedTag;
+
+        /** Are detectedNames/detectedTag valid? */
+        bool detectionCached;
+
+        /** Id of the last detection request (the results of the previous requests are outdated) */
+        unsigned int detectionRequest;
+
+        /** Set the clan name from the last detection */
+        void applyDetection();
     public:
         MatchClan();
 
@@ -85,8 +99,8 @@ namespace cssmatch
          */
         void setName(const std::string & newName, bool forbidAutoDetect = false);
 
-        /** Fill a list with the players of this clan */
-        void getMembers(std::list<ClanMember *> * members);
+        /** Get the players of this clan (read from the current frame snapshot) */
+        const PlayerList * getMembers();
 
         /** Get the clan stats of the previous half */
         ClanStats * getLastHalfState();
@@ -107,6 +121,32 @@ namespace cssmatch
          */
         void detectClanName(bool force);
 
+        /** Can the clan name be automatically detected? */
+        bool isDetectionAllowed() const;
+
+        /** Get the names of the members, read from the current frame snapshot <br>
+         * The name of a member without valid player info is empty
+         */
+        void getMemberNames(std::vector<std::string> & names);
+
+        /** Is the detection for these member names already done? */
+        bool isDetectionCached(const std::vector<std::string> & names) const;
+
+        /** Start a new detection request (e.g. done by another thread)
+         * @return The request id
+         */
+        unsigned int newDetectionRequest();
+
+        /** Use the result of a detection request, unless it is outdated
+         * @param request The request id
+         * @param names The member names used by the detection (swapped)
+         * @param tag The tag found (see ClanTagDetector)
+         * @return <code>false</code> if the result was discarded because a newer request was
+         * made, the roster or a name changed, or the detection is no longer allowed
+         */
+        bool setDetection(unsigned int request, std::vector<std::string> & names,
+                          const std::string & tag);
+
         /** Is the clan ready to end the warmup time? */
         bool isReady() const;
 
@@ -25,6 +25,7 @@
  */
 
 #include "Player.h"
+#include "../entity/EntityPropBatch.h"
 #include "../plugin/ServerPlugin.h"
 #include "../messages/Menu.h"
 
@@ -38,9 +39,9 @@ using std::string;
 using std::map;
 using std::ostringstream;
 
-EntityProp Player::accountHandler("CCSPlayer", "m_iAccount");
-EntityProp Player::lifeStateHandler("CBasePlayer", "m_lifeState");
-EntityProp Player::playerStateHandler("CCSPlayer", "m_iPlayerState");
+TypedEntityProp<int> Player::accountHandler("CCSPlayer", "m_iAccount");
+TypedEntityProp<int> Player::lifeStateHandler("CBasePlayer", "m_lifeState");
+TypedEntityProp<int> Player::playerStateHandler("CCSPlayer", "m_iPlayerState");
 //EntityProp
 // Player::vecOriginHandler("CCSPlayer","baseclass.baseclass.baseclass.baseclass.baseclass.baseclass.m_vecOrigin");
 //EntityProp Player::angRotationHandler("CBaseEntity","m_angRotation");
@@ -48,7 +49,8 @@ EntityProp Player::playerStateHandler("CCSPlayer", "m_iPlayerState");
 //EntityProp Player::eyeAngles1Handler("CCSPlayer","m_angEyeAngles[1]");
 //EntityProp Player::armorHandler("CCSPlayer","m_ArmorValue");
 
-Player::Player(int index) throw (PlayerException) : lastCommandDate(0.0f), menuTimer(NULL)
+Player::Player(int index) throw (PlayerException)
+    : lastCommandDate(0.0f), languageId(0), menuTimer(NULL)
 {
     ServerPlugin * plugin = ServerPlugin::getInstance();
     ValveInterfaces * interfaces = plugin->getInterfaces();
@@ -71,6 +73,8 @@ Player::Player(int index) throw (PlayerException) : lastCommandDate(0.0f), menuT
             "The plugin was unable to construct a Player instance => player steamid not found");
     else
         identity.steamid = tempSteamid;
+
+    updateLanguage();
 }
 
 Player::~Player()
@@ -85,6 +89,25 @@ PlayerIdentity * Player::getIdentity()
     return &identity;
 }
 
+int Player::getLanguageId() const
+{
+    return languageId;
+}
+
+void Player::updateLanguage()
+{
+    ServerPlugin * plugin = ServerPlugin::getInstance();
+    ValveInterfaces * interfaces = plugin->getInterfaces();
+    I18nManager * i18n = plugin->getI18nManager();
+
+    if (i18n != NULL)
+    {
+        const char * language = interfaces->engine->GetClientConVarValue(identity.index,
+                                                                         "cl_language");
+        languageId = i18n->getLanguageId((language != NULL) ? language : "");
+    }
+}
+
 bool Player::canUseCommand()
 {
     ServerPlugin * plugin = ServerPlugin::getInstance();
@@ -240,16 +263,13 @@ IPlayerInfo * Player::getPlayerInfo() const
 void Player::kick(const string & reason) const
 {
     ServerPlugin * plugin = ServerPlugin::getInstance();
-    ValveInterfaces * interfaces = plugin->getInterfaces();
     I18nManager * i18n = plugin->getI18nManager();
 
     string textReason;
 
     IPlayerInfo * pInfo = getPlayerInfo();
     if (isValidPlayerInfo(pInfo) && (! pInfo->IsFakeClient()))
-        textReason =
-            i18n->getTranslation(interfaces->engine->GetClientConVarValue(identity.index,
-                                                                          "cl_language"), reason);
+        textReason = i18n->getTranslation(languageId, I18nKeyword(reason));
     else
         textReason = "Kick bot";
 
@@ -311,6 +331,9 @@ bool Player::swap(/*bool respawn*/)
         }
     }
 
+    if (success)
+        plugin->invalidatePlayerSnapshot();
+
     return success;
 }
 
@@ -322,7 +345,10 @@ bool Player::spec()
     if (isValidPlayerInfo(pInfo))
     {
         if (pInfo->GetTeamIndex() != SPEC_TEAM)
+        {
             pInfo->ChangeTeam((int)SPEC_TEAM);
+            ServerPlugin::getInstance()->invalidatePlayerSnapshot();
+        }
         else
             success = false;
     }
@@ -350,7 +376,7 @@ void Player::setAccount(int newCash)
 {
     try
     {
-        accountHandler.getProp<int>(identity.pEntity) = newCash;
+        accountHandler.get(identity.pEntity) = newCash;
     }
     catch(const EntityPropException & e)
     {
@@ -364,7 +390,7 @@ int Player::getAccount()
 
     try
     {
-        account = accountHandler.getProp<int>(identity.pEntity);
+        account = accountHandler.get(identity.pEntity);
     }
     catch(const EntityPropException & e)
     {
@@ -378,7 +404,7 @@ void Player::setLifeState(int newState)
 {
     try
     {
-        lifeStateHandler.getProp<int>(identity.pEntity) = newState;
+        lifeStateHandler.get(identity.pEntity) = newState;
     }
     catch(const EntityPropException & e)
     {
@@ -392,7 +418,7 @@ int Player::getLifeState()
 
     try
     {
-        lifeState = lifeStateHandler.getProp<int>(identity.pEntity);
+        lifeState = lifeStateHandler.get(identity.pEntity);
     }
     catch(const EntityPropException & e)
     {
@@ -406,7 +432,7 @@ void Player::setPlayerState(int newState)
 {
     try
     {
-        playerStateHandler.getProp<int>(identity.pEntity) = newState;
+        playerStateHandler.get(identity.pEntity) = newState;
     }
     catch(const EntityPropException & e)
     {
@@ -420,7 +446,7 @@ int Player::getPlayerState()
 
     try
     {
-        playerState  = playerStateHandler.getProp<int>(identity.pEntity);
+        playerState  = playerStateHandler.get(identity.pEntity);
     }
     catch(const EntityPropException & e)
     {
@@ -430,6 +456,21 @@ int Player::getPlayerState()
     return playerState;
 }
 
+void Player::readProps(edict_t * const * entities, int count, int * account, int * lifeState,
+                       int * playerState)
+{
+    static EntityPropBatch batch;
+    if (batch.getSize() == 0)
+    {
+        batch.add(&accountHandler);
+        batch.add(&lifeStateHandler);
+        batch.add(&playerStateHandler);
+    }
+
+    int * columns[] = {account, lifeState, playerState};
+    batch.read(entities, count, columns);
+}
+
 /*void Player::setVecOrigin(const Vector & vec)
 {*/
 /*try
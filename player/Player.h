@@ -137,10 +137,15 @@ namespace cssmatch
         /** Last date when the player sent a command to the server  */
         float lastCommandDate;
 
+        /** Id of the player's language (cl_language)
+         * @see I18nManager::getLanguageId
+         */
+        int languageId;
+
         // Entity prop handler
-        static EntityProp accountHandler;
-        static EntityProp lifeStateHandler;
-        static EntityProp playerStateHandler;
+        static TypedEntityProp<int> accountHandler;
+        static TypedEntityProp<int> lifeStateHandler;
+        static TypedEntityProp<int> playerStateHandler;
         //static EntityProp vecOriginHandler;
         //static EntityProp angRotationHandler;
         //static EntityProp eyeAngles0Handler;
@@ -166,6 +171,16 @@ namespace cssmatch
          */
         PlayerIdentity * getIdentity();
 
+        /** Get the id of the language used by this player
+         * @see I18nManager::getLanguageId
+         */
+        int getLanguageId() const;
+
+        /** Query the engine for the player's cl_language and memorize the corresponding id <br>
+         * Called when the player is constructed and when his settings change
+         */
+        void updateLanguage();
+
         // Anti-flood
         /** Determines if the player is allowed to use a command then update <br>
          * Update the last command date
@@ -270,6 +285,16 @@ namespace cssmatch
         /** Get the player state (returns -1 if it fails) */
         int getPlayerState();
 
+        /** Read the account, life state and player state of several players in one pass
+         * @param entities The players entities
+         * @param count The number of players
+         * @param account Receives the accounts (-1 if it fails)
+         * @param lifeState Receives the life states (-1 if it fails)
+         * @param playerState Receives the player states (-1 if it fails)
+         */
+        static void readProps(edict_t * const * entities, int count, int * account,
+                              int * lifeState, int * playerState);
+
         /* Set the player location */
         //void setVecOrigin(const Vector & vec);
         /* Get the player location (x,y,z are VEC_T_NAN if it fails) */
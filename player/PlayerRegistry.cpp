@@ -0,0 +1,251 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "PlayerRegistry.h"
+#include "ClanMember.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace cssmatch;
+
+using std::string;
+using std::find;
+using std::strcmp;
+
+void PlayerRegistry::refreshSnapshot()
+{
+    if (! snapshotValid)
+    {
+        for(int i = 0; i <= CT_TEAM; i++)
+        {
+            teams[i].clear();
+        }
+        hltvConnected = false;
+
+        PlayerList::const_iterator itPlayer;
+        for(itPlayer = players.begin(); itPlayer != players.end(); itPlayer++)
+        {
+            PlayerSnapshot & snapshot = snapshots[(*itPlayer)->getIdentity()->index];
+
+            IPlayerInfo * pInfo = (*itPlayer)->getPlayerInfo();
+
+            // isValidPlayerInfo excludes SourceTv
+            snapshot.hltv = (pInfo != NULL) && pInfo->IsConnected() && pInfo->IsHLTV();
+            hltvConnected |= snapshot.hltv;
+
+            snapshot.valid = isValidPlayerInfo(pInfo);
+            if (snapshot.valid)
+            {
+                snapshot.team = (TeamCode)pInfo->GetTeamIndex();
+                snapshot.alive = ! pInfo->IsDead();
+                snapshot.bot = pInfo->IsFakeClient();
+                snapshot.name = pInfo->GetName();
+
+                if ((snapshot.team >= UN_TEAM) && (snapshot.team <= CT_TEAM))
+                    teams[snapshot.team].push_back(*itPlayer);
+            }
+            else
+            {
+                snapshot.team = INVALID_TEAM;
+                snapshot.alive = false;
+                snapshot.bot = false;
+                snapshot.name.clear();
+            }
+        }
+
+        // The game applies the new team after player_team, rebuild on each read until then
+        snapshotValid = ! teamChangePending;
+    }
+}
+
+PlayerRegistry::PlayerRegistry()
+    : hltvConnected(false), snapshotValid(false), teamChangePending(false)
+{
+    for(int i = 0; i <= ABSOLUTE_PLAYER_LIMIT; i++)
+    {
+        slots[i] = NULL;
+    }
+    players.reserve(ABSOLUTE_PLAYER_LIMIT);
+    for(int i = 0; i <= CT_TEAM; i++)
+    {
+        teams[i].reserve(ABSOLUTE_PLAYER_LIMIT);
+    }
+}
+
+void PlayerRegistry::add(ClanMember * player)
+{
+    PlayerIdentity * identity = player->getIdentity();
+
+    if ((identity->index > 0) && (identity->index <= ABSOLUTE_PLAYER_LIMIT))
+    {
+        slots[identity->index] = player;
+        players.push_back(player);
+        byUserid.insert(identity->userid, player);
+        bySteamid.insert(identity->steamid, player);
+
+        snapshotValid = false;
+    }
+}
+
+void PlayerRegistry::remove(ClanMember * player)
+{
+    PlayerIdentity * identity = player->getIdentity();
+
+    if ((identity->index > 0) && (identity->index <= ABSOLUTE_PLAYER_LIMIT) &&
+        (slots[identity->index] == player))
+    {
+        slots[identity->index] = NULL;
+        byUserid.erase(identity->userid, player);
+        bySteamid.erase(identity->steamid, player);
+
+        // Keep the join order, the list is small
+        PlayerList::iterator itPlayer = find(players.begin(), players.end(), player);
+        if (itPlayer != players.end())
+            players.erase(itPlayer);
+
+        snapshotValid = false;
+    }
+}
+
+void PlayerRegistry::clear()
+{
+    for(int i = 0; i <= ABSOLUTE_PLAYER_LIMIT; i++)
+    {
+        slots[i] = NULL;
+    }
+    players.clear();
+    byUserid.clear();
+    bySteamid.clear();
+    snapshotValid = false;
+    teamChangePending = false;
+}
+
+const PlayerList * PlayerRegistry::getPlayers() const
+{
+    return &players;
+}
+
+ClanMember * PlayerRegistry::findByIndex(int index) const
+{
+    ClanMember * found = NULL;
+
+    if ((index > 0) && (index <= ABSOLUTE_PLAYER_LIMIT))
+        found = slots[index];
+
+    return found;
+}
+
+ClanMember * PlayerRegistry::findByUserid(int userid) const
+{
+    return byUserid.find(userid);
+}
+
+ClanMember * PlayerRegistry::findBySteamid(const string & steamid) const
+{
+    return bySteamid.find(steamid);
+}
+
+void PlayerRegistry::invalidateSnapshot()
+{
+    snapshotValid = false;
+}
+
+void PlayerRegistry::nextFrame()
+{
+    snapshotValid = false;
+    teamChangePending = false;
+}
+
+const PlayerSnapshot * PlayerRegistry::getSnapshot(int index)
+{
+    const PlayerSnapshot * snapshot = NULL;
+
+    if (findByIndex(index) != NULL)
+    {
+        refreshSnapshot();
+        snapshot = &snapshots[index];
+    }
+
+    return snapshot;
+}
+
+const PlayerList * PlayerRegistry::getTeamMembers(TeamCode team)
+{
+    const PlayerList * members = &noMembers;
+
+    refreshSnapshot();
+    if ((team >= UN_TEAM) && (team <= CT_TEAM))
+        members = &teams[team];
+
+    return members;
+}
+
+int PlayerRegistry::getTeamCount(TeamCode team)
+{
+    int count = 0;
+
+    if (team == INVALID_TEAM)
+        count = (int)players.size();
+    else
+    {
+        refreshSnapshot();
+        if ((team >= UN_TEAM) && (team <= CT_TEAM))
+            count = (int)teams[team].size();
+    }
+
+    return count;
+}
+
+bool PlayerRegistry::isHltvConnected()
+{
+    refreshSnapshot();
+    return hltvConnected;
+}
+
+void PlayerRegistry::readProps(PlayerPropsSnapshot & props) const
+{
+    props.count = 0;
+
+    PlayerList::const_iterator itPlayer;
+    for(itPlayer = players.begin(); itPlayer != players.end(); itPlayer++)
+    {
+        props.players[props.count] = *itPlayer;
+        props.entities[props.count] = (*itPlayer)->getIdentity()->pEntity;
+        props.count++;
+    }
+
+    Player::readProps(props.entities, props.count, props.account, props.lifeState,
+                      props.playerState);
+}
+
+void PlayerRegistry::FireGameEvent(IGameEvent * event)
+{
+    // player_team, player_changename, player_death, player_spawn
+    snapshotValid = false;
+    if (strcmp(event->GetName(), "player_team") == 0)
+        teamChangePending = true;
+}
@@ -0,0 +1,315 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __PLAYER_REGISTRY_H__
+#define __PLAYER_REGISTRY_H__
+
+#include "Player.h"
+
+#include "const.h" // ABSOLUTE_PLAYER_LIMIT
+#include "igameevents.h"
+
+#include <string>
+#include <vector>
+
+/** Size of the userid/steamid hash indexes (power of 2, at least twice the player limit) */
+#define PLAYER_HASH_SIZE 512
+
+namespace cssmatch
+{
+    class ClanMember;
+
+    /** Connected players, in join order */
+    typedef std::vector<ClanMember *> PlayerList;
+
+    /** Player state read once per server frame */
+    struct PlayerSnapshot
+    {
+        /** Was the IPlayerInfo valid? */
+        bool valid;
+
+        /** Player team */
+        TeamCode team;
+
+        /** Is the player alive? */
+        bool alive;
+
+        /** Is this player SourceTv? */
+        bool hltv;
+
+        /** Is this player a bot? */
+        bool bot;
+
+        /** Player name */
+        std::string name;
+
+        PlayerSnapshot() : valid(false), team(INVALID_TEAM), alive(false), hltv(false), bot(false)
+        {}
+    };
+
+    /** Entity props of all players, read in one pass (structure of arrays) <br>
+     * The player at position i in <code>players</code> owns the values at position i
+     */
+    struct PlayerPropsSnapshot
+    {
+        /** Number of players */
+        int count;
+
+        /** Players, in join order */
+        ClanMember * players[ABSOLUTE_PLAYER_LIMIT];
+
+        /** Player entities */
+        edict_t * entities[ABSOLUTE_PLAYER_LIMIT];
+
+        /** Accounts (-1 if it fails) */
+        int account[ABSOLUTE_PLAYER_LIMIT];
+
+        /** Life states (-1 if it fails) */
+        int lifeState[ABSOLUTE_PLAYER_LIMIT];
+
+        /** Player states (-1 if it fails) */
+        int playerState[ABSOLUTE_PLAYER_LIMIT];
+
+        PlayerPropsSnapshot() : count(0)
+        {}
+    };
+
+    /** Hash a userid */
+    inline unsigned int hashPlayerKey(int userid)
+    {
+        return (unsigned int)userid * 2654435761u;
+    }
+
+    /** Hash a steamid (FNV-1a) */
+    inline unsigned int hashPlayerKey(const std::string & steamid)
+    {
+        unsigned int hash = 2166136261u;
+
+        std::string::const_iterator itChar;
+        for(itChar = steamid.begin(); itChar != steamid.end(); itChar++)
+        {
+            hash ^= (unsigned char)*itChar;
+            hash *= 16777619u;
+        }
+
+        return hash;
+    }
+
+    /** Fixed-capacity open addressing index from a player key to a player <br>
+     * Several players can share the same key (e.g. "BOT" steamids), a lookup returns one of them
+     */
+    template<typename Key>
+    class PlayerHashIndex
+    {
+    private:
+        Key keys[PLAYER_HASH_SIZE];
+        ClanMember * players[PLAYER_HASH_SIZE];
+
+        static unsigned int home(const Key & key)
+        {
+            return hashPlayerKey(key) & (PLAYER_HASH_SIZE - 1);
+        }
+    public:
+        PlayerHashIndex()
+        {
+            clear();
+        }
+
+        /** Add a player to the index */
+        void insert(const Key & key, ClanMember * player)
+        {
+            unsigned int slot = home(key);
+            while(players[slot] != NULL)
+                slot = (slot + 1) & (PLAYER_HASH_SIZE - 1);
+
+            keys[slot] = key;
+            players[slot] = player;
+        }
+
+        /** Remove a player from the index
+         * @param key The key used to add the player
+         * @param player The player to remove
+         */
+        void erase(const Key & key, ClanMember * player)
+        {
+            unsigned int slot = home(key);
+            while((players[slot] != NULL) && (players[slot] != player))
+                slot = (slot + 1) & (PLAYER_HASH_SIZE - 1);
+
+            if (players[slot] != NULL)
+            {
+                // Shift back the next entries of the cluster, so no lookup is broken by the hole
+                unsigned int hole = slot;
+                unsigned int next = (hole + 1) & (PLAYER_HASH_SIZE - 1);
+                while(players[next] != NULL)
+                {
+                    unsigned int nextHome = home(keys[next]);
+                    if (((next - nextHome) & (PLAYER_HASH_SIZE - 1)) >=
+                        ((next - hole) & (PLAYER_HASH_SIZE - 1)))
+                    {
+                        keys[hole] = keys[next];
+                        players[hole] = players[next];
+                        hole = next;
+                    }
+                    next = (next + 1) & (PLAYER_HASH_SIZE - 1);
+                }
+
+                keys[hole] = Key();
+                players[hole] = NULL;
+            }
+        }
+
+        /** Find a player
+         * @return The player found, or NULL
+         */
+        ClanMember * find(const Key & key) const
+        {
+            ClanMember * found = NULL;
+
+            unsigned int slot = home(key);
+            while((found == NULL) && (players[slot] != NULL))
+            {
+                if (keys[slot] == key)
+                    found = players[slot];
+                slot = (slot + 1) & (PLAYER_HASH_SIZE - 1);
+            }
+
+            return found;
+        }
+
+        /** Remove all players from the index */
+        void clear()
+        {
+            for(int i = 0; i < PLAYER_HASH_SIZE; i++)
+            {
+                keys[i] = Key();
+                players[i] = NULL;
+            }
+        }
+    };
+
+    /** Fixed-capacity player table addressed by edict index <br>
+     * Lookups by index, userid or steamid cost O(1), and the players stay in a contiguous list for
+     * the iterations. <br>
+     * The registry also keeps a snapshot of the team, life state and name of each player, so the
+     * team counts and members lists are read without calling IPlayerInfo again. The snapshot is
+     * rebuilt at most once per server frame, or after an event which could change it.
+     */
+    class PlayerRegistry : public IGameEventListener2
+    {
+    private:
+        /** Players by edict index (1..maxClients) */
+        ClanMember * slots[ABSOLUTE_PLAYER_LIMIT + 1];
+
+        /** Players in join order */
+        PlayerList players;
+
+        /** Players by userid */
+        PlayerHashIndex<int> byUserid;
+
+        /** Players by steamid */
+        PlayerHashIndex<std::string> bySteamid;
+
+        /** Player snapshots by edict index */
+        PlayerSnapshot snapshots[ABSOLUTE_PLAYER_LIMIT + 1];
+
+        /** Players by team (the index is a TeamCode) */
+        PlayerList teams[CT_TEAM + 1];
+
+        /** Empty list returned for an invalid team */
+        PlayerList noMembers;
+
+        /** Is SourceTv in the player list? */
+        bool hltvConnected;
+
+        /** Is the snapshot up to date? */
+        bool snapshotValid;
+
+        /** Was player_team fired since the last frame? <br>
+         * The game applies the new team after the event, so the snapshot is not kept until the next frame
+         */
+        bool teamChangePending;
+
+        /** Rebuild the snapshot if needed */
+        void refreshSnapshot();
+    public:
+        PlayerRegistry();
+
+        /** Add a player (any player with the same index must be removed before) */
+        void add(ClanMember * player);
+
+        /** Remove a player (without deleting it) */
+        void remove(ClanMember * player);
+
+        /** Remove all players (without deleting them) */
+        void clear();
+
+        /** Get the players in join order */
+        const PlayerList * getPlayers() const;
+
+        /** Get the player having this index, or NULL */
+        ClanMember * findByIndex(int index) const;
+
+        /** Get the player having this userid, or NULL */
+        ClanMember * findByUserid(int userid) const;
+
+        /** Get the player having this steamid, or NULL */
+        ClanMember * findBySteamid(const std::string & steamid) const;
+
+        /** Mark the snapshot as out of date (at each frame, or when a player changes) */
+        void invalidateSnapshot();
+
+        /** Mark the snapshot as out of date at the start of a frame <br>
+         * The team changes announced during the previous frame have been applied by then
+         */
+        void nextFrame();
+
+        /** Get the snapshot of a player
+         * @param index The player index
+         * @return The snapshot, or NULL if there is no player at this index
+         */
+        const PlayerSnapshot * getSnapshot(int index);
+
+        /** Get the players of a team (snapshot) */
+        const PlayerList * getTeamMembers(TeamCode team);
+
+        /** Count the players of a team (snapshot), INVALID_TEAM counts all players */
+        int getTeamCount(TeamCode team);
+
+        /** Is SourceTv connected? (snapshot) */
+        bool isHltvConnected();
+
+        /** Read the entity props of all players in one pass
+         * @param props Receives the props
+         */
+        void readProps(PlayerPropsSnapshot & props) const;
+
+        // IGameEventListener2 method
+        void FireGameEvent(IGameEvent * event);
+    };
+}
+
+#endif // __PLAYER_REGISTRY_H__
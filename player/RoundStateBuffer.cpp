@@ -0,0 +1,240 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "RoundStateBuffer.h"
+#include "ClanMember.h"
+#include "../plugin/ServerPlugin.h"
+#include "../entity/EntityRemover.h"
+
+#include "edict.h"
+#include "eiface.h" // IVEngineServer
+#include "iplayerinfo.h"
+
+#include <cstring>
+#include <sstream>
+
+using namespace cssmatch;
+
+using std::ostringstream;
+
+TypedEntityProp<int> RoundStateBuffer::ownerHandler("CBaseCombatWeapon", "m_hOwner");
+
+RoundStateBuffer::RoundStateBuffer()
+{
+    clear();
+}
+
+void RoundStateBuffer::clear()
+{
+    for(int i = 0; i <= ABSOLUTE_PLAYER_LIMIT; i++)
+    {
+        states[i].userid = 0;
+        states[i].itemCount = 0;
+    }
+}
+
+void RoundStateBuffer::scanItems()
+{
+    ServerPlugin * plugin = ServerPlugin::getInstance();
+    ValveInterfaces * interfaces = plugin->getInterfaces();
+    int maxClients = interfaces->gpGlobals->maxClients;
+
+    for(int i = 0; i <= maxClients; i++)
+    {
+        handles[i] = 0;
+        owned[i].count = 0;
+    }
+
+    const PlayerList * playerlist = plugin->getPlayerlist();
+    PlayerList::const_iterator itPlayer;
+    for(itPlayer = playerlist->begin(); itPlayer != playerlist->end(); itPlayer++)
+    {
+        PlayerIdentity * identity = (*itPlayer)->getIdentity();
+        if (isValidEntity(identity->pEntity))
+        {
+            IServerNetworkable * networkable = identity->pEntity->GetNetworkable();
+            if (networkable != NULL)
+                handles[identity->index] = networkable->GetEntityHandle()->GetRefEHandle().ToInt();
+        }
+    }
+
+    int ownerOffset = 0;
+    try
+    {
+        ownerOffset = ownerHandler.getOffset();
+    }
+    catch(const EntityPropException & e)
+    {
+        CSSMATCH_PRINT_EXCEPTION(e);
+    }
+
+    if (ownerOffset > 0)
+    {
+        // One pass over all entities, rather than one per player
+        int maxEntities = interfaces->gpGlobals->maxEntities;
+        for(int i = maxClients + 1; i < maxEntities; i++)
+        {
+            edict_t * entity = interfaces->engine->PEntityOfEntIndex(i);
+            if (isValidEntity(entity) && (strncmp(entity->GetClassName(), "weapon_", 7) == 0))
+            {
+                char * baseEntity = reinterpret_cast<char *>(getBaseEntity(entity));
+                if (baseEntity != NULL)
+                {
+                    int owner = *reinterpret_cast<int *>(baseEntity + ownerOffset);
+                    int ownerIndex = owner & ENT_ENTRY_MASK;
+
+                    if ((ownerIndex > 0) && (ownerIndex <= maxClients) &&
+                        (handles[ownerIndex] == owner) &&
+                        (owned[ownerIndex].count < ROUND_STATE_MAX_ITEMS))
+                    {
+                        PlayerOwnedItems & items = owned[ownerIndex];
+                        items.entities[items.count++] = entity;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void RoundStateBuffer::capture()
+{
+    ServerPlugin * plugin = ServerPlugin::getInstance();
+
+    clear();
+    scanItems();
+    plugin->readPlayerProps(props);
+
+    for(int i = 0; i < props.count; i++)
+    {
+        ClanMember * player = props.players[i];
+        PlayerIdentity * identity = player->getIdentity();
+        IPlayerInfo * pInfo = player->getPlayerInfo();
+
+        if (isValidPlayerInfo(pInfo))
+        {
+            PlayerRoundState & state = states[identity->index];
+
+            state.userid = identity->userid;
+            state.team = (TeamCode)pInfo->GetTeamIndex();
+            state.alive = ! pInfo->IsDead();
+            state.account = props.account[i];
+
+            const Vector origin = pInfo->GetAbsOrigin();
+            state.origin[0] = origin.x;
+            state.origin[1] = origin.y;
+            state.origin[2] = origin.z;
+
+            const QAngle angles = pInfo->GetAbsAngles();
+            state.angles[0] = angles.x;
+            state.angles[1] = angles.y;
+            state.angles[2] = angles.z;
+
+            const PlayerOwnedItems & items = owned[identity->index];
+            state.itemCount = items.count;
+            for(int j = 0; j < items.count; j++)
+            {
+                strncpy(state.items[j], items.entities[j]->GetClassName(),
+                        ROUND_STATE_ITEM_LENGTH - 1);
+                state.items[j][ROUND_STATE_ITEM_LENGTH - 1] = '\0';
+            }
+        }
+    }
+}
+
+void RoundStateBuffer::restore()
+{
+    ServerPlugin * plugin = ServerPlugin::getInstance();
+    EntityRemover * remover = EntityRemover::getInstance();
+    ConVar * sv_cheats = plugin->getConVar("sv_cheats");
+
+    scanItems();
+
+    // Toggle sv_cheats once for all the commands
+    sv_cheats->m_nValue = 1;
+
+    const PlayerList * playerlist = plugin->getPlayerlist();
+    PlayerList::const_iterator itPlayer;
+    for(itPlayer = playerlist->begin(); itPlayer != playerlist->end(); itPlayer++)
+    {
+        PlayerIdentity * identity = (*itPlayer)->getIdentity();
+        IPlayerInfo * pInfo = (*itPlayer)->getPlayerInfo();
+        const PlayerRoundState & state = states[identity->index];
+
+        if ((state.userid == identity->userid) && isValidPlayerInfo(pInfo) &&
+            (pInfo->GetTeamIndex() == state.team))
+        {
+            if (state.account > -1)
+                (*itPlayer)->setAccount(state.account);
+
+            if (state.alive && (! pInfo->IsDead()))
+            {
+                const PlayerOwnedItems & items = owned[identity->index];
+                bool alreadyOwned[ROUND_STATE_MAX_ITEMS] = {false};
+
+                // Remove the weapons given by the restart which were not owned before
+                for(int i = 0; i < items.count; i++)
+                {
+                    const char * className = items.entities[i]->GetClassName();
+
+                    int found = -1;
+                    for(int j = 0; (j < state.itemCount) && (found == -1); j++)
+                    {
+                        if ((! alreadyOwned[j]) && (strcmp(state.items[j], className) == 0))
+                            found = j;
+                    }
+
+                    if (found != -1)
+                        alreadyOwned[found] = true;
+                    else
+                        remover->remove(items.entities[i]);
+                }
+
+                // Give back the missing weapons
+                for(int i = 0; i < state.itemCount; i++)
+                {
+                    if (! alreadyOwned[i])
+                    {
+                        ostringstream command;
+                        command << "give " << state.items[i] << "\n";
+                        (*itPlayer)->sexec(command.str());
+                    }
+                }
+
+                ostringstream position;
+                position << "setpos " << state.origin[0] << " " << state.origin[1] << " " <<
+                    state.origin[2] << "\n";
+                (*itPlayer)->sexec(position.str());
+
+                ostringstream angles;
+                angles << "setang " << state.angles[0] << " " << state.angles[1] << " " <<
+                    state.angles[2] << "\n";
+                (*itPlayer)->sexec(angles.str());
+            }
+        }
+    }
+
+    sv_cheats->m_nValue = 0;
+}
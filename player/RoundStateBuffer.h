@@ -0,0 +1,121 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __ROUND_STATE_BUFFER_H__
+#define __ROUND_STATE_BUFFER_H__
+
+#include "PlayerRegistry.h" // PlayerPropsSnapshot, TeamCode
+
+#include "const.h" // ABSOLUTE_PLAYER_LIMIT
+
+/** Maximum number of weapons saved per player */
+#define ROUND_STATE_MAX_ITEMS 8
+
+/** Maximum length of a weapon class name (including the terminating 0) */
+#define ROUND_STATE_ITEM_LENGTH 32
+
+namespace cssmatch
+{
+    /** What a player owned when the round started */
+    struct PlayerRoundState
+    {
+        /** Player userid, 0 if nothing was captured for this player */
+        int userid;
+
+        /** Player team */
+        TeamCode team;
+
+        /** Was the player alive? */
+        bool alive;
+
+        /** Player account, -1 if unknown */
+        int account;
+
+        /** Player position */
+        float origin[3];
+
+        /** Player angles */
+        float angles[3];
+
+        /** Number of weapons */
+        int itemCount;
+
+        /** Weapon class names (e.g. "weapon_ak47") */
+        char items[ROUND_STATE_MAX_ITEMS][ROUND_STATE_ITEM_LENGTH];
+    };
+
+    /** Weapons currently owned by a player */
+    struct PlayerOwnedItems
+    {
+        /** Number of weapons */
+        int count;
+
+        /** Weapon entities */
+        edict_t * entities[ROUND_STATE_MAX_ITEMS];
+    };
+
+    /** Money, weapons and position of each player at the start of the round, restored if the round
+     * is restarted <br>
+     * All the buffers are allocated once, so capturing the state at each round start does not
+     * allocate anything
+     */
+    class RoundStateBuffer
+    {
+    private:
+        /** Saved states by player index */
+        PlayerRoundState states[ABSOLUTE_PLAYER_LIMIT + 1];
+
+        /** Weapons owned by player index, filled by scanItems */
+        PlayerOwnedItems owned[ABSOLUTE_PLAYER_LIMIT + 1];
+
+        /** Handle of each player by player index (0 if there is no player) */
+        int handles[ABSOLUTE_PLAYER_LIMIT + 1];
+
+        /** Player entity props read in one pass */
+        PlayerPropsSnapshot props;
+
+        /** Entity prop used to know who owns a weapon */
+        static TypedEntityProp<int> ownerHandler;
+
+        /** Fill <code>owned</code> with the weapons of each player, in one pass over the
+         * entities
+         */
+        void scanItems();
+    public:
+        RoundStateBuffer();
+
+        /** Forget all saved states */
+        void clear();
+
+        /** Save the state of all players */
+        void capture();
+
+        /** Restore the state saved by capture, in one pass (call it once the round restarted) */
+        void restore();
+    };
+}
+
+#endif // __ROUND_STATE_BUFFER_H__
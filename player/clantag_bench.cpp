@@ -0,0 +1,205 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+/* Micro-benchmark of the clan tag detection: the legacy pairwise scan, the suffix automaton and
+ * a cache hit (same roster, same names), for 5v5 and 32-slot rosters
+ * Build with "make bench", it only depends on ClanTagDetector.cpp
+ */
+
+#include "ClanTagDetector.h"
+
+#include <cstdio>
+#include <ctime>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace cssmatch;
+
+using std::ostringstream;
+using std::string;
+using std::vector;
+
+#define BENCH_ITERATIONS 20000
+
+// Legacy detection: each pair of names, each candidate checked against every name
+
+static bool legacyIsValidClanName(const string & newName, const vector<string> & names)
+{
+    bool valid = false;
+
+    if (newName.size() >= 3)
+    {
+        int majority = names.size() / 2;
+        int occurences = 0;
+
+        vector<string>::const_iterator itName;
+        for(itName = names.begin(); itName != names.end(); itName++)
+        {
+            if (itName->find(newName) != string::npos)
+            {
+                occurences++;
+                if (occurences > majority)
+                {
+                    valid = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    return valid;
+}
+
+static string legacyDetect(const vector<string> & names)
+{
+    string found;
+    bool foundName = false;
+    int majority = names.size() / 2;
+    int iMember = 0;
+
+    vector<string>::const_iterator itMember = names.begin();
+    while((iMember <= majority) && (! foundName))
+    {
+        vector<string>::const_iterator itMember2 = itMember;
+        itMember2++;
+        while(itMember2 != names.end() && (! foundName))
+        {
+            const string & memberName1 = *itMember;
+            const string & memberName2 = *itMember2;
+
+            string newName;
+            string::const_iterator itMemberName1 = memberName1.begin();
+            string::const_iterator endMemberName1 = memberName1.end();
+            string::const_iterator endMemberName2 = memberName2.end();
+
+            while(itMemberName1 != endMemberName1)
+            {
+                string::const_iterator itMemberName2 = memberName2.begin();
+                while((itMemberName1 != endMemberName1) && (itMemberName2 != endMemberName2))
+                {
+                    if ((*itMemberName1) == (*itMemberName2))
+                    {
+                        newName += *itMemberName1;
+                        itMemberName1++;
+                    }
+                    else if (legacyIsValidClanName(newName, names))
+                    {
+                        found = newName;
+                        foundName = true;
+                        itMemberName1 = endMemberName1 - 1;
+                        itMemberName2 = endMemberName2 - 1;
+                    }
+                    else
+                        newName = "";
+
+                    itMemberName2++;
+                }
+
+                if (itMemberName1 != endMemberName1)
+                    itMemberName1++;
+            }
+
+            itMember2++;
+        }
+        itMember++;
+        iMember++;
+    }
+
+    return found;
+}
+
+/** Build a roster
+ * @param size Number of players
+ * @param tagged Number of players wearing the tag
+ */
+static vector<string> makeRoster(int size, int tagged, const string & tag)
+{
+    static const char * nicknames[] =
+    {
+        "Alpha", "Bravo", "Charlie", "Delta", "Echo", "Foxtrot", "Golf", "Hotel",
+        "India", "Juliett", "Kilo", "Lima", "Mike", "November", "Oscar", "Papa"
+    };
+
+    vector<string> names;
+    for(int i = 0; i < size; i++)
+    {
+        ostringstream name;
+        if (i < tagged)
+            name << tag;
+        name << nicknames[i % 16] << i;
+        names.push_back(name.str());
+    }
+    return names;
+}
+
+static void run(const char * title, const vector<string> & names)
+{
+    ClanTagDetector detector;
+    string legacyTag;
+    string tag;
+    vector<string> cachedNames = names;
+    const vector<string> * volatile roster = &names; // keeps the comparison in the loop
+    int hits = 0;
+
+    clock_t begin = clock();
+    for(int i = 0; i < BENCH_ITERATIONS; i++)
+        legacyTag = legacyDetect(names);
+    double legacyTime = (double)(clock() - begin) / CLOCKS_PER_SEC;
+
+    begin = clock();
+    for(int i = 0; i < BENCH_ITERATIONS; i++)
+        tag = detector.detect(names);
+    double automatonTime = (double)(clock() - begin) / CLOCKS_PER_SEC;
+
+    begin = clock();
+    for(int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        if (*roster == cachedNames)
+            hits++;
+    }
+    double cacheTime = (double)(clock() - begin) / CLOCKS_PER_SEC;
+    if (hits != BENCH_ITERATIONS)
+        printf("%s: unexpected cache miss\n", title);
+
+    printf("%-24s legacy %8.2f us (\"%s\")  automaton %8.2f us (\"%s\")  cache hit %6.3f us\n",
+           title, legacyTime * 1e6 / BENCH_ITERATIONS, legacyTag.c_str(),
+           automatonTime * 1e6 / BENCH_ITERATIONS, tag.c_str(),
+           cacheTime * 1e6 / BENCH_ITERATIONS);
+}
+
+int main(int argc, char ** argv)
+{
+    run("5v5, all tagged", makeRoster(5, 5, "[CSSM] "));
+    run("5v5, 3 tagged", makeRoster(5, 3, "team-x | "));
+    run("5v5, no tag", makeRoster(5, 0, ""));
+    run("32 slots, 16 tagged", makeRoster(16, 16, "[CSSM] "));
+    run("32 slots, 9 tagged", makeRoster(16, 9, "team-x | "));
+    run("32 slots, 1 team", makeRoster(32, 17, "[PUB] "));
+    run("32 slots, no tag", makeRoster(32, 0, ""));
+
+    return 0;
+}
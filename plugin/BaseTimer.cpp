@@ -25,11 +25,12 @@
  */
 
 #include "BaseTimer.h"
+#include "TimerWheel.h"
 #include "ServerPlugin.h"
 
 using namespace cssmatch;
 
-BaseTimer::BaseTimer(float delay) : cancelled(false)
+BaseTimer::BaseTimer(float delay) : cancelled(false), wheel(NULL), next(NULL), prevLink(NULL)
 {
     date = ServerPlugin::getInstance()->getInterfaces()->gpGlobals->curtime + delay;
 }
@@ -40,5 +41,11 @@ BaseTimer::~BaseTimer()
 
 void BaseTimer::cancel()
 {
-    cancelled = true;
+    if (! cancelled)
+    {
+        cancelled = true;
+
+        if (wheel != NULL)
+            wheel->release(this);
+    }
 }
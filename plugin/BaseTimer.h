@@ -29,19 +29,30 @@
 
 namespace cssmatch
 {
+    class TimerWheel;
+
     /** Any timer has to be derived from this "stub" class in order to use the timer in a generic
       way */
     class BaseTimer
     {
     protected:
-        // see struct TimerOutOfDate
-        friend struct TimerOutOfDate;
+        // see class TimerWheel
+        friend class TimerWheel;
 
         /** When (in server time seconds) the delayed function must be executed */
         float date;
 
         /** Is the timer cancelled ? */
         bool cancelled;
+
+        /** Wheel which holds this timer (NULL if the timer is not scheduled) */
+        TimerWheel * wheel;
+
+        /** Next timer in the same wheel bucket */
+        BaseTimer * next;
+
+        /** Link which points to this timer in the wheel bucket (NULL if not linked) */
+        BaseTimer ** prevLink;
     public:
         /** Prepare a timer
          * @param delay Delay (in seconds) before the timer callback is executed
@@ -50,45 +61,15 @@ namespace cssmatch
 
         virtual ~BaseTimer();
 
-        /** Cancel this timer */
+        /** Cancel this timer <br>
+         * The timer stays allocated until the next server frame, then is deleted by its wheel
+         */
         void cancel();
 
         /** Execute the delayed function */
         virtual void execute() = 0;
     };
 
-    /** Functor to quickly determine if a timer must be executed <br>
-     * If yes, the timer is executed and the operator () returns <code>true</code>
-     */
-    struct TimerOutOfDate
-    {
-        /** Reference date */
-        float date;
-
-        /**
-         * @param currentDate The date to compare with the timer's execution date
-         */
-        TimerOutOfDate(float currentDate) : date(currentDate){}
-
-        bool operator()(BaseTimer * timer)
-        {
-            bool outofdate = false;
-
-            if (timer->date <= date)
-            {
-                if (! timer->cancelled)
-                {
-                    timer->execute();
-                }
-
-                delete timer;
-                outofdate = true;
-            }
-
-            return outofdate;
-        }
-    };
-
     /** Functor to delete timers */
     struct TimerToDelete
     {
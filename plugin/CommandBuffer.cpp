@@ -0,0 +1,114 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "CommandBuffer.h"
+
+#include "../misc/common.h"
+
+#include "eiface.h" // IVEngineServer
+
+using namespace cssmatch;
+
+using std::string;
+
+CommandBuffer::CommandBuffer() : pendingCount(0)
+{
+    pending.reserve(COMMAND_BUFFER_MAX_LENGTH);
+    resetStats();
+}
+
+void CommandBuffer::append(IVEngineServer * engine, const string & command)
+{
+    if (! command.empty())
+    {
+        bool newLine = (command[command.size() - 1] != '\n');
+
+        if (pending.size() + command.size() + (newLine ? 1 : 0) > COMMAND_BUFFER_MAX_LENGTH)
+            flush(engine);
+
+        pending += command;
+        if (newLine)
+            pending += '\n';
+
+        pendingCount++;
+        frameCommands++;
+        totalCommands++;
+    }
+}
+
+void CommandBuffer::flush(IVEngineServer * engine)
+{
+    if (pendingCount > 0)
+    {
+        engine->ServerCommand(pending.c_str());
+        totalFlushes++;
+
+        pending.clear();
+        pendingCount = 0;
+    }
+}
+
+void CommandBuffer::barrier(IVEngineServer * engine)
+{
+    flush(engine);
+    engine->ServerExecute();
+    totalBarriers++;
+}
+
+void CommandBuffer::endFrame(IVEngineServer * engine)
+{
+    flush(engine);
+
+    lastFrameCommands = frameCommands;
+    if (frameCommands > 0)
+    {
+        busyFrames++;
+        if (frameCommands > maxFrameCommands)
+            maxFrameCommands = frameCommands;
+    }
+    frameCommands = 0;
+}
+
+void CommandBuffer::resetStats()
+{
+    frameCommands = 0;
+    lastFrameCommands = 0;
+    maxFrameCommands = 0;
+    busyFrames = 0;
+    totalCommands = 0;
+    totalFlushes = 0;
+    totalBarriers = 0;
+}
+
+void CommandBuffer::printStats() const
+{
+    Msg("%-40s %10lu\n", "server commands", totalCommands);
+    Msg("%-40s %10lu\n", "server command flushes", totalFlushes);
+    Msg("%-40s %10lu\n", "server command barriers", totalBarriers);
+    Msg("%-40s %10lu\n", "frames issuing commands", busyFrames);
+    Msg("%-40s %10d\n", "commands during the last frame", lastFrameCommands);
+    Msg("%-40s %10d\n", "max commands per frame", maxFrameCommands);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __COMMAND_BUFFER_H__
+#define __COMMAND_BUFFER_H__
+
+#include <string>
+
+class IVEngineServer;
+
+/** Maximum length of the commands sent to the server at once */
+#define COMMAND_BUFFER_MAX_LENGTH 1024
+
+namespace cssmatch
+{
+    /** Server commands issued during a frame <br>
+     * The commands are concatenated then sent to the server console in one call at the end of
+     * the frame (or before if a barrier is required) <br>
+     * Not thread-safe: only use it on the game thread
+     */
+    class CommandBuffer
+    {
+    private:
+        /** Pending commands, each terminated by a new line */
+        std::string pending;
+
+        /** Number of pending commands */
+        int pendingCount;
+
+        /** Number of commands issued since the last end of frame */
+        int frameCommands;
+
+        /** Number of commands issued during the last frame */
+        int lastFrameCommands;
+
+        /** Greatest number of commands issued during a frame */
+        int maxFrameCommands;
+
+        /** Number of frames which issued commands */
+        unsigned long busyFrames;
+
+        /** Number of commands issued */
+        unsigned long totalCommands;
+
+        /** Number of calls to IVEngineServer::ServerCommand */
+        unsigned long totalFlushes;
+
+        /** Number of barriers */
+        unsigned long totalBarriers;
+    public:
+        CommandBuffer();
+
+        /** Add a command to the buffer
+         * @param engine The engine (used if the buffer is full)
+         * @param command The command (a new line is added if missing)
+         */
+        void append(IVEngineServer * engine, const std::string & command);
+
+        /** Send the pending commands to the server console
+         * @param engine The engine
+         */
+        void flush(IVEngineServer * engine);
+
+        /** Send the pending commands to the server console and execute them right now
+         * @param engine The engine
+         */
+        void barrier(IVEngineServer * engine);
+
+        /** Flush the pending commands, and update the per-frame counters
+         * @param engine The engine
+         */
+        void endFrame(IVEngineServer * engine);
+
+        /** Reset the counters */
+        void resetStats();
+
+        /** Print the counters in the server console */
+        void printStats() const;
+    };
+}
+
+#endif // __COMMAND_BUFFER_H__
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "GameThreadQueue.h"
+#include "ServerPlugin.h"
+
+#include <sstream>
+
+using namespace cssmatch;
+
+using std::string;
+using std::ostringstream;
+
+GameThreadQueue::GameThreadQueue()
+    : gameThreadId(threading::currentThreadId()), reportedDrops(0)
+{
+}
+
+bool GameThreadQueue::isGameThread() const
+{
+    return threading::currentThreadId() == gameThreadId;
+}
+
+bool GameThreadQueue::postLog(const string & message)
+{
+    GameThreadMessage logLine;
+    logLine.text = message;
+
+    return messages.push(logLine);
+}
+
+bool GameThreadQueue::postCallback(GameThreadCallback callback, void * data, const string & text)
+{
+    GameThreadMessage call;
+    call.callback = callback;
+    call.data = data;
+    call.text = text;
+
+    return messages.push(call);
+}
+
+void GameThreadQueue::process()
+{
+    ServerPlugin * plugin = ServerPlugin::getInstance();
+
+    GameThreadMessage message;
+    while(messages.pop(message))
+    {
+        if (message.callback != NULL)
+            message.callback(message.data, message.text);
+        else
+            plugin->log(message.text);
+    }
+
+    long dropped = messages.getDropped();
+    if (dropped != reportedDrops)
+    {
+        ostringstream buffer;
+        buffer << (dropped - reportedDrops) << " message(s) from the worker threads dropped";
+        plugin->log(buffer.str());
+        reportedDrops = dropped;
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __GAME_THREAD_QUEUE_H__
+#define __GAME_THREAD_QUEUE_H__
+
+#include "../threading/MpscQueue.h"
+
+#include <string>
+
+/** Number of messages the worker threads can post between two server frames */
+#define GAME_THREAD_QUEUE_SIZE 256
+
+namespace cssmatch
+{
+    /** Function called on the game thread
+     * @param data The data given when the callback was posted
+     * @param text The text given when the callback was posted
+     */
+    typedef void (* GameThreadCallback)(void * data, const std::string & text);
+
+    /** Message posted to the game thread */
+    struct GameThreadMessage
+    {
+        /** Callback to call, or NULL to log the text */
+        GameThreadCallback callback;
+
+        /** Callback data */
+        void * data;
+
+        /** Log line or callback text */
+        std::string text;
+
+        GameThreadMessage() : callback(NULL), data(NULL)
+        {}
+    };
+
+    /** Messages posted by the worker threads, processed by the game thread at each frame <br>
+     * The worker threads must not call the engine (e.g. to log something), they post a log line
+     * or a callback here instead. Posting never blocks: if the queue is full, the message is
+     * dropped.
+     */
+    class GameThreadQueue
+    {
+    private:
+        /** Pending messages */
+        threading::MpscQueue<GameThreadMessage, GAME_THREAD_QUEUE_SIZE> messages;
+
+        /** Id of the game thread */
+        unsigned long gameThreadId;
+
+        /** Number of dropped messages already reported */
+        long reportedDrops;
+    public:
+        /** Must be constructed by the game thread */
+        GameThreadQueue();
+
+        /** Is the caller the game thread? */
+        bool isGameThread() const;
+
+        /** Post a line to log (any thread)
+         * @param message The line
+         * @return <code>false</code> if the queue is full
+         */
+        bool postLog(const std::string & message);
+
+        /** Post a callback to call on the game thread (any thread)
+         * @param callback The callback
+         * @param data The callback data (must still be valid when the callback is called)
+         * @param text The callback text
+         * @return <code>false</code> if the queue is full
+         */
+        bool postCallback(GameThreadCallback callback, void * data,
+                          const std::string & text = "");
+
+        /** Process the pending messages (game thread only) */
+        void process();
+    };
+}
+
+#endif // __GAME_THREAD_QUEUE_H__
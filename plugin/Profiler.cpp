@@ -0,0 +1,197 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "Profiler.h"
+
+#include "../misc/common.h"
+
+#include "tier0/platform.h" // Plat_FloatTime
+
+#include <fstream>
+
+using namespace cssmatch;
+
+using std::string;
+using std::ofstream;
+
+ProfileProbe::ProfileProbe() : calls(0), totalTime(0.0), maxTime(0)
+{
+    for(int i = 0; i < PROFILER_BUCKETS; i++)
+    {
+        histogram[i] = 0;
+    }
+}
+
+unsigned long ProfileProbe::getPercentile(double percent) const
+{
+    unsigned long percentile = 0;
+
+    if (calls > 0)
+    {
+        double threshold = calls * percent / 100.0;
+        unsigned long cumulated = 0;
+        int bucket = 0;
+        while(bucket < PROFILER_BUCKETS)
+        {
+            cumulated += histogram[bucket];
+            if (cumulated >= threshold)
+                break;
+            bucket++;
+        }
+
+        percentile = Profiler::getBucketLimit(bucket);
+        if (percentile > maxTime)
+            percentile = maxTime;
+    }
+
+    return percentile;
+}
+
+Profiler::Profiler() : probeCount(0)
+{}
+
+int Profiler::getBucket(unsigned long micros)
+{
+    int bucket;
+
+    if (micros < 4)
+        bucket = micros;
+    else
+    {
+        int exponent = 2;
+        while((micros >> (exponent + 1)) != 0)
+            exponent++;
+
+        bucket = 4*(exponent - 1) + ((micros >> (exponent - 2)) & 3);
+        if (bucket >= PROFILER_BUCKETS)
+            bucket = PROFILER_BUCKETS - 1;
+    }
+
+    return bucket;
+}
+
+unsigned long Profiler::getBucketLimit(int bucket)
+{
+    unsigned long limit;
+
+    if (bucket < 4)
+        limit = bucket + 1;
+    else
+    {
+        int exponent = bucket/4 + 1;
+        limit = (unsigned long)(5 + bucket%4) << (exponent - 2);
+    }
+
+    return limit;
+}
+
+int Profiler::registerProbe(const string & name)
+{
+    int probe = 0;
+    while((probe < probeCount) && (probes[probe].name != name))
+    {
+        probe++;
+    }
+
+    if (probe == probeCount)
+    {
+        if (probeCount < PROFILER_MAX_PROBES)
+        {
+            probes[probe].name = name;
+            probeCount++;
+        }
+        else
+        {
+            CSSMATCH_PRINT("Too many profiler probes, " + name + " will not be profiled");
+            probe = -1;
+        }
+    }
+
+    return probe;
+}
+
+void Profiler::record(int probe, double seconds)
+{
+    if (probe >= 0)
+    {
+        ProfileProbe & stats = probes[probe];
+        unsigned long micros = (seconds > 0.0) ? (unsigned long)(seconds * 1000000.0) : 0;
+
+        stats.calls++;
+        stats.totalTime += seconds;
+        if (micros > stats.maxTime)
+            stats.maxTime = micros;
+        stats.histogram[getBucket(micros)]++;
+    }
+}
+
+void Profiler::reset()
+{
+    for(int i = 0; i < probeCount; i++)
+    {
+        string name = probes[i].name;
+        probes[i] = ProfileProbe();
+        probes[i].name = name;
+    }
+}
+
+void Profiler::print() const
+{
+    Msg("%-40s %10s %12s %10s %10s %10s\n", "probe", "calls", "total (ms)", "p50 (us)", "p99 (us)",
+        "max (us)");
+    for(int i = 0; i < probeCount; i++)
+    {
+        const ProfileProbe & stats = probes[i];
+        if (stats.calls > 0)
+            Msg("%-40s %10lu %12.3f %10lu %10lu %10lu\n", stats.name.c_str(), stats.calls,
+                stats.totalTime * 1000.0, stats.getPercentile(50.0), stats.getPercentile(99.0),
+                stats.maxTime);
+    }
+}
+
+void Profiler::writeCsv(const string & filePath) const throw(ProfilerException)
+{
+    ofstream csv(filePath.c_str());
+    if (csv.fail())
+        throw ProfilerException("Unable to write the profiler statistics to " + filePath);
+
+    csv << "probe;calls;total_ms;p50_us;p99_us;max_us\n";
+    for(int i = 0; i < probeCount; i++)
+    {
+        const ProfileProbe & stats = probes[i];
+        csv << stats.name << ';' << stats.calls << ';' << stats.totalTime * 1000.0 << ';'
+            << stats.getPercentile(50.0) << ';' << stats.getPercentile(99.0) << ';'
+            << stats.maxTime << '\n';
+    }
+}
+
+ProfileScope::ProfileScope(int probeId) : probe(probeId), start(Plat_FloatTime())
+{}
+
+ProfileScope::~ProfileScope()
+{
+    Profiler::getInstance()->record(probe, Plat_FloatTime() - start);
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include "../exceptions/BaseException.h"
+#include "../misc/BaseSingleton.h"
+
+#include <string>
+
+/** Maximum number of probes */
+#define PROFILER_MAX_PROBES 64
+
+/** Number of histogram buckets per probe <br>
+ * The latencies are stored in microseconds: 4 buckets per power of two
+ */
+#define PROFILER_BUCKETS 128
+
+/** Declare a probe (registered once) and measure the time spent until the end of the scope
+ * @param name The probe name
+ */
+#define CSSMATCH_PROFILE(name) \
+    static int profileProbe = cssmatch::Profiler::getInstance()->registerProbe(name); \
+    cssmatch::ProfileScope profileScope(profileProbe);
+
+namespace cssmatch
+{
+    class ProfilerException : public BaseException
+    {
+    public:
+        ProfilerException(const std::string & message) : BaseException(message){}
+    };
+
+    /** Statistics collected for one instrumented code section */
+    struct ProfileProbe
+    {
+        /** Probe name */
+        std::string name;
+
+        /** Number of calls */
+        unsigned long calls;
+
+        /** Total time spent (in seconds) */
+        double totalTime;
+
+        /** Longest call (in microseconds) */
+        unsigned long maxTime;
+
+        /** Latency histogram */
+        unsigned long histogram[PROFILER_BUCKETS];
+
+        ProfileProbe();
+
+        /** Get a percentile from the histogram
+         * @param percent The percentile (e.g. 99.0)
+         * @return The upper bound of the corresponding bucket (in microseconds)
+         */
+        unsigned long getPercentile(double percent) const;
+    };
+
+    /** Lightweight profiler for the plugin hot paths <br>
+     * The probes are registered once, then recording a call does not allocate anything <br>
+     * Not thread-safe: only profile code running on the game thread
+     */
+    class Profiler : public BaseSingleton<Profiler>
+    {
+    private:
+        /** Registered probes */
+        ProfileProbe probes[PROFILER_MAX_PROBES];
+
+        /** Number of registered probes */
+        int probeCount;
+
+        /** Get the histogram bucket of a latency
+         * @param micros The latency (in microseconds)
+         */
+        static int getBucket(unsigned long micros);
+
+        friend class BaseSingleton<Profiler>;
+        Profiler();
+    public:
+        /** Get the upper bound of a histogram bucket (in microseconds) */
+        static unsigned long getBucketLimit(int bucket);
+
+        /** Register a probe (or get the id of an existing probe having the same name)
+         * @param name The probe name
+         * @return The probe id, or -1 if there is no more free probe
+         */
+        int registerProbe(const std::string & name);
+
+        /** Record one call
+         * @param probe The probe id
+         * @param seconds The time spent
+         */
+        void record(int probe, double seconds);
+
+        /** Reset the statistics of all probes */
+        void reset();
+
+        /** Print the statistics in the server console */
+        void print() const;
+
+        /** Write the statistics in a CSV file
+         * @param filePath The file path
+         * @throws ProfilerException if the file cannot be written
+         */
+        void writeCsv(const std::string & filePath) const throw(ProfilerException);
+    };
+
+    /** Measure the time spent in a scope */
+    class ProfileScope
+    {
+    private:
+        /** Probe id */
+        int probe;
+
+        /** When the scope begins */
+        double start;
+    public:
+        /**
+         * @param probeId The probe id returned by Profiler::registerProbe
+         */
+        ProfileScope(int probeId);
+        ~ProfileScope();
+    };
+}
+
+#endif // __PROFILER_H__
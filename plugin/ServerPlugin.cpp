@@ -28,15 +28,20 @@
                             // ARRAYSIZE macro
 #include "ServerPlugin.h"
 #include "BaseTimer.h"
+#include "Profiler.h"
 #include "../configuration/ConfigurationFile.h"
 #include "../convars/I18nConVar.h"
 #include "../commands/I18nConCommand.h"
 #include "../convars/ConVarCallbacks.h"
-//#include "../entity/EntityProp.h"
+#include "../entity/PropOffsetCache.h"
+#include "../entity/EntityRemover.h"
 #include "../player/ClanMember.h"
 #include "../messages/I18nManager.h"
 #include "../match/MatchManager.h"
 #include "../match/DisabledMatchState.h"
+#include "../report/ReportWriter.h"
+#include "../player/ClanDetectionThread.h"
+#include "../threading/ThreadPool.h"
 
 #include "tier1.h" // ICVar * g_pCVar
 // #include "tier2/tier2.h" // IFileSystem * g_pFullFileSystem
@@ -57,12 +62,20 @@ using std::string;
 using std::list;
 using std::map;
 using std::for_each;
-using std::count_if;
 using std::find;
 using std::find_if;
 using std::ostringstream;
 using std::endl;
 
+// Translation keywords
+static const I18nKeyword ADMIN_IS_NOT_CONNECTED("admin_is_not_connected");
+static const I18nKeyword ADMIN_KICK_BY("admin_kick_by");
+static const I18nKeyword ADMIN_MAP_NOT_FOUND("admin_map_not_found");
+static const I18nKeyword ADMIN_PERMANENTLY_BAN("admin_permanently_ban");
+static const I18nKeyword ADMIN_SPEC("admin_spec");
+static const I18nKeyword ADMIN_SWAP("admin_swap");
+static const I18nKeyword ADMIN_TEMPORALY_BAN("admin_temporaly_ban");
+
 /*CON_COMMAND(cssm_test, "CSSMatch: Internal")
 {
     ServerPlugin * plugin = ServerPlugin::getInstance();
@@ -104,7 +117,8 @@ void execute()
 };
 
 ServerPlugin::ServerPlugin()
-    : instances(0), loadSuccess(false), updateThread(NULL), clientCommandIndex(0), adminMenu(NULL),
+    : instances(0), loadSuccess(false), updateThread(NULL), reportThread(NULL),
+    clanDetectionThread(NULL), workerPool(NULL), clientCommandIndex(0), adminMenu(NULL),
     bantimeMenu(NULL), match(NULL), i18n(NULL)
 {
 }
@@ -113,7 +127,9 @@ ServerPlugin::~ServerPlugin()
 {
     removeTimers();
 
-    for_each(playerlist.begin(), playerlist.end(), PlayerToRemove());
+    const PlayerList * playerlist = players.getPlayers();
+    for_each(playerlist->begin(), playerlist->end(), PlayerToRemove());
+    players.clear();
 
     if (adminMenu != NULL)
         delete adminMenu;
@@ -183,6 +199,10 @@ bool ServerPlugin::Load(CreateInterfaceFn interfaceFactory, CreateInterfaceFn ga
         {
             interfaces.gpGlobals = interfaces.playerinfomanager->GetGlobalVars();
 
+            // Index the props offsets now: if the plugin is loaded in the middle of a map,
+            // ServerActivate will not be called before the props are used
+            PropOffsetCache::getInstance()->build();
+
             //MathLib_Init(2.2f,2.2f,0.0f,2);
 
             // Initialize the admin menus
@@ -207,6 +227,12 @@ bool ServerPlugin::Load(CreateInterfaceFn interfaceFactory, CreateInterfaceFn ga
 
             match = new MatchManager(DisabledMatchState::getInstance());
 
+            // Invalidate the player snapshot when a player changes between two frames
+            interfaces.gameeventmanager2->AddListener(&players, "player_team", true);
+            interfaces.gameeventmanager2->AddListener(&players, "player_changename", true);
+            interfaces.gameeventmanager2->AddListener(&players, "player_death", true);
+            interfaces.gameeventmanager2->AddListener(&players, "player_spawn", true);
+
             //    Initialize the translations tools
             i18n = new I18nManager();
             I18nConVar * cssmatch_language =
@@ -227,6 +253,10 @@ bool ServerPlugin::Load(CreateInterfaceFn interfaceFactory, CreateInterfaceFn ga
             addPluginConVar(new I18nConVar(i18n, "cssmatch_report", "1", FCVAR_NONE,
                                            "cssmatch_report", true, 0.0f, true, 1.0f));
 
+            addPluginConVar(new I18nConVar(i18n, "cssmatch_preload_translations", "1",
+                                           FCVAR_NONE, "cssmatch_preload_translations", true,
+                                           0.0f, true, 1.0f));
+
             addPluginConVar(new I18nConVar(i18n, "cssmatch_kniferound", "1", FCVAR_NONE,
                                            "cssmatch_kniferound", true, 0.0f, true, 1.0f));
             addPluginConVar(new I18nConVar(i18n, "cssmatch_kniferound_money", "0", FCVAR_NONE,
@@ -291,6 +321,10 @@ bool ServerPlugin::Load(CreateInterfaceFn interfaceFactory, CreateInterfaceFn ga
             addPluginConCommand(new I18nConCommand(i18n, "cssm_teamct", cssm_teamct, "cssm_teamct"));
             addPluginConCommand(new I18nConCommand(i18n, "cssm_swap", cssm_swap, "cssm_swap"));
             addPluginConCommand(new I18nConCommand(i18n, "cssm_spec", cssm_spec, "cssm_spec"));
+            addPluginConCommand(new I18nConCommand(i18n, "cssm_perf", cssm_perf, "cssm_perf"));
+            addPluginConCommand(new I18nConCommand(i18n, "cssm_reload_translations",
+                                                   cssm_reload_translations,
+                                                   "cssm_reload_translations"));
 
             // Hook needed commands
             hookConCommand("say", say_hook, true);
@@ -382,6 +416,63 @@ bool ServerPlugin::Load(CreateInterfaceFn interfaceFactory, CreateInterfaceFn ga
                 Msg(CSSMATCH_NAME ": %s (%s, l.%i)\n", e.getMessage().c_str(), __FILE__, __LINE__);
             }
 
+            // Start the report writing thread
+            try
+            {
+                reportThread = new ReportWriter();
+                reportThread->start();
+            }
+            catch(const ThreadException & e)
+            {
+                Msg(CSSMATCH_NAME ": %s (%s, l.%i)\n", e.getMessage().c_str(), __FILE__, __LINE__);
+                delete reportThread;
+                reportThread = NULL;
+            }
+
+            // Start the clan name detection thread
+            try
+            {
+                clanDetectionThread = new ClanDetectionThread();
+                clanDetectionThread->start();
+            }
+            catch(const ThreadException & e)
+            {
+                Msg(CSSMATCH_NAME ": %s (%s, l.%i)\n", e.getMessage().c_str(), __FILE__, __LINE__);
+                delete clanDetectionThread;
+                clanDetectionThread = NULL;
+            }
+
+            // Start the worker threads
+            try
+            {
+                workerPool = new ThreadPool(CSSMATCH_WORKER_THREADS);
+                workerPool->start();
+            }
+            catch(const ThreadException & e)
+            {
+                Msg(CSSMATCH_NAME ": %s (%s, l.%i)\n", e.getMessage().c_str(), __FILE__, __LINE__);
+                if (workerPool != NULL)
+                {
+                    try
+                    {
+                        workerPool->stop();
+                    }
+                    catch(const ThreadException &)
+                    {
+                    }
+                }
+                delete workerPool;
+                workerPool = NULL;
+            }
+
+            // The configuration files are executed after the plugin load, so the translations
+            // are loaded by LevelInit, once cssmatch_preload_translations is set. But if a map is
+            // already running (plugin_load), they are needed before the next LevelInit, and no
+            // configuration file could have set the new ConVar
+            const char * mapName = interfaces.gpGlobals->mapname.ToCStr();
+            if ((mapName != NULL) && (*mapName != '\0'))
+                i18n->preloadTranslations();
+
             Msg(CSSMATCH_NAME ": loaded\n");
         }
     }
@@ -402,12 +493,21 @@ void ServerPlugin::Unload()
     instances--;
     if (instances == 0)
     {
+        if (interfaces.engine != NULL)
+            commands.flush(interfaces.engine);
+
+        if (interfaces.gameeventmanager2 != NULL)
+            interfaces.gameeventmanager2->RemoveListener(&players);
+
         if (updateThread != NULL)
         {
             try
             {
                 updateThread->end();
                 updateThread->join();
+
+                // Nothing must refer to the thread once deleted
+                gameThreadQueue.process();
             }
             catch (const ThreadException & e)
             {
@@ -416,6 +516,57 @@ void ServerPlugin::Unload()
             delete updateThread;
             updateThread = NULL;
         }
+
+        if (reportThread != NULL)
+        {
+            // The pending reports are written before the thread exits
+            try
+            {
+                reportThread->end();
+                reportThread->join();
+                reportThread->processCompletions();
+            }
+            catch (const ThreadException & e)
+            {
+                Msg(CSSMATCH_NAME ": %s (%s, l.%i)\n", e.getMessage().c_str(), __FILE__, __LINE__);
+            }
+            delete reportThread;
+            reportThread = NULL;
+        }
+
+        if (clanDetectionThread != NULL)
+        {
+            // The pending detections are dropped
+            try
+            {
+                clanDetectionThread->end();
+                clanDetectionThread->join();
+            }
+            catch (const ThreadException & e)
+            {
+                Msg(CSSMATCH_NAME ": %s (%s, l.%i)\n", e.getMessage().c_str(), __FILE__, __LINE__);
+            }
+            delete clanDetectionThread;
+            clanDetectionThread = NULL;
+        }
+
+        if (workerPool != NULL)
+        {
+            // The pending tasks run before the workers exit
+            try
+            {
+                workerPool->stop();
+
+                // Nothing must refer to the tasks once deleted
+                gameThreadQueue.process();
+            }
+            catch (const ThreadException & e)
+            {
+                Msg(CSSMATCH_NAME ": %s (%s, l.%i)\n", e.getMessage().c_str(), __FILE__, __LINE__);
+            }
+            delete workerPool;
+            workerPool = NULL;
+        }
         ConVar_Unregister();
         if (loadSuccess) // Disconnect tier1 libraries if Load() returned false crashes the server
             DisconnectTier1Libraries();
@@ -439,9 +590,61 @@ void ServerPlugin::SetCommandClient(int index)
     clientCommandIndex = index;
 }
 
-list<ClanMember *> * ServerPlugin::getPlayerlist()
+const PlayerList * ServerPlugin::getPlayerlist() const
+{
+    return players.getPlayers();
+}
+
+const PlayerSnapshot * ServerPlugin::getPlayerSnapshot(int index)
+{
+    return players.getSnapshot(index);
+}
+
+const PlayerList * ServerPlugin::getTeamMembers(TeamCode team)
+{
+    return players.getTeamMembers(team);
+}
+
+void ServerPlugin::invalidatePlayerSnapshot()
+{
+    players.invalidateSnapshot();
+}
+
+void ServerPlugin::readPlayerProps(PlayerPropsSnapshot & props) const
 {
-    return &playerlist;
+    players.readProps(props);
+}
+
+bool ServerPlugin::getPlayer(const PlayerHavingIndex & pred, ClanMember * & out)
+{
+    out = players.findByIndex(pred.index);
+    return out != NULL;
+}
+
+bool ServerPlugin::getPlayer(const PlayerHavingUserid & pred, ClanMember * & out)
+{
+    out = players.findByUserid(pred.userid);
+    return out != NULL;
+}
+
+bool ServerPlugin::getPlayer(const PlayerHavingSteamid & pred, ClanMember * & out)
+{
+    out = players.findBySteamid(pred.steamid);
+    return out != NULL;
+}
+
+bool ServerPlugin::getPlayer(const PlayerHavingPEntity & pred, ClanMember * & out)
+{
+    out = NULL;
+
+    if (isValidEntity(pred.pEntity))
+    {
+        ClanMember * player = players.findByIndex(interfaces.engine->IndexOfEdict(pred.pEntity));
+        if ((player != NULL) && (player->getIdentity()->pEntity == pred.pEntity))
+            out = player;
+    }
+
+    return out != NULL;
 }
 
 UpdateNotifier * ServerPlugin::getUpdateThread() const
@@ -449,6 +652,21 @@ UpdateNotifier * ServerPlugin::getUpdateThread() const
     return updateThread;
 }
 
+ReportWriter * ServerPlugin::getReportThread() const
+{
+    return reportThread;
+}
+
+ClanDetectionThread * ServerPlugin::getClanDetectionThread() const
+{
+    return clanDetectionThread;
+}
+
+ThreadPool * ServerPlugin::getWorkerPool() const
+{
+    return workerPool;
+}
+
 list<string> * ServerPlugin::getAdminlist()
 {
     return &adminlist;
@@ -488,8 +706,9 @@ void ServerPlugin::showChangelevelMenu(Player * player)
 
 void ServerPlugin::constructPlayerlistMenu(Menu * to)
 {
-    list<ClanMember *>::const_iterator itPlayer;
-    for(itPlayer = playerlist.begin(); itPlayer != playerlist.end(); itPlayer++)
+    const PlayerList * playerlist = players.getPlayers();
+    PlayerList::const_iterator itPlayer;
+    for(itPlayer = playerlist->begin(); itPlayer != playerlist->end(); itPlayer++)
     {
         IPlayerInfo * pInfo = (*itPlayer)->getPlayerInfo();
         if (isValidPlayerInfo(pInfo))
@@ -584,7 +803,7 @@ void ServerPlugin::changelevelMenuCallback(Player * player, int choice, MenuLine
             map<string, string> parameters;
             parameters["$map"] = mapname;
 
-            i18n->i18nChatSay(recipients, "admin_map_not_found", parameters);
+            i18n->i18nChatSay(recipients, ADMIN_MAP_NOT_FOUND, parameters);
         }
     }
     player->quitMenu();
@@ -612,13 +831,13 @@ void ServerPlugin::swapMenuCallback(Player * player, int choice, MenuLine * sele
             {
                 recipients.addAllPlayers();
                 parameters["$admin"] = pInfo->GetName();
-                i18n->i18nChatSay(recipients, "admin_swap", parameters, pIdentity->index);
+                i18n->i18nChatSay(recipients, ADMIN_SWAP, parameters, pIdentity->index);
             }
         }
         else
         {
             recipients.addRecipient(player);
-            i18n->i18nChatSay(recipients, "admin_is_not_connected", parameters);
+            i18n->i18nChatSay(recipients, ADMIN_IS_NOT_CONNECTED, parameters);
         }
         showSwapMenu(player);
     }
@@ -648,13 +867,13 @@ void ServerPlugin::specMenuCallback(Player * player, int choice, MenuLine * sele
             {
                 recipients.addAllPlayers();
                 parameters["$admin"] = pInfo->GetName();
-                i18n->i18nChatSay(recipients, "admin_spec", parameters, pIdentity->index);
+                i18n->i18nChatSay(recipients, ADMIN_SPEC, parameters, pIdentity->index);
             }
         }
         else
         {
             recipients.addRecipient(player);
-            i18n->i18nChatSay(recipients, "admin_is_not_connected", parameters);
+            i18n->i18nChatSay(recipients, ADMIN_IS_NOT_CONNECTED, parameters);
         }
         showSpecMenu(player);
     }
@@ -685,13 +904,13 @@ void ServerPlugin::kickMenuCallback(Player * player, int choice, MenuLine * sele
             {
                 recipients.addAllPlayers();
                 parameters["$admin"] = pInfo->GetName();
-                i18n->i18nChatSay(recipients, "admin_kick_by", parameters, pIdentity->index);
+                i18n->i18nChatSay(recipients, ADMIN_KICK_BY, parameters, pIdentity->index);
             }
         }
         else
         {
             recipients.addRecipient(player);
-            i18n->i18nChatSay(recipients, "admin_is_not_connected", parameters);
+            i18n->i18nChatSay(recipients, ADMIN_IS_NOT_CONNECTED, parameters);
         }
         showKickMenu(player);
     }
@@ -749,17 +968,17 @@ void ServerPlugin::bantimeMenuCallback(Player * player, int choice, MenuLine * s
                 parameters["$admin"] = adminInfo->GetName();
 
                 if (time == 0)
-                    i18n->i18nChatSay(recipients, "admin_permanently_ban", parameters,
+                    i18n->i18nChatSay(recipients, ADMIN_PERMANENTLY_BAN, parameters,
                                       pIdentity->index);
                 else
-                    i18n->i18nChatSay(recipients, "admin_temporaly_ban", parameters,
+                    i18n->i18nChatSay(recipients, ADMIN_TEMPORALY_BAN, parameters,
                                       pIdentity->index);
             }
         }
         else
         {
             recipients.addRecipient(player);
-            i18n->i18nChatSay(recipients, "admin_is_not_connected", parameters);
+            i18n->i18nChatSay(recipients, ADMIN_IS_NOT_CONNECTED, parameters);
         }
         showBanMenu(player);
         // FIXME: last banned player still appear because kickid is not yet executed here
@@ -845,18 +1064,12 @@ I18nManager * ServerPlugin::getI18nManager()
 
 void ServerPlugin::addTimer(BaseTimer * timer)
 {
-    timers.push_front(timer);
-    // push front, to allow timer invoking others timers, which could have to be immediately
-    // executed
+    timers.add(timer);
+    // a timer added by another timer is never executed during the same frame (see TimerWheel)
 }
 
 void ServerPlugin::removeTimers()
 {
-    list<BaseTimer *>::iterator itTimer;
-    for(itTimer = timers.begin(); itTimer != timers.end(); itTimer++)
-    {
-        delete *itTimer;
-    }
     timers.clear();
 }
 
@@ -896,16 +1109,52 @@ void ServerPlugin::LevelInit(char const * pMapName)
 
     // Workaround for CS:S OB (see MakePublicTimer)
     addTimer(new MakePublicTimer());
+
+    // Make the translations ready now, rather than during a match (the translation files
+    // modified since the last map are picked up too)
+    if (getConVar("cssmatch_preload_translations")->GetBool())
+        i18n->preloadTranslations();
+    else
+        i18n->loadTranslations(false);
 }
 
 void ServerPlugin::ServerActivate(edict_t * pEdictList, int edictCount, int clientMax)
 {
+    // Index the props offsets (if not done by Load), rather than on the first use of each prop
+    // during the match
+    PropOffsetCache::getInstance()->build();
 }
 
 void ServerPlugin::GameFrame(bool simulating)
 {
+    // The player states may have changed since the last frame
+    players.nextFrame();
+
+    // Process the log lines and callbacks posted by the worker threads
+    gameThreadQueue.process();
+
+    // Use the translations loaded in background, if ready
+    i18n->publishTranslations();
+
+    // Print the results of the reports written in background
+    if (reportThread != NULL)
+        reportThread->processCompletions();
+
+    // Apply the clan names detected in background
+    if (clanDetectionThread != NULL)
+        clanDetectionThread->processResults();
+
+    // Remove the entities queued during the last frame
+    EntityRemover::getInstance()->flush();
+
     // Execute and remove the timers out of date
-    timers.remove_if(TimerOutOfDate(interfaces.gpGlobals->curtime));
+    {
+        CSSMATCH_PROFILE("GameFrame timers")
+        timers.advance(interfaces.gpGlobals->curtime);
+    }
+
+    // Send the commands issued during this frame at once
+    commands.endFrame(interfaces.engine);
 }
 
 void ServerPlugin::LevelShutdown() // !!!!this can get called multiple times per map change
@@ -921,7 +1170,7 @@ void ServerPlugin::ClientDisconnect(edict_t * pEntity)
     ClanMember * toRemove = NULL;
     CSSMATCH_VALID_PLAYER(PlayerHavingPEntity, pEntity, toRemove)
     {
-        playerlist.remove(toRemove);
+        players.remove(toRemove);
         delete toRemove;
     }
 }
@@ -932,13 +1181,11 @@ void ServerPlugin::ClientPutInServer(edict_t * pEntity, char const * playername)
     if (isValidPlayerInfoIndex(index, interfaces.gpGlobals->maxClients))
     {
         // First remove the player if he's already in the list
-        list<ClanMember *>::iterator invalidPlayer = playerlist.end();
-        list<ClanMember *>::iterator itPlayer =
-            find_if(playerlist.begin(), invalidPlayer, PlayerHavingIndex(index));
-        if (itPlayer != invalidPlayer)
+        ClanMember * previous = players.findByIndex(index);
+        if (previous != NULL)
         {
-            delete (*itPlayer);
-            playerlist.erase(itPlayer);
+            players.remove(previous);
+            delete previous;
         }
 
         // Then add the new player to the player list
@@ -948,7 +1195,7 @@ void ServerPlugin::ClientPutInServer(edict_t * pEntity, char const * playername)
             bool isReferee = find(
                 adminlist.begin(), invalidSteamid,
                 interfaces.engine->GetPlayerNetworkIDString(pEntity)) != invalidSteamid;
-            playerlist.push_back(new ClanMember(index, isReferee));
+            players.add(new ClanMember(index, isReferee));
         }
         catch(const PlayerException & e)
         {
@@ -959,6 +1206,9 @@ void ServerPlugin::ClientPutInServer(edict_t * pEntity, char const * playername)
 
 void ServerPlugin::ClientSettingsChanged(edict_t * pEdict)
 {
+    ClanMember * player = NULL;
+    if (getPlayer(PlayerHavingPEntity(pEdict), player))
+        player->updateLanguage();
 }
 
 PLUGIN_RESULT ServerPlugin::ClientConnect(bool * bAllowConnect,
@@ -973,6 +1223,7 @@ PLUGIN_RESULT ServerPlugin::ClientConnect(bool * bAllowConnect,
 
 PLUGIN_RESULT ServerPlugin::ClientCommand(edict_t * pEntity, const CCommand &args)
 {
+    CSSMATCH_PROFILE("ClientCommand")
     PLUGIN_RESULT result = PLUGIN_CONTINUE;
 
     try
@@ -1041,40 +1292,52 @@ void ServerPlugin::OnQueryCvarValueFinished(QueryCvarCookie_t iCookie, edict_t *
 
 void ServerPlugin::log(const std::string & message) const
 {
-    ostringstream buffer;
-    buffer << CSSMATCH_NAME << ": " << message << "\n";
-    const string & toLog = buffer.str();
-    interfaces.engine->LogPrint(toLog.c_str());
+    if (gameThreadQueue.isGameThread())
+    {
+        ostringstream buffer;
+        buffer << CSSMATCH_NAME << ": " << message << "\n";
+        const string & toLog = buffer.str();
+        interfaces.engine->LogPrint(toLog.c_str());
+    }
+    else // the engine must not be called from a worker thread
+        gameThreadQueue.postLog(message);
+}
+
+GameThreadQueue * ServerPlugin::getGameThreadQueue()
+{
+    return &gameThreadQueue;
 }
 
 void ServerPlugin::queueCommand(const string & command) const
 {
-    interfaces.engine->ServerCommand(command.c_str());
+    commands.append(interfaces.engine, command);
 }
 
 void ServerPlugin::executeCommand(const std::string & command) const
 {
     //interfaces.engine->InsertServerCommand(command.c_str());
     queueCommand(command);
-    interfaces.engine->ServerExecute();
+    commandBarrier();
 }
 
-bool ServerPlugin::hltvConnected() const
+void ServerPlugin::commandBarrier() const
 {
-    list<ClanMember *>::const_iterator invalidPlayer = playerlist.end();
-    return find_if(playerlist.begin(), invalidPlayer, PlayerIsHltv()) != invalidPlayer;
+    commands.barrier(interfaces.engine);
 }
 
-int ServerPlugin::getPlayerCount(TeamCode team) const
+CommandBuffer * ServerPlugin::getCommandBuffer()
 {
-    int playerCount = 0;
+    return &commands;
+}
 
-    if (team == INVALID_TEAM)
-        playerCount = (int)playerlist.size();
-    else
-        playerCount = count_if(playerlist.begin(), playerlist.end(), PlayerHavingTeam(team));
+bool ServerPlugin::hltvConnected()
+{
+    return players.isHltvConnected();
+}
 
-    return playerCount;
+int ServerPlugin::getPlayerCount(TeamCode team)
+{
+    return players.getTeamCount(team);
 }
 /*string ServerPlugin::getGameDir() const
 {
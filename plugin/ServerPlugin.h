@@ -30,11 +30,15 @@
 #include "../messages/RecipientFilter.h"
 #include "../misc/BaseSingleton.h"
 #include "../player/ClanMember.h"
+#include "../player/PlayerRegistry.h"
 #include "../exceptions/BaseException.h"
 #include "../commands/ConCommandCallbacks.h"
 #include "../commands/ClientCommandCallbacks.h"
 #include "../commands/ConCommandHook.h"
 #include "../messages/Menu.h"
+#include "TimerWheel.h"
+#include "CommandBuffer.h"
+#include "GameThreadQueue.h"
 
 #include "engine/iserverplugin.h"
 
@@ -57,6 +61,13 @@ class ConCommand;
 #include <algorithm>
 #include <sstream>
 
+#define CSSMATCH_WORKER_THREADS 2 // Number of threads running the background tasks
+
+namespace threading
+{
+    class ThreadPool;
+}
+
 namespace cssmatch
 {
     class ConvarsAccessor;
@@ -65,6 +76,8 @@ namespace cssmatch
     class BaseTimer;
     class MatchManager;
     class UpdateNotifier;
+    class ReportWriter;
+    class ClanDetectionThread;
 
 /** Valve's interface instances */
     struct ValveInterfaces
@@ -139,6 +152,15 @@ namespace cssmatch
         /** Search-for-update thread */
         UpdateNotifier * updateThread;
 
+        /** Report writing thread */
+        ReportWriter * reportThread;
+
+        /** Clan name detection thread */
+        ClanDetectionThread * clanDetectionThread;
+
+        /** Worker threads running the background tasks */
+        threading::ThreadPool * workerPool;
+
         /** Valve's interfaces accessor */
         ValveInterfaces interfaces;
 
@@ -146,7 +168,7 @@ namespace cssmatch
         int clientCommandIndex;
 
         /** Global playerlist */
-        std::list<ClanMember *> playerlist;
+        PlayerRegistry players;
 
         /** Referee steamid list */
         std::list<std::string> adminlist;
@@ -158,8 +180,14 @@ namespace cssmatch
         /** Match manager */
         MatchManager * match;
 
-        /** Timer list */
-        std::list<BaseTimer *> timers;
+        /** Pending timers */
+        TimerWheel timers;
+
+        /** Server commands issued during the current frame */
+        mutable CommandBuffer commands;
+
+        /** Log lines and callbacks posted by the worker threads */
+        mutable GameThreadQueue gameThreadQueue;
 
         /** Plugin console variable list */
         std::map<std::string, ConVar *> pluginConVars;
@@ -251,11 +279,20 @@ namespace cssmatch
         virtual void SetCommandClient(int index);
 
         /** Get the global playerlist */
-        std::list<ClanMember *> * getPlayerlist();
+        const PlayerList * getPlayerlist() const;
 
         /** Get the update notifier thread (maybe NULL) */
         UpdateNotifier * getUpdateThread() const;
 
+        /** Get the report writing thread (maybe NULL) */
+        ReportWriter * getReportThread() const;
+
+        /** Get the clan name detection thread (maybe NULL) */
+        ClanDetectionThread * getClanDetectionThread() const;
+
+        /** Get the worker thread pool (maybe NULL) */
+        threading::ThreadPool * getWorkerPool() const;
+
         /** Get a player
          * @param pred Predicat to use
          * @param out Out var
@@ -266,9 +303,10 @@ namespace cssmatch
         {
             bool found = false;
 
-            std::list<ClanMember *>::iterator invalidPlayer = playerlist.end();
-            std::list<ClanMember *>::iterator itPlayer = std::find_if(
-                playerlist.begin(), invalidPlayer, pred);
+            const PlayerList * playerlist = players.getPlayers();
+            PlayerList::const_iterator invalidPlayer = playerlist->end();
+            PlayerList::const_iterator itPlayer = std::find_if(
+                playerlist->begin(), invalidPlayer, pred);
             if (itPlayer != invalidPlayer)
             {
                 found = true;
@@ -280,6 +318,29 @@ namespace cssmatch
             return found;
         }
 
+        /** Get the snapshot of a player state for the current frame
+         * @param index The player index
+         * @return The snapshot, or NULL if there is no player at this index
+         */
+        const PlayerSnapshot * getPlayerSnapshot(int index);
+
+        /** Get the players of a team (read from the current frame snapshot) */
+        const PlayerList * getTeamMembers(TeamCode team);
+
+        /** Tell that the state of a player changed, e.g. after a team change */
+        void invalidatePlayerSnapshot();
+
+        /** Read the entity props of all players in one pass
+         * @param props Receives the props
+         */
+        void readPlayerProps(PlayerPropsSnapshot & props) const;
+
+        // Constant-time lookups through the player registry
+        bool getPlayer(const PlayerHavingIndex & pred, ClanMember * & out);
+        bool getPlayer(const PlayerHavingUserid & pred, ClanMember * & out);
+        bool getPlayer(const PlayerHavingSteamid & pred, ClanMember * & out);
+        bool getPlayer(const PlayerHavingPEntity & pred, ClanMember * & out);
+
         /** Get the referee steamid list (read and write) */
         std::list<std::string> * getAdminlist();
 
@@ -372,31 +433,44 @@ namespace cssmatch
 
         // Tools
 
-        /** Print a message to the logs
+        /** Print a message to the logs <br>
+         * If the caller is not the game thread, the message is logged at the next server frame
          * @param message The message to display
          */
         void log(const std::string & message) const;
 
-        /** Append a command to the server command queue
+        /** Get the queue used by the worker threads to post messages to the game thread */
+        GameThreadQueue * getGameThreadQueue();
+
+        /** Append a command to the server command queue <br>
+         * The commands queued during a frame are sent to the server at once, at the end of the
+         * frame
          * @param command The command to append
          */
         void queueCommand(const std::string & command) const;
 
-        /** Immedialty execute a command into the server console
+        /** Immedialty execute a command into the server console <br>
+         * The commands queued before are executed first
          * @param command The command to execute
          */
         void executeCommand(const std::string & command) const;
 
+        /** Immedialty execute the commands queued during this frame */
+        void commandBarrier() const;
+
+        /** Get the buffer of the commands queued during this frame (e.g. for its counters) */
+        CommandBuffer * getCommandBuffer();
+
         /** Check if SourceTV is connected to the server (ignores tv_enable)
          * @return <code>true</code> if SourceTV was found, <code>false</code> otherwise
          */
-        bool hltvConnected() const;
+        bool hltvConnected();
 
         /** Get the current player count (ignores SourceTv)
          * @param team If specified, only count the player from this team
          * @return The player count
          */
-        int getPlayerCount(TeamCode team = INVALID_TEAM) const;
+        int getPlayerCount(TeamCode team = INVALID_TEAM);
 
         /* Returns the game directory name */
         //std::string getGameDir() const;
@@ -409,7 +483,7 @@ namespace cssmatch
 
 /** Search for a valid player pointer satisfying a predicat */
 #define CSSMATCH_VALID_PLAYER(Predicat, criteria, out) \
-    if (ServerPlugin::getInstance()->getPlayer<Predicat>(Predicat(criteria), out))
+    if (ServerPlugin::getInstance()->getPlayer(Predicat(criteria), out))
 }
 
 #endif // __SERVER_PLUGIN_H__
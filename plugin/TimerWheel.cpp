@@ -0,0 +1,273 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "TimerWheel.h"
+#include "BaseTimer.h"
+
+using namespace cssmatch;
+
+unsigned int TimerWheel::toTick(float date)
+{
+    unsigned int tick = 0;
+
+    if (date > 0.0f)
+        tick = (unsigned int)(date * TIMER_WHEEL_RESOLUTION);
+
+    return tick;
+}
+
+void TimerWheel::link(BaseTimer ** head, BaseTimer * timer)
+{
+    timer->next = *head;
+    if (timer->next != NULL)
+        timer->next->prevLink = &timer->next;
+    timer->prevLink = head;
+    *head = timer;
+}
+
+void TimerWheel::unlink(BaseTimer * timer)
+{
+    if (timer->prevLink != NULL)
+    {
+        *timer->prevLink = timer->next;
+        if (timer->next != NULL)
+            timer->next->prevLink = timer->prevLink;
+
+        timer->next = NULL;
+        timer->prevLink = NULL;
+    }
+}
+
+void TimerWheel::deleteList(BaseTimer ** head)
+{
+    while(*head != NULL)
+    {
+        BaseTimer * timer = *head;
+        unlink(timer);
+        delete timer;
+    }
+}
+
+void TimerWheel::place(BaseTimer * timer)
+{
+    unsigned int expires = toTick(timer->date);
+    if (expires < currentTick)
+        expires = currentTick;
+
+    // Find the level which covers the remaining delay
+    unsigned int delta = expires - currentTick;
+    int level = 0;
+    while((level < TIMER_WHEEL_LEVELS - 1) &&
+          (delta >= (1u << ((level + 1) * TIMER_WHEEL_BITS))))
+    {
+        level++;
+    }
+
+    // Too far away for the wheel, the timer will be placed again once its bucket is cascaded
+    unsigned int wheelSize = 1u << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_BITS);
+    if (delta >= wheelSize)
+        expires = currentTick + wheelSize - 1;
+
+    link(&buckets[level][(expires >> (level * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK], timer);
+}
+
+void TimerWheel::cascade(int level)
+{
+    BaseTimer ** bucket =
+        &buckets[level][(currentTick >> (level * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK];
+
+    BaseTimer * toPlace = *bucket;
+    *bucket = NULL;
+    if (toPlace != NULL)
+        toPlace->prevLink = &toPlace;
+
+    while(toPlace != NULL)
+    {
+        BaseTimer * timer = toPlace;
+        unlink(timer);
+        place(timer);
+    }
+}
+
+void TimerWheel::runBucket(float currentDate)
+{
+    BaseTimer ** bucket = &buckets[0][currentTick & TIMER_WHEEL_MASK];
+
+    // Detach the bucket, so timers cancelled/cleared by the executed ones are correctly unlinked
+    running = *bucket;
+    *bucket = NULL;
+    if (running != NULL)
+        running->prevLink = &running;
+
+    while(running != NULL)
+    {
+        BaseTimer * timer = running;
+        unlink(timer);
+
+        if (timer->date <= currentDate)
+        {
+            timer->wheel = NULL;
+            count--;
+
+            if (! timer->cancelled)
+                timer->execute();
+
+            delete timer;
+        }
+        else // same tick, but not yet out of date
+            link(bucket, timer);
+    }
+}
+
+void TimerWheel::rebase(unsigned int tick)
+{
+    BaseTimer * toPlace = NULL;
+
+    for(int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        for(int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++)
+        {
+            while(buckets[level][slot] != NULL)
+            {
+                BaseTimer * timer = buckets[level][slot];
+                unlink(timer);
+                link(&toPlace, timer);
+            }
+        }
+    }
+
+    currentTick = tick;
+
+    while(toPlace != NULL)
+    {
+        BaseTimer * timer = toPlace;
+        unlink(timer);
+        place(timer);
+    }
+}
+
+TimerWheel::TimerWheel()
+    : currentTick(0), count(0), processing(false), added(NULL), running(NULL), released(NULL)
+{
+    for(int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        for(int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++)
+        {
+            buckets[level][slot] = NULL;
+        }
+    }
+}
+
+TimerWheel::~TimerWheel()
+{
+    clear();
+}
+
+void TimerWheel::add(BaseTimer * timer)
+{
+    timer->wheel = this;
+    count++;
+
+    if (processing)
+        link(&added, timer);
+    else
+        place(timer);
+}
+
+void TimerWheel::release(BaseTimer * timer)
+{
+    if (timer->wheel == this)
+    {
+        timer->wheel = NULL;
+        count--;
+
+        unlink(timer);
+        link(&released, timer);
+    }
+}
+
+void TimerWheel::advance(float currentDate)
+{
+    unsigned int target = toTick(currentDate);
+
+    if (count == 0)
+        // Nothing to execute, skip the empty buckets
+        currentTick = target;
+    else if ((target < currentTick) || (target - currentTick > TIMER_WHEEL_SLOTS * TIMER_WHEEL_SLOTS))
+        // Server time went backward or jumped, walking each tick would be useless
+        rebase(target);
+
+    processing = true;
+    while(true)
+    {
+        runBucket(currentDate);
+
+        if (currentTick == target)
+            break;
+
+        currentTick++;
+
+        // Cascade the higher levels whose bucket just started, from the highest one
+        int toCascade = 0;
+        while((toCascade < TIMER_WHEEL_LEVELS - 1) &&
+              ((currentTick & ((1u << ((toCascade + 1) * TIMER_WHEEL_BITS)) - 1)) == 0))
+        {
+            toCascade++;
+        }
+        for(int level = toCascade; level > 0; level--)
+        {
+            cascade(level);
+        }
+    }
+    processing = false;
+
+    // Now schedule the timers added during this pass
+    while(added != NULL)
+    {
+        BaseTimer * timer = added;
+        unlink(timer);
+        place(timer);
+    }
+
+    deleteList(&released);
+}
+
+void TimerWheel::clear()
+{
+    for(int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        for(int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++)
+        {
+            deleteList(&buckets[level][slot]);
+        }
+    }
+
+    deleteList(&added);
+    deleteList(&running);
+    deleteList(&released);
+
+    count = 0;
+}
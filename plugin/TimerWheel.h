@@ -0,0 +1,135 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __TIMER_WHEEL_H__
+#define __TIMER_WHEEL_H__
+
+#include "../misc/CannotBeCopied.h"
+
+#include <cstddef> // size_t
+
+/** Number of wheel levels */
+#define TIMER_WHEEL_LEVELS 4
+
+/** Bits of the tick used to index a bucket in one level */
+#define TIMER_WHEEL_BITS 6
+
+/** Number of buckets per level */
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+
+/** Mask to get a bucket index in one level */
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+
+/** Number of wheel ticks per server time second */
+#define TIMER_WHEEL_RESOLUTION 64.0f
+
+namespace cssmatch
+{
+    class BaseTimer;
+
+    /** Hierarchical timing wheel which schedules the plugin timers <br>
+     * Adding or cancelling a timer costs O(1), and each server frame only the buckets which become
+     * due are visited. <br>
+     * A timer added while the wheel is executing timers is never executed during the same pass
+     * (as the former push-front list did), so a timer can safely schedule other timers.
+     */
+    class TimerWheel : public CannotBeCopied
+    {
+    private:
+        /** Timer buckets, one list per level and slot */
+        BaseTimer * buckets[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+
+        /** Next wheel tick to process */
+        unsigned int currentTick;
+
+        /** Number of pending timers (not cancelled, not executed) */
+        size_t count;
+
+        /** Are we executing timers? */
+        bool processing;
+
+        /** Timers added while executing timers, scheduled once the pass is over */
+        BaseTimer * added;
+
+        /** Timers of the bucket being executed */
+        BaseTimer * running;
+
+        /** Cancelled timers, deleted at the end of the next pass */
+        BaseTimer * released;
+
+        /** Convert a server time date to a wheel tick */
+        static unsigned int toTick(float date);
+
+        /** Insert a timer at the head of a list */
+        static void link(BaseTimer ** head, BaseTimer * timer);
+
+        /** Remove a timer from the list which contains it */
+        static void unlink(BaseTimer * timer);
+
+        /** Delete every timer of a list */
+        static void deleteList(BaseTimer ** head);
+
+        /** Put a timer into the bucket matching its execution date */
+        void place(BaseTimer * timer);
+
+        /** Redistribute the current bucket of a level into the lower levels */
+        void cascade(int level);
+
+        /** Execute the due timers of the current level 0 bucket
+         * @param currentDate The current server time
+         */
+        void runBucket(float currentDate);
+
+        /** Re-place all timers relative to a new current tick <br>
+         * Used when the server time goes backward or jumps far away
+         */
+        void rebase(unsigned int tick);
+    public:
+        TimerWheel();
+        ~TimerWheel();
+
+        /** Schedule a timer (the wheel becomes its owner)
+         * @param timer The timer to schedule
+         */
+        void add(BaseTimer * timer);
+
+        /** Unschedule a cancelled timer <br>
+         * The timer is deleted at the end of the next pass, so its pointer stays valid until then
+         * @param timer The timer to unschedule
+         */
+        void release(BaseTimer * timer);
+
+        /** Execute and delete the timers out of date
+         * @param currentDate The current server time
+         */
+        void advance(float currentDate);
+
+        /** Delete all timers */
+        void clear();
+    };
+}
+
+#endif // __TIMER_WHEEL_H__
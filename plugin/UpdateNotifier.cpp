@@ -117,16 +117,9 @@ void UpdateNotifier::query(const SOCKADDR_IN & serv, const SOCKET & socketfd,
                 while(getline(stream, temp)) {} // get the last line
 
                 // Update the last version name found
-                try
-                {
-                    mutex.lock();
-                    version = temp;
-                    mutex.unlock();
-                }
-                catch (const ThreadException & e)
-                {
-                    CSSMATCH_PRINT(e.getMessage());
-                }
+                GameThreadQueue * queue = ServerPlugin::getInstance()->getGameThreadQueue();
+                if (! queue->postCallback(setLastVer, this, temp))
+                    CSSMATCH_PRINT("Unable to post the last version found");
             }
 #ifdef _DEBUG
             else
@@ -183,30 +176,22 @@ void UpdateNotifier::run()
             }
             lastCheckDate = curtime;
         }
-        threading::sleep(1000);
+        wakeUp.wait(1000);
     }
 }
 
 void UpdateNotifier::end()
 {
     alive = false;
+    wakeUp.set();
 }
 
-std::string UpdateNotifier::getLastVer()
+void UpdateNotifier::setLastVer(void * notifier, const string & lastVersion)
 {
-    string result;
-
-    try
-    {
-        mutex.lock();
-        result = version;
-        mutex.unlock();
-    }
-    catch (const ThreadException & e)
-    {
-        CSSMATCH_PRINT(e.getMessage());
-        result = CSSMATCH_VERSION;
-    }
+    static_cast<UpdateNotifier *>(notifier)->version = lastVersion;
+}
 
-    return result;
+std::string UpdateNotifier::getLastVer()
+{
+    return version;
 }
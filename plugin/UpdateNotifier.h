@@ -83,17 +83,25 @@ namespace cssmatch
     class UpdateNotifier : public threading::Thread
     {
     private:
-        /** Last plugin version found */
+        /** Last plugin version found (only accessed by the game thread) */
         std::string version;
 
         /** Last check for new version date */
         std::time_t lastCheckDate;
 
         volatile bool alive; // thread can continue?
-        threading::Mutex mutex;
 
-        /** Query the server and update "version" */
+        /** Signaled by end() so the thread does not sleep until its next poll */
+        threading::Event wakeUp;
+
+        /** Query the server and post the version found to the game thread */
         void query(const SOCKADDR_IN & serv, const SOCKET & socketfd, const std::string & hostname);
+
+        /** Update "version" (called on the game thread)
+         * @param notifier The UpdateNotifier instance
+         * @param lastVersion The version found
+         */
+        static void setLastVer(void * notifier, const std::string & lastVersion);
     public:
         /**
          * @throws UpdateNotifierException If the socket api cannot being initialized
@@ -107,9 +115,10 @@ namespace cssmatch
          */
         void run();
 
-        /** Tell to the thread that it must exit */
+        /** Tell to the thread that it must exit, and wake it up */
         void end();
 
+        /** Get the last plugin version found (game thread only) */
         std::string getLastVer();
     };
 }
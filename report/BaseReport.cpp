@@ -57,3 +57,8 @@ BaseReport::BaseReport(MatchManager * matchManager) : match(matchManager)
 
 BaseReport::~BaseReport()
 {}
+
+const std::string & BaseReport::getPath() const
+{
+    return reportPath;
+}
@@ -27,6 +27,8 @@
 #ifndef __BASE_REPORT_H__
 #define __BASE_REPORT_H__
 
+#include "../exceptions/BaseException.h"
+
 #include <string>
 
 /** Default report folder */
@@ -36,6 +38,12 @@ namespace cssmatch
 {
     class MatchManager;
 
+    class ReportException : public BaseException
+    {
+    public:
+        ReportException(const std::string & message) : BaseException(message){}
+    };
+
     /** Base class to write reports */
     class BaseReport
     {
@@ -52,8 +60,13 @@ namespace cssmatch
         BaseReport(MatchManager * matchManager);
         virtual ~BaseReport();
 
-        /** Write the file on the disk */
-        virtual void write() = 0;
+        /** Write the file on the disk
+         * @throws ReportException if the file cannot be written
+         */
+        virtual void write() throw(ReportException) = 0;
+
+        /** Get the report path (without extension) */
+        const std::string & getPath() const;
     };
 }
 
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __JOURNAL_RECORD_H__
+#define __JOURNAL_RECORD_H__
+
+/* Binary format of the match journal <br>
+ * This header does not depend on the Source SDK, so offline tools can include it. <br>
+ * The file is a JournalFileHeader followed by fixed-size JournalRecord, in the byte order
+ * of the server (little-endian on the supported platforms)
+ */
+
+/** Journal file extension */
+#define JOURNAL_EXTENSION ".journal"
+
+/** First bytes of a journal file */
+#define JOURNAL_MAGIC "CSSMJRNL"
+
+/** Size of JOURNAL_MAGIC without the terminating null character */
+#define JOURNAL_MAGIC_SIZE 8
+
+/** Current version of the format */
+#define JOURNAL_VERSION 1
+
+/** Size of the variable part of a record */
+#define JOURNAL_DATA_SIZE 24
+
+/** Maximum length of a steamid in a record (including the null character) */
+#define JOURNAL_STEAMID_SIZE 20
+
+/** Maximum length of a weapon name in a record (including the null character) */
+#define JOURNAL_WEAPON_SIZE 13
+
+namespace cssmatch
+{
+    /** Journal record types */
+    enum JournalEventType
+    {
+        /** A player is known under this userid */
+        JOURNAL_PLAYER = 1,
+
+        /** A player changed his team */
+        JOURNAL_TEAM,
+
+        /** A player died */
+        JOURNAL_KILL,
+
+        /** A round started, the scores are saved */
+        JOURNAL_ROUND_START,
+
+        /** A round ended */
+        JOURNAL_ROUND_END,
+
+        /** The round was restarted, the scores are restored to the last JOURNAL_ROUND_START */
+        JOURNAL_ROUND_RESTART,
+
+        /** A half started, the scores are saved */
+        JOURNAL_HALF_START,
+
+        /** The half was restarted, the scores are restored to the last JOURNAL_HALF_START */
+        JOURNAL_HALF_RESTART,
+
+        JOURNAL_EVENT_TYPE_COUNT
+    };
+
+    /** Beginning of a journal file */
+    struct JournalFileHeader
+    {
+        /** JOURNAL_MAGIC */
+        char magic[JOURNAL_MAGIC_SIZE];
+
+        /** JOURNAL_VERSION */
+        int version;
+
+        /** sizeof(JournalRecord) */
+        int recordSize;
+
+        /** Number of valid records following the header */
+        int recordCount;
+
+        char reserved[12];
+    };
+
+    /** JOURNAL_PLAYER data */
+    struct JournalPlayerData
+    {
+        int userid;
+        char steamid[JOURNAL_STEAMID_SIZE];
+    };
+
+    /** JOURNAL_TEAM data */
+    struct JournalTeamData
+    {
+        int userid;
+        int team;
+        int oldTeam;
+    };
+
+    /** JOURNAL_KILL data */
+    struct JournalKillData
+    {
+        /** Userid of the attacker (0 if the world) */
+        int attacker;
+
+        /** Userid of the victim */
+        int victim;
+
+        /** Change to the kill count of the attacker (1, -1 for a team kill, 0 if ignored) */
+        signed char attackerScore;
+
+        /** Change to the death count of the victim (1, or 0 if ignored) */
+        signed char victimDeaths;
+
+        /** 1 if headshot */
+        unsigned char headshot;
+
+        char weapon[JOURNAL_WEAPON_SIZE];
+    };
+
+    /** JOURNAL_ROUND_END data */
+    struct JournalRoundEndData
+    {
+        /** Winner team code */
+        int winner;
+
+        /** Reason given by the game */
+        int reason;
+
+        /** 1 if the round was counted in the clan scores */
+        int scored;
+    };
+
+    /** Journal record */
+    struct JournalRecord
+    {
+        /** JournalEventType */
+        unsigned char type;
+
+        /** Half number */
+        unsigned char half;
+
+        /** Round number */
+        short round;
+
+        /** Server time (seconds since the map start) */
+        float time;
+
+        union
+        {
+            JournalPlayerData player;
+            JournalTeamData team;
+            JournalKillData kill;
+            JournalRoundEndData roundEnd;
+            char data[JOURNAL_DATA_SIZE];
+        };
+    };
+
+    // The layout is part of the file format
+    typedef char JournalFileHeaderSizeCheck[(sizeof(JournalFileHeader) == 32) ? 1 : -1];
+    typedef char JournalRecordSizeCheck[(sizeof(JournalRecord) == 32) ? 1 : -1];
+}
+
+#endif // __JOURNAL_RECORD_H__
@@ -0,0 +1,316 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "MatchJournal.h"
+
+#include "../plugin/ServerPlugin.h"
+#include "../match/MatchManager.h"
+#include "../player/ClanMember.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // _WIN32
+
+using namespace cssmatch;
+
+using std::string;
+using std::map;
+
+void MatchJournal::mapView(int recordCapacity) throw(MatchJournalException)
+{
+    size_t size = sizeof(JournalFileHeader) + recordCapacity * sizeof(JournalRecord);
+
+#ifdef _WIN32
+    mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, (DWORD)size, NULL);
+    if (mapping == NULL)
+        throw MatchJournalException("Unable to map " + path);
+
+    view = (char *)MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+    if (view == NULL)
+    {
+        CloseHandle(mapping);
+        mapping = NULL;
+        throw MatchJournalException("Unable to map " + path);
+    }
+#else
+    if (ftruncate(file, size) != 0)
+        throw MatchJournalException("Unable to resize " + path);
+
+    void * address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    if (address == MAP_FAILED)
+        throw MatchJournalException("Unable to map " + path);
+    view = (char *)address;
+#endif // _WIN32
+
+    viewSize = size;
+    header = (JournalFileHeader *)view;
+    records = (JournalRecord *)(view + sizeof(JournalFileHeader));
+    capacity = recordCapacity;
+}
+
+void MatchJournal::unmapView()
+{
+    if (view != NULL)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(view);
+        CloseHandle(mapping);
+        mapping = NULL;
+#else
+        munmap(view, viewSize);
+#endif // _WIN32
+
+        view = NULL;
+        viewSize = 0;
+        header = NULL;
+        records = NULL;
+        capacity = 0;
+    }
+}
+
+void MatchJournal::appendSlow(const JournalRecord & record)
+{
+    if (isOpen())
+    {
+        try
+        {
+            unmapView();
+            mapView(count * 2);
+
+            append(record);
+        }
+        catch(const MatchJournalException & e)
+        {
+            CSSMATCH_PRINT_EXCEPTION(e)
+            close();
+        }
+    }
+}
+
+void MatchJournal::prepare(JournalRecord & record, JournalEventType type) const
+{
+    ServerPlugin * plugin = ServerPlugin::getInstance();
+    ValveInterfaces * interfaces = plugin->getInterfaces();
+    MatchInfo * infos = plugin->getMatch()->getInfos();
+
+    memset(&record, 0, sizeof(record));
+    record.type = (unsigned char)type;
+    record.half = (unsigned char)infos->halfNumber;
+    record.round = (short)infos->roundNumber;
+    record.time = interfaces->gpGlobals->curtime;
+}
+
+MatchJournal::MatchJournal()
+    :
+#ifdef _WIN32
+    file(INVALID_HANDLE_VALUE), mapping(NULL),
+#else
+    file(-1),
+#endif // _WIN32
+    view(NULL), viewSize(0), header(NULL), records(NULL), count(0), capacity(0)
+{
+}
+
+MatchJournal::~MatchJournal()
+{
+    close();
+}
+
+void MatchJournal::open(const string & filePath) throw(MatchJournalException)
+{
+    close();
+
+    path = filePath;
+
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                       CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        throw MatchJournalException("Unable to create " + path);
+#else
+    file = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file == -1)
+        throw MatchJournalException("Unable to create " + path);
+#endif // _WIN32
+
+    try
+    {
+        mapView(JOURNAL_INITIAL_CAPACITY);
+    }
+    catch(const MatchJournalException & e)
+    {
+        close();
+        throw;
+    }
+
+    memcpy(header->magic, JOURNAL_MAGIC, JOURNAL_MAGIC_SIZE);
+    header->version = JOURNAL_VERSION;
+    header->recordSize = sizeof(JournalRecord);
+    header->recordCount = 0;
+    count = 0;
+}
+
+void MatchJournal::close()
+{
+    if (isOpen())
+    {
+        unmapView();
+
+        // Drop the unused space
+        size_t size = sizeof(JournalFileHeader) + count * sizeof(JournalRecord);
+#ifdef _WIN32
+        LONG sizeHigh = 0;
+        SetFilePointer(file, (LONG)size, &sizeHigh, FILE_BEGIN);
+        SetEndOfFile(file);
+        CloseHandle(file);
+        file = INVALID_HANDLE_VALUE;
+#else
+        ftruncate(file, size);
+        ::close(file);
+        file = -1;
+#endif // _WIN32
+    }
+}
+
+bool MatchJournal::isOpen() const
+{
+#ifdef _WIN32
+    return file != INVALID_HANDLE_VALUE;
+#else
+    return file != -1;
+#endif // _WIN32
+}
+
+const string & MatchJournal::getPath() const
+{
+    return path;
+}
+
+int MatchJournal::getRecordCount() const
+{
+    return count;
+}
+
+const JournalRecord * MatchJournal::getRecords() const
+{
+    return records;
+}
+
+void MatchJournal::logPlayer(int userid, const string & steamid)
+{
+    JournalRecord record;
+    prepare(record, JOURNAL_PLAYER);
+    record.player.userid = userid;
+    strncpy(record.player.steamid, steamid.c_str(), JOURNAL_STEAMID_SIZE - 1);
+
+    append(record);
+}
+
+void MatchJournal::logTeam(int userid, int team, int oldTeam)
+{
+    JournalRecord record;
+    prepare(record, JOURNAL_TEAM);
+    record.team.userid = userid;
+    record.team.team = team;
+    record.team.oldTeam = oldTeam;
+
+    append(record);
+}
+
+void MatchJournal::logKill(int attacker, int victim, int attackerScore, int victimDeaths,
+                           bool headshot, const char * weapon)
+{
+    JournalRecord record;
+    prepare(record, JOURNAL_KILL);
+    record.kill.attacker = attacker;
+    record.kill.victim = victim;
+    record.kill.attackerScore = (signed char)attackerScore;
+    record.kill.victimDeaths = (signed char)victimDeaths;
+    record.kill.headshot = headshot ? 1 : 0;
+    strncpy(record.kill.weapon, weapon, JOURNAL_WEAPON_SIZE - 1);
+
+    append(record);
+}
+
+void MatchJournal::logRoundEnd(int winner, int reason, bool scored)
+{
+    JournalRecord record;
+    prepare(record, JOURNAL_ROUND_END);
+    record.roundEnd.winner = winner;
+    record.roundEnd.reason = reason;
+    record.roundEnd.scored = scored ? 1 : 0;
+
+    append(record);
+}
+
+void MatchJournal::logEvent(JournalEventType type)
+{
+    JournalRecord record;
+    prepare(record, type);
+
+    append(record);
+}
+
+void MatchJournal::computeScores(map<int, PlayerScore> & scores) const
+{
+    // Same rules as the ClanMember states (see HalfMatchState::round_start)
+    map<int, PlayerScore> roundStart;
+    map<int, PlayerScore> halfStart;
+
+    for(int i = 0; i < count; i++)
+    {
+        const JournalRecord & record = records[i];
+        switch(record.type)
+        {
+        case JOURNAL_KILL:
+            if (record.kill.victimDeaths != 0)
+                scores[record.kill.victim].deaths += record.kill.victimDeaths;
+            if (record.kill.attackerScore != 0)
+                scores[record.kill.attacker].kills += record.kill.attackerScore;
+            break;
+        case JOURNAL_ROUND_START:
+            roundStart = scores;
+            break;
+        case JOURNAL_ROUND_RESTART:
+            scores = roundStart;
+            break;
+        case JOURNAL_HALF_START:
+            halfStart = scores;
+            break;
+        case JOURNAL_HALF_RESTART:
+            scores = halfStart;
+            break;
+        }
+    }
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __MATCH_JOURNAL_H__
+#define __MATCH_JOURNAL_H__
+
+#include "JournalRecord.h"
+
+#include "../exceptions/BaseException.h"
+#include "../misc/CannotBeCopied.h"
+
+#include <string>
+#include <map>
+
+/** Number of records the journal can hold before its file grows */
+#define JOURNAL_INITIAL_CAPACITY 4096
+
+namespace cssmatch
+{
+    struct PlayerScore;
+
+    class MatchJournalException : public BaseException
+    {
+    public:
+        MatchJournalException(const std::string & message) : BaseException(message){}
+    };
+
+    /** Append-only journal of the match events <br>
+     * The records are copied in a memory-mapped file, so an append is a 32 bytes copy. The
+     * file grows (and is remapped) when full, and is truncated to its content when closed. <br>
+     * Game thread only.
+     */
+    class MatchJournal : public CannotBeCopied
+    {
+    protected:
+        /** The journal path */
+        std::string path;
+
+#ifdef _WIN32
+        /** File handle */
+        void * file;
+
+        /** File mapping handle */
+        void * mapping;
+#else
+        /** File descriptor */
+        int file;
+#endif // _WIN32
+
+        /** The mapped file */
+        char * view;
+
+        /** Size of the mapped file */
+        size_t viewSize;
+
+        /** The file header (start of the view) */
+        JournalFileHeader * header;
+
+        /** The records (after the header) */
+        JournalRecord * records;
+
+        /** Number of records written */
+        int count;
+
+        /** Number of records the view can hold */
+        int capacity;
+
+        /** Map the file with a given size (in records) */
+        void mapView(int recordCapacity) throw(MatchJournalException);
+
+        /** Unmap the file */
+        void unmapView();
+
+        /** Grow the file then append a record */
+        void appendSlow(const JournalRecord & record);
+
+        /** Initialize a record with the current match context */
+        void prepare(JournalRecord & record, JournalEventType type) const;
+    public:
+        MatchJournal();
+
+        /** Close the journal if needed */
+        ~MatchJournal();
+
+        /** Create a new journal (an existing file is replaced)
+         * @param filePath The file path
+         * @throws MatchJournalException if the file cannot be created or mapped
+         */
+        void open(const std::string & filePath) throw(MatchJournalException);
+
+        /** Close the journal, keeping only the records written <br>
+         * Do nothing if the journal is not open
+         */
+        void close();
+
+        /** Is the journal open? */
+        bool isOpen() const;
+
+        /** Get the journal path */
+        const std::string & getPath() const;
+
+        /** Get the number of records written */
+        int getRecordCount() const;
+
+        /** Get the records written */
+        const JournalRecord * getRecords() const;
+
+        /** Append a record <br>
+         * Do nothing if the journal is not open
+         */
+        void append(const JournalRecord & record)
+        {
+            if (count < capacity)
+            {
+                records[count] = record;
+                header->recordCount = ++count;
+            }
+            else
+                appendSlow(record);
+        }
+
+        // Helpers to append the records
+        void logPlayer(int userid, const std::string & steamid);
+        void logTeam(int userid, int team, int oldTeam);
+        void logKill(int attacker, int victim, int attackerScore, int victimDeaths, bool headshot,
+                     const char * weapon);
+        void logRoundEnd(int winner, int reason, bool scored);
+        void logEvent(JournalEventType type);
+
+        /** Replay the journal to compute the score of each player
+         * @param scores Output {userid => score}
+         */
+        void computeScores(std::map<int, PlayerScore> & scores) const;
+    };
+}
+
+#endif // __MATCH_JOURNAL_H__
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "ReportWriter.h"
+#include "BaseReport.h"
+
+#include "../plugin/ServerPlugin.h"
+
+using namespace cssmatch;
+using namespace threading;
+
+using std::list;
+using std::string;
+
+ReportWriter::ReportWriter() : alive(true), completionsHead(0), completionsTail(0)
+{}
+
+ReportWriter::~ReportWriter()
+{
+    list<BaseReport *>::iterator itJob;
+    for(itJob = jobs.begin(); itJob != jobs.end(); itJob++)
+    {
+        delete *itJob;
+    }
+}
+
+BaseReport * ReportWriter::popJob()
+{
+    BaseReport * job = NULL;
+
+    try
+    {
+        jobsMutex.lock();
+        if (! jobs.empty())
+        {
+            job = jobs.front();
+            jobs.pop_front();
+        }
+        jobsMutex.unlock();
+    }
+    catch(const ThreadException & e)
+    {
+        // Retry later
+    }
+
+    return job;
+}
+
+void ReportWriter::pushCompletion(const ReportCompletion & completion)
+{
+    unsigned int tail = completionsTail;
+
+    // Full? wait for the game thread (but don't block the plugin unload)
+    while((tail - completionsHead == REPORT_WRITER_QUEUE_SIZE) && alive)
+        threading::sleep(100);
+
+    if (tail - completionsHead < REPORT_WRITER_QUEUE_SIZE)
+    {
+        completions[tail & (REPORT_WRITER_QUEUE_SIZE - 1)] = completion;
+
+        // The slot must be filled before being published
+        memoryBarrier();
+        completionsTail = tail + 1;
+    }
+}
+
+void ReportWriter::run()
+{
+    for(;;)
+    {
+        BaseReport * job = popJob();
+        if (job != NULL)
+        {
+            ReportCompletion completion;
+            completion.path = job->getPath();
+
+            try
+            {
+                job->write();
+            }
+            catch(const ReportException & e)
+            {
+                completion.error = e.what();
+            }
+            delete job;
+
+            pushCompletion(completion);
+        }
+        else if (alive)
+            threading::sleep(100);
+        else
+            break; // the pending reports are written
+    }
+}
+
+void ReportWriter::end()
+{
+    alive = false;
+}
+
+void ReportWriter::post(BaseReport * report)
+{
+    bool posted = false;
+
+    try
+    {
+        jobsMutex.lock();
+        jobs.push_back(report);
+        posted = true;
+        jobsMutex.unlock();
+    }
+    catch(const ThreadException & e)
+    {
+        CSSMATCH_PRINT(e.getMessage());
+    }
+
+    if (! posted)
+    {
+        // Write the report on the game thread rather than losing it
+        try
+        {
+            report->write();
+        }
+        catch(const ReportException & e)
+        {
+            CSSMATCH_PRINT_EXCEPTION(e);
+        }
+        delete report;
+    }
+}
+
+void ReportWriter::processCompletions()
+{
+    ServerPlugin * plugin = ServerPlugin::getInstance();
+
+    unsigned int head = completionsHead;
+    while(head != completionsTail)
+    {
+        // Read the slot only once it is published
+        memoryBarrier();
+
+        ReportCompletion & completion = completions[head & (REPORT_WRITER_QUEUE_SIZE - 1)];
+        if (completion.error.empty())
+            plugin->log("Report written: " + completion.path);
+        else
+            CSSMATCH_PRINT(completion.error);
+
+        // Release the slot
+        memoryBarrier();
+        head++;
+        completionsHead = head;
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __REPORT_WRITER_H__
+#define __REPORT_WRITER_H__
+
+#include "../threading/threading.h"
+
+#include <list>
+#include <string>
+
+/** Capacity of the completion queue (power of two) */
+#define REPORT_WRITER_QUEUE_SIZE 16
+
+namespace cssmatch
+{
+    class BaseReport;
+
+    /** Result of a report written by the ReportWriter thread */
+    struct ReportCompletion
+    {
+        /** The report path */
+        std::string path;
+
+        /** Error message, empty if the report was written */
+        std::string error;
+    };
+
+    /** Write the reports on a background thread <br>
+     * The reports are captured on the game thread then posted to this thread, which serializes
+     * and saves them. <br>
+     * The results come back through a lock-free single-producer/single-consumer queue,
+     * drained by the game thread.
+     */
+    class ReportWriter : public threading::Thread
+    {
+    private:
+        volatile bool alive; // thread can continue?
+
+        /** Reports waiting to be written */
+        std::list<BaseReport *> jobs;
+        threading::Mutex jobsMutex;
+
+        /** Completion ring buffer (written by this thread, read by the game thread) */
+        ReportCompletion completions[REPORT_WRITER_QUEUE_SIZE];
+
+        /** Next completion to read (only modified by the game thread) */
+        volatile unsigned int completionsHead;
+
+        /** Next completion to write (only modified by this thread) */
+        volatile unsigned int completionsTail;
+
+        /** Get the next report to write, or NULL if there is none */
+        BaseReport * popJob();
+
+        /** Post a completion, wait for a free slot if the queue is full */
+        void pushCompletion(const ReportCompletion & completion);
+    public:
+        ReportWriter();
+        ~ReportWriter();
+
+        /**
+         * @see threading::Thread
+         */
+        void run();
+
+        /** Tell to the thread that it must exit once the pending reports are written */
+        void end();
+
+        /** Post a report to write (game thread only) <br>
+         * The report is deleted by this thread once written. If it cannot be posted, it's
+         * written and deleted right away.
+         * @param report The report, already captured
+         */
+        void post(BaseReport * report);
+
+        /** Pop the completions and print them (game thread only) */
+        void processCompletions();
+    };
+}
+
+#endif // __REPORT_WRITER_H__
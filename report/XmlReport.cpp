@@ -25,6 +25,7 @@
  */
 
 #include "../plugin/ServerPlugin.h"
+#include "../plugin/Profiler.h"
 #include "../match/MatchManager.h"
 #include "../player/MatchClan.h"
 #include "../player/ClanMember.h"
@@ -35,228 +36,237 @@
 #include "XmlReport.h"
 
 #include <ctime>
+#include <cstdio> // rename, remove
 
 using namespace cssmatch;
 
 using std::list;
+using std::string;
+using std::vector;
+using std::map;
 
-// FIXME: Loop ~4 times over the player list
-//  clan1->getMembers
-//        loop
-//  clan2->getMembers
-//        loop
-//  get spectators
-
-void XmlReport::writeHeader()
-{
-    ticpp::Declaration * declaration = new ticpp::Declaration("1.0", "UTF-8", "yes");
-    document.LinkEndChild(declaration);
-
-    ticpp::StylesheetReference * stylesheet = new ticpp::StylesheetReference("text/xsl",
-                                                                             "cssmatch.xsl");
-    document.LinkEndChild(stylesheet);
-}
-
-void XmlReport::writeCorpse()
-{
-    ticpp::Element * eCssmatch = new ticpp::Element("cssmatch");
-
-    writePlugin(eCssmatch);
-    writeMatch(eCssmatch);
-
-    document.LinkEndChild(eCssmatch);
-}
-
-void XmlReport::writePlugin(ticpp::Element * cssmatch)
-{
-    ticpp::Element * ePlugin = new ticpp::Element("plugin");
-
-    ticpp::Element * eVersion = new ticpp::Element("version", CSSMATCH_VERSION);
-    ePlugin->LinkEndChild(eVersion);
-
-    ticpp::Element * eUrl = new ticpp::Element("url", CSSMATCH_SITE);
-    ePlugin->LinkEndChild(eUrl);
-
-    cssmatch->LinkEndChild(ePlugin);
-}
-
-void XmlReport::writeMatch(ticpp::Element * cssmatch)
+void XmlReport::capture()
 {
+    CSSMATCH_PROFILE("XmlReport::capture")
     ServerPlugin * plugin = ServerPlugin::getInstance();
     ValveInterfaces * interfaces = plugin->getInterfaces();
-    MatchManager * match = plugin->getMatch();
+    MatchLignup * lignup = match->getLignup();
+    MatchInfo * infos = match->getInfos();
 
     tm * date = getLocalTime();
 
     char formatMatchDate[20];
     strftime(formatMatchDate, sizeof(formatMatchDate), "%Y/%m/%d", date);
+    snapshot.date = formatMatchDate;
 
     char formatEndMatchDate[20];
     strftime(formatEndMatchDate, sizeof(formatEndMatchDate), "%Hh%M", date);
-
-    MatchLignup * lignup = match->getLignup();
-
-    MatchInfo * infos = match->getInfos();
+    snapshot.endTime = formatEndMatchDate;
 
     char formatBeginMatchDate[20];
     strftime(formatBeginMatchDate, sizeof(formatBeginMatchDate), "%Hh%M", &infos->startTime);
+    snapshot.beginTime = formatBeginMatchDate;
 
-    ticpp::Element * eMatch = new ticpp::Element("match");
+    snapshot.mapName = interfaces->gpGlobals->mapname.ToCStr();
 
-    ticpp::Element * eDate = new ticpp::Element("date", formatMatchDate);
-    eMatch->LinkEndChild(eDate);
-
-    ticpp::Element * eDebut = new ticpp::Element("debut", formatBeginMatchDate);
-    eMatch->LinkEndChild(eDebut);
+    if (infos->kniferoundWinner != NULL)
+        snapshot.kniferoundWinner = *infos->kniferoundWinner->getName();
 
-    ticpp::Element * eFin = new ticpp::Element("fin", formatEndMatchDate);
-    eMatch->LinkEndChild(eFin);
+    // The player totals come from the journal when there is one
+    map<int, PlayerScore> journalScores;
+    map<int, PlayerScore> * scores = NULL;
+    MatchJournal * journal = match->getJournal();
+    if (journal->isOpen())
+    {
+        journal->computeScores(journalScores);
+        scores = &journalScores;
+    }
 
-    ticpp::Element * eNom = new ticpp::Element("nom",
-                                               *lignup->clan1.getName() + " versus " +
-                                               *lignup->clan2.getName());
-    eMatch->LinkEndChild(eNom);
+    captureClan(snapshot.clan1, &lignup->clan1, scores);
+    captureClan(snapshot.clan2, &lignup->clan2, scores);
 
-    ticpp::Element * eMap = new ticpp::Element("map", interfaces->gpGlobals->mapname.ToCStr());
-    eMatch->LinkEndChild(eMap);
+    capturePlayers(snapshot.spectators, *plugin->getTeamMembers(SPEC_TEAM), scores);
 
-    if (infos->kniferoundWinner != NULL)
+    list<TvRecord *> * recordlist = match->getRecords();
+    list<TvRecord *>::const_iterator itRecord;
+    for(itRecord = recordlist->begin(); itRecord != recordlist->end(); itRecord++)
     {
-        ticpp::Element * eTagcutround = 
-            new ticpp::Element("tagcutround", *infos->kniferoundWinner->getName());
-        eMatch->LinkEndChild(eTagcutround);
+        snapshot.records.push_back(*(*itRecord)->getName());
     }
+}
 
-    writeTeams(eMatch);
-    writeSpectateurs(eMatch);
-    writeSourcetv(eMatch);
+void XmlReport::captureClan(ReportClan & out, MatchClan * clan,
+                            const map<int, PlayerScore> * scores)
+{
+    ClanStats * stats = clan->getStats();
 
-    cssmatch->LinkEndChild(eMatch);
+    out.name = *clan->getName();
+    out.scoreT = stats->scoreT;
+    out.scoreCT = stats->scoreCT;
+    capturePlayers(out.players, *clan->getMembers(), scores);
 }
 
-void XmlReport::writeTeams(ticpp::Element * eMatch)
+void XmlReport::capturePlayers(vector<ReportPlayer> & out, const vector<ClanMember *> & playerlist,
+                               const map<int, PlayerScore> * scores)
 {
-    ServerPlugin * plugin = ServerPlugin::getInstance();
-    MatchManager * match = plugin->getMatch();
-    MatchLignup * lignup = match->getLignup();
+    PlayerScore noScore;
 
-    ticpp::Element * eTeams = new ticpp::Element("teams");
+    vector<ClanMember *>::const_iterator itPlayer;
+    for(itPlayer = playerlist.begin(); itPlayer != playerlist.end(); itPlayer++)
+    {
+        IPlayerInfo * pInfo = (*itPlayer)->getPlayerInfo();
+        const PlayerScore * stats = (*itPlayer)->getCurrentScore();
+        if (scores != NULL)
+        {
+            map<int, PlayerScore>::const_iterator itScore =
+                scores->find((*itPlayer)->getIdentity()->userid);
+            stats = (itScore != scores->end()) ? &itScore->second : &noScore;
+        }
 
-    writeTeam(eTeams, &lignup->clan1);
-    writeTeam(eTeams, &lignup->clan2);
+        if (isValidPlayerInfo(pInfo)) // excludes SourceTv
+        {
+            ReportPlayer player;
+            player.steamid = pInfo->GetNetworkIDString();
+            player.name = pInfo->GetName();
+            player.kills = stats->kills;
+            player.deaths = stats->deaths;
 
-    eMatch->LinkEndChild(eTeams);
+            out.push_back(player);
+        }
+    }
 }
 
-void XmlReport::writeTeam(ticpp::Element * eTeams, MatchClan * clan)
+void XmlReport::writeHeader()
 {
-    ClanStats * stats = clan->getStats();
-
-    ticpp::Element * eTeam = new ticpp::Element("team");
+    document.declaration("1.0", "UTF-8", "yes");
+    document.stylesheet("text/xsl", "cssmatch.xsl");
+}
 
-    ticpp::Element * eTag = new ticpp::Element("tag", *clan->getName());
-    eTeam->LinkEndChild(eTag);
+void XmlReport::writeCorpse()
+{
+    document.startElement("cssmatch");
 
-    ticpp::Element * eScore = new ticpp::Element("score", stats->scoreT + stats->scoreCT);
-    eTeam->LinkEndChild(eScore);
+    writePlugin();
+    writeMatch();
 
-    ticpp::Element * eScoret = new ticpp::Element("scoret", stats->scoreT);
-    eTeam->LinkEndChild(eScoret);
+    document.endElement();
+}
 
-    ticpp::Element * eScorect = new ticpp::Element("scorect", stats->scoreCT);
-    eTeam->LinkEndChild(eScorect);
+void XmlReport::writePlugin()
+{
+    document.startElement("plugin");
 
-    writeJoueurs(eTeam, clan);
+    document.textElement("version", CSSMATCH_VERSION);
+    document.textElement("url", CSSMATCH_SITE);
 
-    eTeams->LinkEndChild(eTeam);
+    document.endElement();
 }
 
-void XmlReport::writeJoueurs(ticpp::Element * eTeam, MatchClan * clan)
+void XmlReport::writeMatch()
 {
-    list<ClanMember *> playerlist;
-    clan->getMembers(&playerlist);
+    document.startElement("match");
 
-    ticpp::Element * eJoueurs = new ticpp::Element("joueurs");
+    document.textElement("date", snapshot.date);
+    document.textElement("debut", snapshot.beginTime);
+    document.textElement("fin", snapshot.endTime);
+    document.textElement("nom", snapshot.clan1.name + " versus " + snapshot.clan2.name);
+    document.textElement("map", snapshot.mapName);
 
-    list<ClanMember *>::const_iterator itPlayer;
-    for(itPlayer = playerlist.begin(); itPlayer != playerlist.end(); itPlayer++)
-    {
-        writeJoueur(eJoueurs, *itPlayer);
-    }
+    if (! snapshot.kniferoundWinner.empty())
+        document.textElement("tagcutround", snapshot.kniferoundWinner);
+
+    writeTeams();
+    writeSpectateurs();
+    writeSourcetv();
 
-    eTeam->LinkEndChild(eJoueurs);
+    document.endElement();
 }
 
-void XmlReport::writeJoueur(ticpp::Element * eJoueurs, ClanMember * player)
+void XmlReport::writeTeams()
 {
-    IPlayerInfo * pInfo = player->getPlayerInfo();
-    PlayerScore * stats = player->getCurrentScore();
+    document.startElement("teams");
 
-    if (isValidPlayerInfo(pInfo)) // excludes SourceTv
-    {
-        ticpp::Element * eJoueur = new ticpp::Element("joueur");
-        eJoueur->SetAttribute("steamid", pInfo->GetNetworkIDString());
+    writeTeam(snapshot.clan1);
+    writeTeam(snapshot.clan2);
+
+    document.endElement();
+}
+
+void XmlReport::writeTeam(const ReportClan & clan)
+{
+    document.startElement("team");
 
-        ticpp::Element * ePseudo = new ticpp::Element("pseudo", pInfo->GetName());
-        eJoueur->LinkEndChild(ePseudo);
+    document.textElement("tag", clan.name);
+    document.textElement("score", clan.scoreT + clan.scoreCT);
+    document.textElement("scoret", clan.scoreT);
+    document.textElement("scorect", clan.scoreCT);
 
-        ticpp::Element * eKills = new ticpp::Element("kills", stats->kills);
-        eJoueur->LinkEndChild(eKills);
+    writeJoueurs(clan);
+
+    document.endElement();
+}
 
-        ticpp::Element * eDeaths = new ticpp::Element("deaths", stats->deaths);
-        eJoueur->LinkEndChild(eDeaths);
+void XmlReport::writeJoueurs(const ReportClan & clan)
+{
+    document.startElement("joueurs");
 
-        eJoueurs->LinkEndChild(eJoueur);
+    vector<ReportPlayer>::const_iterator itPlayer;
+    for(itPlayer = clan.players.begin(); itPlayer != clan.players.end(); itPlayer++)
+    {
+        writeJoueur(*itPlayer);
     }
+
+    document.endElement();
 }
 
-void XmlReport::writeSpectateurs(ticpp::Element * eMatch)
+void XmlReport::writeJoueur(const ReportPlayer & player)
 {
-    ServerPlugin * plugin = ServerPlugin::getInstance();
-    list<ClanMember *> * playerlist = plugin->getPlayerlist();
+    document.startElement("joueur");
+    document.attribute("steamid", player.steamid);
+
+    document.textElement("pseudo", player.name);
+    document.textElement("kills", player.kills);
+    document.textElement("deaths", player.deaths);
 
-    ticpp::Element * eSpectateurs = new ticpp::Element("spectateurs");
+    document.endElement();
+}
 
-    int nbSpec = 0;
-    list<ClanMember *>::const_iterator itPlayer;
-    for(itPlayer = playerlist->begin(); itPlayer != playerlist->end(); itPlayer++)
+void XmlReport::writeSpectateurs()
+{
+    if (! snapshot.spectators.empty())
     {
-        if ((*itPlayer)->getMyTeam() == SPEC_TEAM)
+        document.startElement("spectateurs");
+
+        vector<ReportPlayer>::const_iterator itPlayer;
+        for(itPlayer = snapshot.spectators.begin(); itPlayer != snapshot.spectators.end();
+            itPlayer++)
         {
-            writeJoueur(eSpectateurs, *itPlayer);
-            nbSpec++;
+            writeJoueur(*itPlayer);
         }
-    }
 
-    if (nbSpec > 0)
-        eMatch->LinkEndChild(eSpectateurs);
-    else
-        delete eSpectateurs;
+        document.endElement();
+    }
 }
 
-void XmlReport::writeSourcetv(ticpp::Element * eMatch)
+void XmlReport::writeSourcetv()
 {
-    ServerPlugin * plugin = ServerPlugin::getInstance();
-    MatchManager * match = plugin->getMatch();
-    list<TvRecord *> * recordlist = match->getRecords();
-
-    if (! recordlist->empty())
+    if (! snapshot.records.empty())
     {
-        ticpp::Element * eSourcetv = new ticpp::Element("sourcetv");
+        document.startElement("sourcetv");
 
         int recordId = 1;
-        list<TvRecord *>::const_iterator itRecord;
-        for(itRecord = recordlist->begin(); itRecord != recordlist->end(); itRecord++)
+        vector<string>::const_iterator itRecord;
+        for(itRecord = snapshot.records.begin(); itRecord != snapshot.records.end(); itRecord++)
         {
-            ticpp::Element * eManche = new ticpp::Element("manche", *(*itRecord)->getName());
-            eManche->SetAttribute("numero", recordId);
-
-            eSourcetv->LinkEndChild(eManche);
+            document.startElement("manche");
+            document.attribute("numero", recordId);
+            document.text(*itRecord);
+            document.endElement();
 
             recordId++;
         }
 
-        eMatch->LinkEndChild(eSourcetv);
+        document.endElement();
     }
 }
 
@@ -265,20 +275,32 @@ void XmlReport::writeSourcetv(ticpp::Element * eMatch)
 }*/
 
 XmlReport::XmlReport(MatchManager * matchManager) : BaseReport(matchManager)
-{}
+{
+    capture();
+}
 
-void XmlReport::write()
+void XmlReport::write() throw(ReportException)
 {
-    try
-    {
-        writeHeader();
-        writeCorpse();
-        //writeFooter();
+    string filePath = reportPath + ".xml";
+    string tempPath = filePath + ".tmp";
+
+    writeHeader();
+    writeCorpse();
+    //writeFooter();
 
-        document.SaveFile(reportPath + ".xml");
+    if (! document.save(tempPath))
+    {
+        remove(tempPath.c_str());
+        throw ReportException("Unable to write " + tempPath);
     }
-    catch(const ticpp::Exception & e)
+
+    // The complete report replaces the file at once
+#ifdef _WIN32
+    remove(filePath.c_str()); // rename does not overwrite under Windows
+#endif // _WIN32
+    if (rename(tempPath.c_str(), filePath.c_str()) != 0)
     {
-        CSSMATCH_PRINT_EXCEPTION(e);
+        remove(tempPath.c_str());
+        throw ReportException("Unable to rename " + tempPath + " to " + filePath);
     }
 }
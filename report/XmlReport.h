@@ -28,59 +28,133 @@
 #define __XML_REPORT_H__
 
 #include "BaseReport.h"
+#include "XmlWriter.h"
 
-#include "../ticpp/ticpp.h"
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
 
 namespace cssmatch
 {
     class MatchClan;
     class ClanMember;
     class Player;
+    struct PlayerScore;
+
+    /** Player data copied for a report */
+    struct ReportPlayer
+    {
+        std::string steamid;
+        std::string name;
+        int kills;
+        int deaths;
+
+        ReportPlayer() : kills(0), deaths(0){}
+    };
+
+    /** Clan data copied for a report */
+    struct ReportClan
+    {
+        std::string name;
+        int scoreT;
+        int scoreCT;
+        std::vector<ReportPlayer> players;
+
+        ReportClan() : scoreT(0), scoreCT(0){}
+    };
+
+    /** Immutable copy of everything a report needs <br>
+     * Captured on the game thread, so the report can be written by another thread
+     */
+    struct ReportSnapshot
+    {
+        /** Match date (e.g. 2013/01/31) */
+        std::string date;
+
+        /** Begin/end time of the match (e.g. 21h30) */
+        std::string beginTime;
+        std::string endTime;
+
+        /** Map name */
+        std::string mapName;
+
+        /** Name of the clan which won the knife round (empty if none) */
+        std::string kniferoundWinner;
+
+        ReportClan clan1;
+        ReportClan clan2;
+
+        /** Spectators */
+        std::vector<ReportPlayer> spectators;
+
+        /** SourceTv record names */
+        std::vector<std::string> records;
+    };
 
     /** XML report */
     class XmlReport : public BaseReport
     {
     protected:
+        /** The match data */
+        ReportSnapshot snapshot;
+
         /** The xml document */
-        ticpp::Document document;
+        XmlWriter document;
+
+        /** Copy the data needed by the report (game thread only) */
+        void capture();
+
+        /** Copy the data of a clan */
+        void captureClan(ReportClan & out, MatchClan * clan,
+                         const std::map<int, PlayerScore> * scores);
+
+        /** Copy the data of players
+         * @param scores {userid => score} computed from the match journal, NULL to use the
+         * scores of the players
+         */
+        void capturePlayers(std::vector<ReportPlayer> & out,
+                            const std::vector<ClanMember *> & playerlist,
+                            const std::map<int, PlayerScore> * scores);
 
-        /** Create the xml document */
+        /** Write the xml declaration and the stylesheet reference */
         void writeHeader();
 
         /** Write the report content (<cssmatch>)*/
         void writeCorpse();
 
         /** <plugin> */
-        void writePlugin(ticpp::Element * cssmatch);
+        void writePlugin();
         /** <match> */
-        void writeMatch(ticpp::Element * cssmatch);
+        void writeMatch();
         /** <teams> */
-        void writeTeams(ticpp::Element * eMatch);
+        void writeTeams();
         /** <team> */
-        void writeTeam(ticpp::Element * eTeams, MatchClan * clan);
+        void writeTeam(const ReportClan & clan);
         /** <joueurs> */
-        void writeJoueurs(ticpp::Element * eTeam, MatchClan * clan);
+        void writeJoueurs(const ReportClan & clan);
         /** <joueur> */
-        void writeJoueur(ticpp::Element * eJoueurs, ClanMember * player);
+        void writeJoueur(const ReportPlayer & player);
         /** <spectateurs> */
-        void writeSpectateurs(ticpp::Element * eMatch);
+        void writeSpectateurs();
         /** <sourcetv> */
-        void writeSourcetv(ticpp::Element * eMatch);
+        void writeSourcetv();
 
         /* End and save the xml document */
         //void writeFooter();
 
     public:
-        /**
+        /** Capture the match data, so the report can be written later
          * @see BaseReport
          */
         XmlReport(MatchManager * matchManager);
 
-        /**
+        /** Serialize the snapshot and save it (can be called from any thread) <br>
+         * The document is first written in a temporary file, then renamed
          * @see BaseReport
          */
-        void write();
+        void write() throw(ReportException);
     };
 }
 
-#endif // __BASE_REPORT_H__
+#endif // __XML_REPORT_H__
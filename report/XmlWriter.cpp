@@ -0,0 +1,247 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "XmlWriter.h"
+
+#include <cstdio>
+
+using namespace cssmatch;
+
+using std::string;
+
+void XmlWriter::closeStartTag()
+{
+    if (startTagOpen)
+    {
+        buffer += '>';
+        startTagOpen = false;
+    }
+}
+
+void XmlWriter::indent(size_t depth)
+{
+    for(size_t i = 0; i < depth; i++)
+    {
+        buffer.append("    ", 4);
+    }
+}
+
+void XmlWriter::appendEscaped(const string & value)
+{
+    size_t length = value.length();
+    size_t i = 0;
+    while(i < length)
+    {
+        unsigned char c = (unsigned char)value[i];
+
+        if ((c == '&') && (i + 2 < length) && (value[i+1] == '#') && (value[i+2] == 'x'))
+        {
+            // Hexadecimal character reference, passed through unchanged
+            while(i + 1 < length)
+            {
+                buffer += value[i];
+                ++i;
+                if (value[i] == ';')
+                    break;
+            }
+            continue;
+        }
+
+        switch(c)
+        {
+        case '&':
+            buffer.append("&amp;", 5);
+            break;
+        case '<':
+            buffer.append("&lt;", 4);
+            break;
+        case '>':
+            buffer.append("&gt;", 4);
+            break;
+        case '\"':
+            buffer.append("&quot;", 6);
+            break;
+        case '\'':
+            buffer.append("&apos;", 6);
+            break;
+        default:
+            if (c < 32)
+            {
+                char reference[8];
+                sprintf(reference, "&#x%02X;", (unsigned int)c);
+                buffer += reference;
+            }
+            else
+                buffer += (char)c;
+        }
+        ++i;
+    }
+}
+
+XmlWriter::XmlWriter(size_t capacity) : startTagOpen(false)
+{
+    buffer.reserve(capacity);
+}
+
+void XmlWriter::declaration(const string & version, const string & encoding,
+                            const string & standalone)
+{
+    buffer += "<?xml ";
+    if (! version.empty())
+        buffer += "version=\"" + version + "\" ";
+    if (! encoding.empty())
+        buffer += "encoding=\"" + encoding + "\" ";
+    if (! standalone.empty())
+        buffer += "standalone=\"" + standalone + "\" ";
+    buffer += "?>\n";
+}
+
+void XmlWriter::stylesheet(const string & type, const string & href)
+{
+    buffer += "<?xml-stylesheet ";
+    if (! type.empty())
+        buffer += "type=\"" + type + "\" ";
+    if (! href.empty())
+        buffer += "href=\"" + href + "\" ";
+    buffer += "?>\n";
+}
+
+void XmlWriter::startElement(const char * name)
+{
+    if (! elements.empty())
+    {
+        closeStartTag();
+        elements.back().hasElements = true;
+        buffer += '\n';
+    }
+    indent(elements.size());
+
+    buffer += '<';
+    buffer += name;
+    startTagOpen = true;
+
+    OpenElement element;
+    element.name = name;
+    element.hasElements = false;
+    element.hasText = false;
+    elements.push_back(element);
+}
+
+void XmlWriter::attribute(const char * name, const string & value)
+{
+    // Same quoting as TinyXML: single quotes if the raw value contains a double quote
+    char quote = (value.find('\"') == string::npos) ? '\"' : '\'';
+
+    buffer += ' ';
+    buffer += name;
+    buffer += '=';
+    buffer += quote;
+    appendEscaped(value);
+    buffer += quote;
+}
+
+void XmlWriter::attribute(const char * name, int value)
+{
+    char formatted[16];
+    sprintf(formatted, "%d", value);
+    attribute(name, string(formatted));
+}
+
+void XmlWriter::text(const string & value)
+{
+    closeStartTag();
+    elements.back().hasText = true;
+    appendEscaped(value);
+}
+
+void XmlWriter::text(int value)
+{
+    char formatted[16];
+    sprintf(formatted, "%d", value);
+    text(string(formatted));
+}
+
+void XmlWriter::endElement()
+{
+    const OpenElement & element = elements.back();
+
+    if (element.hasElements)
+    {
+        buffer += '\n';
+        indent(elements.size() - 1);
+        buffer += "</";
+        buffer += element.name;
+        buffer += '>';
+    }
+    else if (element.hasText)
+    {
+        buffer += "</";
+        buffer += element.name;
+        buffer += '>';
+    }
+    else
+        buffer += " />";
+
+    startTagOpen = false;
+    elements.pop_back();
+
+    if (elements.empty())
+        buffer += '\n'; // the document puts each top-level node on its own line
+}
+
+void XmlWriter::textElement(const char * name, const string & value)
+{
+    startElement(name);
+    text(value);
+    endElement();
+}
+
+void XmlWriter::textElement(const char * name, int value)
+{
+    startElement(name);
+    text(value);
+    endElement();
+}
+
+const string & XmlWriter::getBuffer() const
+{
+    return buffer;
+}
+
+bool XmlWriter::save(const string & path) const
+{
+    bool success = false;
+
+    // Text mode, like TinyXML, so the line endings are the same
+    FILE * file = fopen(path.c_str(), "w");
+    if (file != NULL)
+    {
+        success = (fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size());
+        success = (fclose(file) == 0) && success;
+    }
+
+    return success;
+}
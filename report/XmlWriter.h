@@ -0,0 +1,123 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __XML_WRITER_H__
+#define __XML_WRITER_H__
+
+#include <string>
+#include <vector>
+
+namespace cssmatch
+{
+    /** Forward-only XML emitter <br>
+     * The document is written in one pass into a growable buffer, with the same layout and
+     * escaping as the TinyXML printer (4 spaces per depth, one-line text elements,
+     * <code><empty /></code> elements without children). <br>
+     * Element names must outlive the element (string literals are expected).
+     */
+    class XmlWriter
+    {
+    protected:
+        /** An element whose closing tag is not written yet */
+        struct OpenElement
+        {
+            const char * name;
+
+            /** Did the element receive child elements? */
+            bool hasElements;
+
+            /** Did the element receive text? */
+            bool hasText;
+        };
+
+        /** The document */
+        std::string buffer;
+
+        /** Opened elements, the last one is the current element */
+        std::vector<OpenElement> elements;
+
+        /** Is the start tag of the current element still waiting for attributes? */
+        bool startTagOpen;
+
+        /** Close the start tag of the current element if needed */
+        void closeStartTag();
+
+        /** Write the indentation for a depth */
+        void indent(size_t depth);
+
+        /** Append a string to the buffer, escaping the XML special characters */
+        void appendEscaped(const std::string & value);
+    public:
+        /**
+         * @param capacity Initial size of the buffer
+         */
+        XmlWriter(size_t capacity = 4096);
+
+        /** Write the XML declaration <br>
+         * Empty parameters are omitted
+         */
+        void declaration(const std::string & version, const std::string & encoding,
+                         const std::string & standalone);
+
+        /** Write a stylesheet reference <br>
+         * Empty parameters are omitted
+         */
+        void stylesheet(const std::string & type, const std::string & href);
+
+        /** Open an element, which becomes the current element */
+        void startElement(const char * name);
+
+        /** Add an attribute to the current element <br>
+         * Must be called before any content of the element
+         */
+        void attribute(const char * name, const std::string & value);
+        void attribute(const char * name, int value);
+
+        /** Write the text content of the current element <br>
+         * An element can contain text or elements, not both
+         */
+        void text(const std::string & value);
+        void text(int value);
+
+        /** Close the current element */
+        void endElement();
+
+        /** Write an element which only contains text */
+        void textElement(const char * name, const std::string & value);
+        void textElement(const char * name, int value);
+
+        /** Get the document written so far */
+        const std::string & getBuffer() const;
+
+        /** Save the document
+         * @param path The file path
+         * @return <code>true</code> if the whole document was written
+         */
+        bool save(const std::string & path) const;
+    };
+}
+
+#endif // __XML_WRITER_H__
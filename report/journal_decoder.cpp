@@ -0,0 +1,260 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+/* Offline decoder of the match journals
+ * Usage: journal_decoder [-json] <file.journal>
+ * Prints the records as CSV (default) or JSON on the standard output
+ */
+
+#include "JournalRecord.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace cssmatch;
+
+using std::string;
+using std::vector;
+
+static const char * eventNames[JOURNAL_EVENT_TYPE_COUNT] =
+{
+    "unknown",
+    "player",
+    "team",
+    "kill",
+    "round_start",
+    "round_end",
+    "round_restart",
+    "half_start",
+    "half_restart"
+};
+
+static const char * getEventName(unsigned char type)
+{
+    return (type < JOURNAL_EVENT_TYPE_COUNT) ? eventNames[type] : eventNames[0];
+}
+
+/** Copy a fixed-size string field, which is not null-terminated if full */
+static string getField(const char * field, size_t size)
+{
+    size_t length = 0;
+    while((length < size) && (field[length] != '\0'))
+        length++;
+    return string(field, length);
+}
+
+static string escapeJson(const string & value)
+{
+    string escaped;
+    for(size_t i = 0; i < value.size(); i++)
+    {
+        unsigned char c = (unsigned char)value[i];
+        if ((c == '\"') || (c == '\\'))
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (c < 32)
+        {
+            char code[8];
+            sprintf(code, "\\u%04x", c);
+            escaped += code;
+        }
+        else
+            escaped += c;
+    }
+    return escaped;
+}
+
+static string escapeCsv(const string & value)
+{
+    if (value.find_first_of(",\"\n") == string::npos)
+        return value;
+
+    string escaped = "\"";
+    for(size_t i = 0; i < value.size(); i++)
+    {
+        if (value[i] == '\"')
+            escaped += '\"';
+        escaped += value[i];
+    }
+    escaped += '\"';
+    return escaped;
+}
+
+static void printCsv(const vector<JournalRecord> & records)
+{
+    printf("type,half,round,time,userid,steamid,team,oldteam,attacker,victim,attacker_score,"
+           "victim_deaths,headshot,weapon,winner,reason,scored\n");
+
+    vector<JournalRecord>::const_iterator itRecord;
+    for(itRecord = records.begin(); itRecord != records.end(); itRecord++)
+    {
+        const JournalRecord & record = *itRecord;
+        printf("%s,%d,%d,%.3f,", getEventName(record.type), record.half, record.round,
+               record.time);
+
+        switch(record.type)
+        {
+        case JOURNAL_PLAYER:
+            printf("%d,%s,,,,,,,,,,,\n", record.player.userid,
+                   escapeCsv(getField(record.player.steamid, JOURNAL_STEAMID_SIZE)).c_str());
+            break;
+        case JOURNAL_TEAM:
+            printf("%d,,%d,%d,,,,,,,,,\n", record.team.userid, record.team.team,
+                   record.team.oldTeam);
+            break;
+        case JOURNAL_KILL:
+            printf(",,,,%d,%d,%d,%d,%d,%s,,,\n", record.kill.attacker, record.kill.victim,
+                   record.kill.attackerScore, record.kill.victimDeaths, record.kill.headshot,
+                   escapeCsv(getField(record.kill.weapon, JOURNAL_WEAPON_SIZE)).c_str());
+            break;
+        case JOURNAL_ROUND_END:
+            printf(",,,,,,,,,,%d,%d,%d\n", record.roundEnd.winner, record.roundEnd.reason,
+                   record.roundEnd.scored);
+            break;
+        default:
+            printf(",,,,,,,,,,,,\n");
+        }
+    }
+}
+
+static void printJson(const vector<JournalRecord> & records)
+{
+    printf("[\n");
+
+    vector<JournalRecord>::const_iterator itRecord;
+    for(itRecord = records.begin(); itRecord != records.end(); itRecord++)
+    {
+        const JournalRecord & record = *itRecord;
+        printf("    {\"type\": \"%s\", \"half\": %d, \"round\": %d, \"time\": %.3f",
+               getEventName(record.type), record.half, record.round, record.time);
+
+        switch(record.type)
+        {
+        case JOURNAL_PLAYER:
+            printf(", \"userid\": %d, \"steamid\": \"%s\"", record.player.userid,
+                   escapeJson(getField(record.player.steamid, JOURNAL_STEAMID_SIZE)).c_str());
+            break;
+        case JOURNAL_TEAM:
+            printf(", \"userid\": %d, \"team\": %d, \"oldteam\": %d", record.team.userid,
+                   record.team.team, record.team.oldTeam);
+            break;
+        case JOURNAL_KILL:
+            printf(", \"attacker\": %d, \"victim\": %d, \"attacker_score\": %d, "
+                   "\"victim_deaths\": %d, \"headshot\": %s, \"weapon\": \"%s\"",
+                   record.kill.attacker, record.kill.victim, record.kill.attackerScore,
+                   record.kill.victimDeaths, record.kill.headshot ? "true" : "false",
+                   escapeJson(getField(record.kill.weapon, JOURNAL_WEAPON_SIZE)).c_str());
+            break;
+        case JOURNAL_ROUND_END:
+            printf(", \"winner\": %d, \"reason\": %d, \"scored\": %s", record.roundEnd.winner,
+                   record.roundEnd.reason, record.roundEnd.scored ? "true" : "false");
+            break;
+        }
+
+        printf((itRecord + 1 != records.end()) ? "},\n" : "}\n");
+    }
+
+    printf("]\n");
+}
+
+int main(int argc, char * argv[])
+{
+    bool json = false;
+    const char * path = NULL;
+    for(int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-json") == 0)
+            json = true;
+        else
+            path = argv[i];
+    }
+
+    if (path == NULL)
+    {
+        fprintf(stderr, "Usage: %s [-json] <file%s>\n", argv[0], JOURNAL_EXTENSION);
+        return 1;
+    }
+
+    FILE * file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Unable to open %s\n", path);
+        return 1;
+    }
+
+    JournalFileHeader header;
+    if ((fread(&header, sizeof(header), 1, file) != 1) ||
+        (memcmp(header.magic, JOURNAL_MAGIC, JOURNAL_MAGIC_SIZE) != 0))
+    {
+        fprintf(stderr, "%s is not a journal\n", path);
+        fclose(file);
+        return 1;
+    }
+
+    if ((header.version != JOURNAL_VERSION) || (header.recordSize != sizeof(JournalRecord)))
+    {
+        fprintf(stderr, "%s: unsupported version %d\n", path, header.version);
+        fclose(file);
+        return 1;
+    }
+
+    // The records announced must be in the file (a server crash can only leave unused space
+    // after them), otherwise the journal is truncated or corrupted
+    long fileSize = -1;
+    if (fseek(file, 0, SEEK_END) == 0)
+        fileSize = ftell(file);
+    long recordsInFile = (fileSize - (long)sizeof(header)) / (long)sizeof(JournalRecord);
+    if ((fileSize < (long)sizeof(header)) || (header.recordCount < 0) ||
+        (header.recordCount > recordsInFile) ||
+        (fseek(file, sizeof(header), SEEK_SET) != 0))
+    {
+        fprintf(stderr, "%s: corrupted journal (%d records announced, %ld in the file)\n", path,
+                header.recordCount, recordsInFile);
+        fclose(file);
+        return 1;
+    }
+
+    vector<JournalRecord> records(header.recordCount);
+    if ((! records.empty()) &&
+        (fread(&records[0], sizeof(JournalRecord), records.size(), file) != records.size()))
+    {
+        fprintf(stderr, "Unable to read %s\n", path);
+        fclose(file);
+        return 1;
+    }
+    fclose(file);
+
+    if (json)
+        printJson(records);
+    else
+        printCsv(records);
+
+    return 0;
+}
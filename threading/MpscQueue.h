@@ -0,0 +1,171 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __MPSC_QUEUE_H__
+#define __MPSC_QUEUE_H__
+
+#include "threading.h"
+
+namespace threading
+{
+    /**
+     * Bounded lock-free multi-producer single-consumer queue.
+     * Any thread can push, only one thread (always the same) can pop.
+     * Each cell carries a sequence number telling if it is free or filled for a given lap, so the
+     * producers only compete on the enqueue position and never wait for each other.
+     * @param T The value type (copyable).
+     * @param Capacity The number of cells (power of 2).
+     */
+    template<typename T, int Capacity>
+    class MpscQueue
+    {
+    private:
+        struct Cell
+        {
+            /** Equals the position to fill if the cell is free, the position + 1 once filled. */
+            volatile long sequence;
+
+            T value;
+        };
+
+        // Compile-time check: the positions are mapped to the cells with a mask
+        typedef char CapacityPowerOf2Check[((Capacity & (Capacity - 1)) == 0) ? 1 : -1];
+
+        Cell cells[Capacity];
+
+        /** Next position to fill (shared by the producers). */
+        volatile long enqueuePos;
+
+        /** Next position to read (consumer only). */
+        long dequeuePos;
+
+        /** Number of values rejected because the queue was full. */
+        volatile long dropped;
+
+        /** Signed distance between two positions, which may have wrapped around. */
+        static long distance(long from, long to)
+        {
+            return (long)((unsigned long)to - (unsigned long)from);
+        }
+
+        /** Advance a position, wrapping around instead of overflowing. */
+        static long advance(long pos, long count)
+        {
+            return (long)((unsigned long)pos + (unsigned long)count);
+        }
+
+        // Not copyable
+        MpscQueue(const MpscQueue &);
+        MpscQueue & operator =(const MpscQueue &);
+    public:
+        MpscQueue() : enqueuePos(0), dequeuePos(0), dropped(0)
+        {
+            for (int i = 0; i < Capacity; i++)
+                cells[i].sequence = i;
+        }
+
+        /**
+         * Add a value (any thread).
+         * @param value The value to add.
+         * @return false if the queue is full.
+         */
+        bool push(const T & value)
+        {
+            Cell * cell = NULL;
+            long pos = enqueuePos;
+
+            while (cell == NULL)
+            {
+                Cell & candidate = cells[pos & (Capacity - 1)];
+                long sequence = candidate.sequence;
+                memoryBarrier();
+
+                long diff = distance(pos, sequence);
+                if (diff == 0)
+                {
+                    // The cell is free for this lap, try to reserve it
+                    if (compareAndSwap(&enqueuePos, pos, advance(pos, 1)))
+                        cell = &candidate;
+                    else
+                        pos = enqueuePos;
+                }
+                else if (diff < 0)
+                {
+                    // The consumer did not read this cell yet
+                    long count;
+                    do
+                    {
+                        count = dropped;
+                    }
+                    while (! compareAndSwap(&dropped, count, advance(count, 1)));
+
+                    return false;
+                }
+                else
+                    pos = enqueuePos; // another producer took the cell
+            }
+
+            cell->value = value;
+            memoryBarrier();
+            cell->sequence = advance(pos, 1);
+
+            return true;
+        }
+
+        /**
+         * Remove the oldest value (consumer thread only).
+         * @param out Receives the value.
+         * @return false if the queue is empty.
+         */
+        bool pop(T & out)
+        {
+            Cell & cell = cells[dequeuePos & (Capacity - 1)];
+            long sequence = cell.sequence;
+            memoryBarrier();
+
+            if (distance(advance(dequeuePos, 1), sequence) < 0)
+                return false; // not filled yet
+
+            out = cell.value;
+            cell.value = T(); // release the resources of the value on this thread
+            memoryBarrier();
+            cell.sequence = advance(dequeuePos, Capacity);
+            dequeuePos = advance(dequeuePos, 1);
+
+            return true;
+        }
+
+        /**
+         * Get the number of values rejected because the queue was full.
+         */
+        long getDropped() const
+        {
+            return dropped;
+        }
+    };
+} // namespace threading
+
+#endif // __MPSC_QUEUE_H__
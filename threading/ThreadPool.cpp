@@ -0,0 +1,182 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#include "ThreadPool.h"
+
+using namespace threading;
+
+Task::Task(bool deleteWhenDone) throw(ThreadException) : autoDelete(deleteWhenDone), done(false)
+{
+}
+
+Task::~Task()
+{
+}
+
+void Task::complete()
+{
+}
+
+bool Task::isDone() const
+{
+    return done;
+}
+
+EventWaitResult Task::waitDone(long timeoutMs) throw(ThreadException)
+{
+    EventWaitResult result = THREADING_EVENT_SIGNALED;
+    if (! done)
+    {
+        result = finished.wait(timeoutMs);
+        if (result == THREADING_EVENT_SIGNALED)
+        {
+            // The worker sets done after the event: once done, it does not touch the task anymore
+            while (! done)
+                threading::sleep(0);
+        }
+    }
+    return result;
+}
+
+bool Task::isAutoDelete() const
+{
+    return autoDelete;
+}
+
+void Task::finish() throw(ThreadException)
+{
+    finished.set();
+    memoryBarrier(); // the results are visible before done
+    done = true; // last access to the task, the submitter can delete it now
+}
+
+PoolWorker::PoolWorker(ThreadPool * owner) : pool(owner)
+{
+}
+
+void PoolWorker::run()
+{
+    try
+    {
+        bool running = true;
+        while (running)
+        {
+            Task * task = pool->next();
+            if (task != NULL)
+            {
+                task->run();
+                task->complete();
+                if (task->isAutoDelete())
+                    delete task;
+                else
+                    task->finish();
+            }
+            else if (pool->alive)
+                pool->available.wait(THREAD_POOL_IDLE_WAIT);
+            else
+            {
+                pool->available.set(); // wake up the next worker, so it exits too
+                running = false;
+            }
+        }
+    }
+    catch (const ThreadException &)
+    {
+        // Nothing can be reported from here, the worker exits
+    }
+}
+
+ThreadPool::ThreadPool(int size) throw(ThreadException) : alive(true)
+{
+    for (int i = 0; i < size; i++)
+        workers.push_back(new PoolWorker(this));
+}
+
+ThreadPool::~ThreadPool()
+{
+    std::list<PoolWorker *>::iterator itWorker;
+    for (itWorker = workers.begin(); itWorker != workers.end(); itWorker++)
+        delete *itWorker;
+}
+
+Task * ThreadPool::next() throw(ThreadException)
+{
+    Task * task = NULL;
+    bool more = false;
+
+    guard.lock();
+    if (! tasks.empty())
+    {
+        task = tasks.front();
+        tasks.pop_front();
+        more = ! tasks.empty();
+    }
+    guard.unlock();
+
+    // One set() releases one worker: chain the wake up while there are tasks left
+    if (more)
+        available.set();
+
+    return task;
+}
+
+void ThreadPool::start() throw(ThreadException)
+{
+    std::list<PoolWorker *>::iterator itWorker;
+    for (itWorker = workers.begin(); itWorker != workers.end(); itWorker++)
+        (*itWorker)->start();
+}
+
+bool ThreadPool::submit(Task * task) throw(ThreadException)
+{
+    bool accepted = false;
+
+    guard.lock();
+    if (alive)
+    {
+        tasks.push_back(task);
+        accepted = true;
+    }
+    guard.unlock();
+
+    if (accepted)
+        available.set();
+
+    return accepted;
+}
+
+void ThreadPool::stop() throw(ThreadException)
+{
+    guard.lock();
+    alive = false;
+    guard.unlock();
+
+    available.set();
+
+    std::list<PoolWorker *>::iterator itWorker;
+    for (itWorker = workers.begin(); itWorker != workers.end(); itWorker++)
+        (*itWorker)->join();
+}
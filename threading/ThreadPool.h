@@ -0,0 +1,186 @@
+/*
+ * Copyright 2008-2013 Nicolas Maingot
+ *
+ * This file is part of CSSMatch.
+ *
+ * CSSMatch is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CSSMatch is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CSSMatch; if not, see <http://www.gnu.org/licenses>.
+ *
+ * Additional permission under GNU GPL version 3 section 7
+ *
+ * If you modify CSSMatch, or any covered work, by linking or combining
+ * it with "Source SDK" (or a modified version of that SDK), containing
+ * parts covered by the terms of Source SDK licence, the licensors of 
+ * CSSMatch grant you additional permission to convey the resulting work.
+ */
+
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include "threading.h"
+
+#include <list>
+
+#ifdef _MSC_VER // VC++ only
+#pragma warning(push)
+#pragma \
+    warning(disable:4290) /* C++ exception specification ignored except to indicate a function is
+                             not __declspec(nothrow) */
+#endif // _MSC_VER
+
+/** Max time a worker sleeps before checking if the pool is stopping, in milliseconds */
+#define THREAD_POOL_IDLE_WAIT 1000
+
+namespace threading
+{
+    /**
+     * Work to run by a ThreadPool.
+     * The task can be used as a future: the submitter checks isDone() or waits for it, then
+     * reads the results stored in the task.
+     */
+    class Task
+    {
+    private:
+        /** Delete the task once complete? */
+        bool autoDelete;
+
+        /** Has the task run? */
+        volatile bool done;
+
+        /** Signaled once the task has run. */
+        Event finished;
+
+    public:
+        /**
+         * @param deleteWhenDone true if the pool must delete the task once complete (isDone and
+         * waitDone can't be used then).
+         */
+        Task(bool deleteWhenDone = false) throw(ThreadException);
+        virtual ~Task();
+
+        /**
+         * Task routine (called by a worker thread).
+         */
+        virtual void run() = 0;
+
+        /**
+         * Completion callback (called by the worker thread once run() returned).
+         */
+        virtual void complete();
+
+        /**
+         * Has the task run?
+         */
+        bool isDone() const;
+
+        /**
+         * Wait for the task to run (one thread at a time).
+         * @param timeoutMs Max wait time in milliseconds.
+         * @return EventWaitResult
+         */
+        EventWaitResult waitDone(long timeoutMs) throw(ThreadException);
+
+        /**
+         * Must the pool delete the task once complete?
+         */
+        bool isAutoDelete() const;
+
+        /**
+         * Mark the task done (called by the pool).
+         */
+        void finish() throw(ThreadException);
+    };
+
+    class ThreadPool;
+
+    /**
+     * Thread of a ThreadPool.
+     */
+    class PoolWorker : public Thread
+    {
+    private:
+        ThreadPool * pool;
+
+    public:
+        PoolWorker(ThreadPool * owner);
+
+        void run();
+    };
+
+    /**
+     * Fixed-size pool of worker threads running the submitted tasks in order.
+     */
+    class ThreadPool
+    {
+    private:
+        /** Worker threads. */
+        std::list<PoolWorker *> workers;
+
+        /** Tasks waiting for a worker. */
+        std::list<Task *> tasks;
+
+        /** Protects tasks. */
+        Mutex guard;
+
+        /** Signaled when a task is submitted, or when the pool stops. */
+        Event available;
+
+        /** Can the workers continue? */
+        volatile bool alive;
+
+        /**
+         * Get the next task.
+         * @return The task, or NULL if there is none.
+         */
+        Task * next() throw(ThreadException);
+
+        friend class PoolWorker;
+
+        // Not copyable
+        ThreadPool(const ThreadPool &);
+        ThreadPool & operator =(const ThreadPool &);
+    public:
+        /**
+         * @param size The number of worker threads.
+         */
+        ThreadPool(int size) throw(ThreadException);
+
+        /**
+         * The pool must be stopped before.
+         */
+        ~ThreadPool();
+
+        /**
+         * Start the worker threads.
+         */
+        void start() throw(ThreadException);
+
+        /**
+         * Add a task to run.
+         * @param task The task (must live until it is done, if it is not auto-deleted).
+         * @return false if the pool is stopped (the task will never run).
+         */
+        bool submit(Task * task) throw(ThreadException);
+
+        /**
+         * Run the pending tasks, then stop and join the worker threads.
+         */
+        void stop() throw(ThreadException);
+    };
+} // namespace threading
+
+#ifdef _MSC_VER // VC++ only
+#pragma warning(pop)
+#endif // _MSC_VER
+
+#endif // __THREAD_POOL_H__
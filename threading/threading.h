@@ -87,6 +87,26 @@ namespace threading
      */
     void sleep(long ms);
 
+    /**
+     * Full memory barrier: the memory operations issued before the barrier are visible to the
+     * other threads before the ones issued after it.
+     */
+    void memoryBarrier();
+
+    /**
+     * Atomically replace a value if it still equals an expected value (full memory barrier).
+     * @param target The value to replace.
+     * @param expected The value expected in target.
+     * @param desired The new value.
+     * @return true if target was replaced.
+     */
+    bool compareAndSwap(volatile long * target, long expected, long desired);
+
+    /**
+     * Get an identifier of the current thread.
+     */
+    unsigned long currentThreadId();
+
     
     struct MutexData;
 
@@ -114,7 +134,6 @@ namespace threading
         void unlock() throw(ThreadException);
     };
 
-#if 0
     struct EventData;
 
     /**
@@ -131,6 +150,8 @@ namespace threading
 
     /**
      * Basic platform-independant auto-reset event.
+     * The event stays signaled until a thread waits for it, then it is reset: a set() before the
+     * wait() is not lost, and one set() releases one waiting thread.
      */
     class Event
     {
@@ -139,7 +160,7 @@ namespace threading
         EventData * data;
 
     public:
-        Event();
+        Event() throw(ThreadException);
         ~Event();
     
         /**
@@ -154,7 +175,6 @@ namespace threading
          */
         void set() throw(ThreadException);
     };
-#endif
 } // namespace threading
 
 #ifdef _MSC_VER // VC++ only
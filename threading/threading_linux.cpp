@@ -142,17 +142,32 @@ void threading::sleep(long ms)
 {
     timespec timeout;
     ms_to_timespec(ms, timeout);
-    nanosleep(timeout, NULL);
+    nanosleep(&timeout, NULL);
+}
+
+void threading::memoryBarrier()
+{
+    __sync_synchronize();
+}
+
+bool threading::compareAndSwap(volatile long * target, long expected, long desired)
+{
+    return __sync_bool_compare_and_swap(target, expected, desired);
+}
+
+unsigned long threading::currentThreadId()
+{
+    return (unsigned long)pthread_self();
 }
 
-#if 0
 struct threading::EventData
 {
     pthread_cond_t handle;
     pthread_mutex_t mutex;
+    bool signaled;
 };
 
-Event::Event() : data(NULL)
+Event::Event() throw(ThreadException) : data(NULL)
 {
     pthread_cond_t handle;
     int resultCondInit = pthread_cond_init(&handle, NULL);
@@ -172,6 +187,7 @@ Event::Event() : data(NULL)
     data = (EventData *)calloc(1, sizeof(EventData));
     data->handle = handle;
     data->mutex = mutex;
+    data->signaled = false;
 }
 
 Event::~Event()
@@ -187,22 +203,34 @@ EventWaitResult Event::wait(long timeoutMs) throw(ThreadException)
     if (resultLock != 0)
         throw ThreadException("Event::wait() : pthread_mutex_lock didn't return 0.");
 
+    // gettimeofday rather than clock_gettime, so the plugin does not need librt
+    timeval now;
+    gettimeofday(&now, NULL);
     timespec timeout;
-    clock_gettime(CLOCK_REALTIME, &timeout);
-    timeout.tv_nsec += (timeoutMs % 1000) * 1000000;
-    timeout.tv_sec += timeoutMs / 1000;
+    timeout.tv_nsec = now.tv_usec * 1000 + (timeoutMs % 1000) * 1000000;
+    timeout.tv_sec = now.tv_sec + timeoutMs / 1000;
     // Fix tv_nsec so it's not greater than 1 sec
     timeout.tv_sec += timeout.tv_nsec / 1000000000;
     timeout.tv_nsec %= 1000000000;
-    int resultWait = pthread_cond_timedwait(&data->handle, &data->mutex, &timeout);
+
+    // Loop because of the spurious wakeups
+    int resultWait = 0;
+    while ((! data->signaled) && (resultWait == 0))
+        resultWait = pthread_cond_timedwait(&data->handle, &data->mutex, &timeout);
 
     EventWaitResult waitResult;
-    if (resultWait == 0)
+    if (data->signaled)
+    {
+        data->signaled = false; // auto-reset
         waitResult = THREADING_EVENT_SIGNALED;
+    }
     else if (resultWait == ETIMEDOUT)
         waitResult = THREADING_EVENT_TIMEOUT;
     else
-        throw ThreadException("Event::wait() : pthread_cond_wait didn't return 0 nor ETIMEDOUT.");
+    {
+        pthread_mutex_unlock(&data->mutex);
+        throw ThreadException("Event::wait() : pthread_cond_timedwait didn't return 0 nor ETIMEDOUT.");
+    }
 
     int resultUnlock = pthread_mutex_unlock(&data->mutex);
     if (resultUnlock != 0)
@@ -217,14 +245,14 @@ void Event::set() throw(ThreadException)
     if (resultLock != 0)
         throw ThreadException("Event::set() : pthread_mutex_lock didn't return 0.");
 
-    int resultSignal = pthread_cond_broadcast(&data->handle);
-    if (resultSignal != 0)
-        throw ThreadException("Event::set() : pthread_cond_signal didn't return 0.");
+    data->signaled = true;
+    int resultSignal = pthread_cond_signal(&data->handle);
 
     int resultUnlock = pthread_mutex_unlock(&data->mutex);
+    if (resultSignal != 0)
+        throw ThreadException("Event::set() : pthread_cond_signal didn't return 0.");
     if (resultUnlock != 0)
         throw ThreadException("Event::set() : pthread_mutex_unlock didn't return 0.");
 }
-#endif
 
 #endif // ! _WIN32
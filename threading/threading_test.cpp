@@ -1,6 +1,9 @@
 
 #include "threading.h"
+#include "MpscQueue.h"
+#include "ThreadPool.h"
 #include <iostream>
+#include <string>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -13,6 +16,165 @@ using namespace std;
 
 //Event evt;
 
+static int failures = 0;
+
+#define CHECK(condition) \
+    if (! (condition)) \
+    { \
+        cout << "FAILED: " #condition " (l." << __LINE__ << ")" << endl; \
+        failures++; \
+    }
+
+static void testQueueEmpty()
+{
+    MpscQueue<int, 8> queue;
+    int value = -1;
+    CHECK(! queue.pop(value));
+    CHECK(value == -1);
+}
+
+static void testQueueOrder()
+{
+    MpscQueue<int, 16> queue;
+    for (int i = 0; i < 10; i++)
+        CHECK(queue.push(i));
+
+    int value;
+    for (int i = 0; i < 10; i++)
+    {
+        CHECK(queue.pop(value));
+        CHECK(value == i);
+    }
+    CHECK(! queue.pop(value));
+}
+
+static void testQueueFull()
+{
+    MpscQueue<int, 8> queue;
+    for (int i = 0; i < 8; i++)
+        CHECK(queue.push(i));
+    CHECK(! queue.push(8));
+    CHECK(queue.getDropped() == 1);
+
+    int value;
+    CHECK(queue.pop(value));
+    CHECK(value == 0);
+    CHECK(queue.push(8));
+    CHECK(! queue.push(9));
+    CHECK(queue.getDropped() == 2);
+
+    for (int i = 1; i <= 8; i++)
+    {
+        CHECK(queue.pop(value));
+        CHECK(value == i);
+    }
+    CHECK(! queue.pop(value));
+}
+
+static void testQueueWrapAround()
+{
+    MpscQueue<int, 4> queue;
+    int next = 0;
+    int expected = 0;
+    for (int lap = 0; lap < 1000; lap++)
+    {
+        for (int i = 0; i < 3; i++)
+            CHECK(queue.push(next++));
+
+        int value;
+        for (int i = 0; i < 3; i++)
+        {
+            CHECK(queue.pop(value));
+            CHECK(value == expected);
+            expected++;
+        }
+    }
+}
+
+static void testQueueStrings()
+{
+    MpscQueue<string, 4> queue;
+    CHECK(queue.push("first"));
+    CHECK(queue.push(string(100, 'x')));
+
+    string value;
+    CHECK(queue.pop(value));
+    CHECK(value == "first");
+    CHECK(queue.pop(value));
+    CHECK(value == string(100, 'x'));
+    CHECK(! queue.pop(value));
+}
+
+#define STRESS_PRODUCERS 4
+#define STRESS_VALUES 200000
+
+typedef MpscQueue<long, 1024> StressQueue;
+
+class StressProducer : public Thread
+{
+private:
+    StressQueue * queue;
+    long id;
+public:
+    StressProducer() : queue(NULL), id(0) {}
+
+    void init(StressQueue * target, long producerId)
+    {
+        queue = target;
+        id = producerId;
+    }
+
+    void run()
+    {
+        for (long i = 0; i < STRESS_VALUES; i++)
+        {
+            while (! queue->push((id << 24) | i))
+                threading::sleep(0);
+        }
+    }
+};
+
+static void testQueueStress()
+{
+    static StressQueue queue;
+    StressProducer producers[STRESS_PRODUCERS];
+    long next[STRESS_PRODUCERS];
+
+    for (int i = 0; i < STRESS_PRODUCERS; i++)
+    {
+        next[i] = 0;
+        producers[i].init(&queue, i);
+        producers[i].start();
+    }
+
+    long received = 0;
+    bool ordered = true;
+    while (received < STRESS_PRODUCERS * STRESS_VALUES)
+    {
+        long value;
+        if (queue.pop(value))
+        {
+            long producer = value >> 24;
+            long sequence = value & 0xFFFFFF;
+            if ((producer < 0) || (producer >= STRESS_PRODUCERS) || (sequence != next[producer]))
+                ordered = false;
+            else
+                next[producer]++;
+            received++;
+        }
+    }
+
+    for (int i = 0; i < STRESS_PRODUCERS; i++)
+        producers[i].join();
+
+    CHECK(ordered);
+    for (int i = 0; i < STRESS_PRODUCERS; i++)
+        CHECK(next[i] == STRESS_VALUES);
+
+    long value;
+    CHECK(! queue.pop(value));
+}
+
 class MyThread : public Thread
 {
 private:
@@ -55,8 +217,120 @@ public:
     }
 };
 
+static void testEventSetBeforeWait()
+{
+    Event event;
+    event.set();
+    CHECK(event.wait(0) == THREADING_EVENT_SIGNALED);
+    CHECK(event.wait(10) == THREADING_EVENT_TIMEOUT); // auto-reset
+}
+
+class EventSetter : public Thread
+{
+private:
+    Event * event;
+public:
+    EventSetter(Event * target) : event(target) {}
+
+    void run()
+    {
+        threading::sleep(50);
+        event->set();
+    }
+};
+
+static void testEventCrossThread()
+{
+    Event event;
+    EventSetter setter(&event);
+    setter.start();
+    CHECK(event.wait(5000) == THREADING_EVENT_SIGNALED);
+    setter.join();
+}
+
+static volatile long completedTasks = 0;
+
+class SquareTask : public Task
+{
+public:
+    long input;
+    long output;
+    bool completed;
+
+    SquareTask(long value) : input(value), output(0), completed(false) {}
+
+    void run()
+    {
+        output = input * input;
+    }
+
+    void complete()
+    {
+        completed = true;
+    }
+};
+
+class CountTask : public Task
+{
+public:
+    CountTask() : Task(true) {}
+
+    void run()
+    {
+        long count;
+        do
+        {
+            count = completedTasks;
+        }
+        while (! compareAndSwap(&completedTasks, count, count + 1));
+    }
+};
+
+static void testThreadPool()
+{
+    ThreadPool pool(4);
+    pool.start();
+
+    SquareTask * tasks[100];
+    for (int i = 0; i < 100; i++)
+    {
+        tasks[i] = new SquareTask(i);
+        CHECK(pool.submit(tasks[i]));
+    }
+    for (int i = 0; i < 1000; i++)
+        CHECK(pool.submit(new CountTask()));
+
+    for (int i = 0; i < 100; i++)
+    {
+        CHECK(tasks[i]->waitDone(5000) == THREADING_EVENT_SIGNALED);
+        CHECK(tasks[i]->isDone());
+        CHECK(tasks[i]->completed);
+        CHECK(tasks[i]->output == (long)i * i);
+        delete tasks[i];
+    }
+
+    // The pending tasks run before the workers exit
+    pool.stop();
+    CHECK(completedTasks == 1000);
+
+    SquareTask late(3);
+    CHECK(! pool.submit(&late));
+    CHECK(! late.isDone());
+}
+
 int main( int argc, char ** argv)
 {
+    testQueueEmpty();
+    testQueueOrder();
+    testQueueFull();
+    testQueueWrapAround();
+    testQueueStrings();
+    testQueueStress();
+    testEventSetBeforeWait();
+    testEventCrossThread();
+    testThreadPool();
+    cout << "Threading tests: " << failures << " failure(s)" << endl;
+
     MyThread thr;
     thr.start();
 
@@ -67,5 +341,5 @@ int main( int argc, char ** argv)
     
     cout << "Finished! Press enter to close the window." << endl;
     char dump = cin.get();
-    return 0;
+    return (failures == 0) ? 0 : 1;
 }
@@ -87,6 +87,21 @@ void threading::sleep(long ms)
     Sleep(ms);
 }
 
+void threading::memoryBarrier()
+{
+    MemoryBarrier();
+}
+
+bool threading::compareAndSwap(volatile long * target, long expected, long desired)
+{
+    return InterlockedCompareExchange(target, desired, expected) == expected;
+}
+
+unsigned long threading::currentThreadId()
+{
+    return GetCurrentThreadId();
+}
+
 struct threading::MutexData
 {
     HANDLE handle;
@@ -126,7 +141,6 @@ void Mutex::unlock()
 }
 
 
-#if 0
 struct threading::EventData
 {
     HANDLE handle;
@@ -134,8 +148,8 @@ struct threading::EventData
 
 Event::Event() : data(NULL)
 {
-    HANDLE handle = CreateEvent(NULL, TRUE, FALSE, TEXT("threading::Event")); 
-    // Use of a manual reset-event to release all waiting threads instead of just one when the event is signaled
+    // Unnamed (each instance is a distinct event), auto-reset event
+    HANDLE handle = CreateEvent(NULL, FALSE, FALSE, NULL);
 
     if (handle == NULL)
         throw ThreadException("Event::Event() : CreateEvent did return NULL.");
@@ -169,11 +183,6 @@ void Event::set()
     DWORD result = SetEvent(data->handle);
     if (! result)
         throw ThreadException("Event::set() : SetEvent did return FALSE.");
-
-    /*DWORD resultReset = ResetEvent(data->handle);
-    if (! result)
-        throw ThreadException("Event::set() : ResetEvent did return FALSE.");*/
 }
-#endif
 
 #endif // _WIN32